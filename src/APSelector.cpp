@@ -0,0 +1,171 @@
+/**
+ * ESP32 Marauder TUI - AP Selector
+ */
+
+#include "APSelector.h"
+#include "WiFiAttacks.h"
+
+APSelector apSelector;
+
+static const char* const SORT_NAMES[] = {"RSSI", "channel", "SSID"};
+
+// ============================================
+// Record Updates
+// ============================================
+
+void APSelector::noteAP(uint8_t idx, const AccessPoint& ap) {
+    if (idx >= MAX_APS) return;
+    _keys.rssi[idx] = ap.rssi;
+    _keys.channel[idx] = ap.channel;
+    strncpy(_keys.essid[idx], ap.essid, sizeof(_keys.essid[idx]) - 1);
+    _keys.essid[idx][sizeof(_keys.essid[idx]) - 1] = '\0';
+    if (idx >= _count) _count = idx + 1;
+    _dirty |= 1ULL << idx;
+}
+
+void APSelector::reset() {
+    for (uint8_t s = 0; s < (uint8_t)APSort::COUNT; s++) _orders[s].clear();
+    _count = 0;
+    _dirty = 0;
+    _viewSize = 0;
+}
+
+void APSelector::refresh() {
+    if (!_ordersReady) {
+        _orders[(uint8_t)APSort::RSSI].setOrder(lessRssi, &_keys);
+        _orders[(uint8_t)APSort::CHANNEL].setOrder(lessChannel, &_keys);
+        _orders[(uint8_t)APSort::SSID].setOrder(lessSsid, &_keys);
+        _ordersReady = true;
+    }
+    
+    wifiAttacks.lockTables(portMAX_DELAY);
+    
+    if (_dirty) {
+        // Several records may have moved at once, so single-entry sifts
+        // can't be trusted on their own; new records are appended and one
+        // insertion pass restores order at O(n + records moved)
+        for (uint8_t s = 0; s < (uint8_t)APSort::COUNT; s++) {
+            for (uint8_t i = 0; i < _count; i++) {
+                if ((_dirty >> i) & 1) _orders[s].update(i);
+            }
+            _orders[s].resort();
+        }
+        _dirty = 0;
+    }
+    
+    const SortedIndex<MAX_APS>& order = _orders[(uint8_t)_sort];
+    _viewSize = 0;
+    for (uint8_t r = 0; r < order.size(); r++) {
+        uint8_t idx = order.at(r);
+        if (passes(idx)) _view[_viewSize++] = idx;
+    }
+    
+    wifiAttacks.unlockTables();
+}
+
+// ============================================
+// Sorting
+// ============================================
+// Ties fall back to table index so the order is stable between refreshes.
+
+bool APSelector::lessRssi(uint8_t a, uint8_t b, const void* ctx) {
+    const Keys* k = (const Keys*)ctx;
+    if (k->rssi[a] != k->rssi[b]) return k->rssi[a] > k->rssi[b];
+    return a < b;
+}
+
+bool APSelector::lessChannel(uint8_t a, uint8_t b, const void* ctx) {
+    const Keys* k = (const Keys*)ctx;
+    if (k->channel[a] != k->channel[b]) return k->channel[a] < k->channel[b];
+    return lessRssi(a, b, ctx);
+}
+
+bool APSelector::lessSsid(uint8_t a, uint8_t b, const void* ctx) {
+    const Keys* k = (const Keys*)ctx;
+    int c = strcasecmp(k->essid[a], k->essid[b]);
+    if (c != 0) {
+        // Hidden (empty) SSIDs last
+        if (k->essid[a][0] == '\0') return false;
+        if (k->essid[b][0] == '\0') return true;
+        return c < 0;
+    }
+    return a < b;
+}
+
+void APSelector::cycleSort() {
+    _sort = (APSort)(((uint8_t)_sort + 1) % (uint8_t)APSort::COUNT);
+    refresh();
+}
+
+const char* APSelector::sortName(APSort sort) {
+    return SORT_NAMES[(uint8_t)sort];
+}
+
+// ============================================
+// Filtering
+// ============================================
+
+bool APSelector::setFilter(const char* expr) {
+    char text[sizeof(_text)] = "";
+    bool prefix = false;
+    uint8_t channel = 0;
+    int rssiAbove = -128;
+    int rssiBelow = 127;
+    
+    char buf[sizeof(_expr)];
+    strncpy(buf, expr, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    
+    char* save = nullptr;
+    for (char* tok = strtok_r(buf, " ", &save); tok; tok = strtok_r(nullptr, " ", &save)) {
+        char* end = nullptr;
+        if (strncasecmp(tok, "ch=", 3) == 0) {
+            long ch = strtol(tok + 3, &end, 10);
+            if (*end != '\0' || ch < 1 || ch > MAX_CHANNEL) return false;
+            channel = ch;
+        } else if (strncasecmp(tok, "rssi>", 5) == 0) {
+            rssiAbove = strtol(tok + 5, &end, 10);
+            if (*end != '\0' || end == tok + 5) return false;
+        } else if (strncasecmp(tok, "rssi<", 5) == 0) {
+            rssiBelow = strtol(tok + 5, &end, 10);
+            if (*end != '\0' || end == tok + 5) return false;
+        } else if (text[0] != '\0') {
+            return false;  // One SSID term only
+        } else if (tok[0] == '^') {
+            prefix = true;
+            strncpy(text, tok + 1, sizeof(text) - 1);
+        } else {
+            strncpy(text, tok, sizeof(text) - 1);
+        }
+    }
+    
+    strncpy(_expr, expr, sizeof(_expr) - 1);
+    _expr[sizeof(_expr) - 1] = '\0';
+    memcpy(_text, text, sizeof(_text));
+    _prefix = prefix;
+    _channel = channel;
+    _rssiAbove = constrain(rssiAbove, -128, 127);
+    _rssiBelow = constrain(rssiBelow, -128, 127);
+    refresh();
+    return true;
+}
+
+bool APSelector::passes(uint8_t idx) const {
+    if (_channel != 0 && _keys.channel[idx] != _channel) return false;
+    if (_keys.rssi[idx] <= _rssiAbove || _keys.rssi[idx] >= _rssiBelow) return false;
+    if (_text[0] == '\0') return true;
+    
+    const char* ssid = _keys.essid[idx];
+    size_t n = strlen(_text);
+    if (_prefix) return strncasecmp(ssid, _text, n) == 0;
+    for (; *ssid; ssid++) {
+        if (strncasecmp(ssid, _text, n) == 0) return true;
+    }
+    return false;
+}
+
+void APSelector::selectView(bool selected) {
+    for (uint8_t pos = 0; pos < _viewSize; pos++) {
+        wifiAttacks.selectAP(_view[pos], selected);
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include "SortedIndex.h"
+
+struct AccessPoint;
+
+// ============================================
+// AP Selector
+// Sorted, filtered view of the AP table for target selection
+// ============================================
+//
+// One SortedIndex per sort key is kept for the whole AP table. WiFiAttacks
+// reports changed records; the orders are brought up to date when the
+// selection view is opened, touching only what changed since last time,
+// so switching the sort key is free and nothing is re-sorted from scratch.
+//
+// Filter syntax (terms separated by spaces, all must match):
+//   text      SSID contains text (case-insensitive)
+//   ^text     SSID starts with text
+//   ch=N      on channel N
+//   rssi>N    stronger than N dBm (rssi<N: weaker)
+
+static_assert(MAX_APS <= 64, "dirty mask is a uint64_t");
+
+enum class APSort : uint8_t {
+    RSSI,
+    CHANNEL,
+    SSID,
+    COUNT
+};
+
+class APSelector {
+public:
+    // Table changes; called by WiFiAttacks (table lock held while sniffing)
+    void noteAP(uint8_t idx, const AccessPoint& ap);
+    void reset();
+    
+    // Main loop: apply pending changes and rebuild the filtered view
+    void refresh();
+    
+    APSort sort() const { return _sort; }
+    void cycleSort();
+    static const char* sortName(APSort sort);
+    
+    // false if expr has a malformed term (filter left unchanged)
+    bool setFilter(const char* expr);
+    const char* filter() const { return _expr; }
+    
+    // Filtered view in current sort order; entries are AP table indices
+    uint8_t viewSize() const { return _viewSize; }
+    uint8_t viewAt(uint8_t pos) const { return _view[pos]; }
+    const char* essid(uint8_t idx) const { return _keys.essid[idx]; }
+    int8_t rssi(uint8_t idx) const { return _keys.rssi[idx]; }
+    uint8_t channel(uint8_t idx) const { return _keys.channel[idx]; }
+    
+    // Bulk select/deselect every AP in the current view
+    void selectView(bool selected);
+    
+private:
+    // Sort keys mirrored from the AP table
+    struct Keys {
+        int8_t rssi[MAX_APS];
+        uint8_t channel[MAX_APS];
+        char essid[MAX_APS][33];
+    };
+    
+    Keys _keys;
+    uint8_t _count = 0;         // Records known (table indices 0.._count-1)
+    uint64_t _dirty = 0;        // Records changed since the last refresh()
+    SortedIndex<MAX_APS> _orders[(uint8_t)APSort::COUNT];
+    bool _ordersReady = false;
+    APSort _sort = APSort::RSSI;
+    
+    // Parsed filter
+    char _expr[25] = "";
+    char _text[25] = "";
+    bool _prefix = false;
+    uint8_t _channel = 0;       // 0 = any
+    int8_t _rssiAbove = -128;
+    int8_t _rssiBelow = 127;
+    
+    uint8_t _view[MAX_APS];
+    uint8_t _viewSize = 0;
+    
+    bool passes(uint8_t idx) const;
+    static bool lessRssi(uint8_t a, uint8_t b, const void* ctx);
+    static bool lessChannel(uint8_t a, uint8_t b, const void* ctx);
+    static bool lessSsid(uint8_t a, uint8_t b, const void* ctx);
+};
+
+// Global instance
+extern APSelector apSelector;
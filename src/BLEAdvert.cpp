@@ -0,0 +1,188 @@
+/**
+ * ESP32 Marauder TUI - BLE Advert
+ *
+ * The table is ordered specific to generic: iBeacon before other Apple
+ * data, Swift Pair before other Microsoft data, and so on. Adding a
+ * device type is one line.
+ */
+
+#include "BLEAdvert.h"
+
+namespace {
+
+enum class Key : uint8_t {
+    COMPANY,        // id = company ID, prefix = start of manufacturer data
+    SERVICE,        // id = 16-bit service UUID listed
+    SERVICE_DATA    // id = service data UUID, prefix = start of its data
+};
+
+struct Classifier {
+    BLEClass cls;
+    Key key;
+    uint16_t id;
+    uint8_t prefixLen;
+    uint8_t prefix[3];
+};
+
+constexpr uint16_t APPLE = 0x004C;
+constexpr uint16_t MICROSOFT = 0x0006;
+constexpr uint16_t SAMSUNG = 0x0075;
+constexpr uint16_t GOOGLE = 0x00E0;
+
+constexpr Classifier CLASSIFIERS[] = {
+    // Apple Continuity: first TLV type after the company ID
+    {BLEClass::IBEACON,             Key::COMPANY, APPLE, 2, {0x02, 0x15}},
+    {BLEClass::AIRTAG,              Key::COMPANY, APPLE, 1, {0x12}},
+    {BLEClass::APPLE_AIRDROP,       Key::COMPANY, APPLE, 1, {0x05}},
+    {BLEClass::APPLE_AIRPODS,       Key::COMPANY, APPLE, 1, {0x07}},
+    {BLEClass::APPLE_AIRPLAY,       Key::COMPANY, APPLE, 1, {0x09}},
+    {BLEClass::APPLE_HANDOFF,       Key::COMPANY, APPLE, 1, {0x0C}},
+    {BLEClass::APPLE_NEARBY_ACTION, Key::COMPANY, APPLE, 1, {0x0F}},
+    {BLEClass::APPLE_NEARBY,        Key::COMPANY, APPLE, 1, {0x10}},
+    {BLEClass::APPLE,               Key::COMPANY, APPLE, 0, {}},
+    
+    // Microsoft: scenario byte 0x03 is Swift Pair, 0x01 a CDP beacon
+    {BLEClass::MS_SWIFT_PAIR,       Key::COMPANY, MICROSOFT, 1, {0x03}},
+    {BLEClass::MICROSOFT,           Key::COMPANY, MICROSOFT, 0, {}},
+    
+    {BLEClass::SAMSUNG_TAG,         Key::SERVICE, 0xFD5A, 0, {}},
+    {BLEClass::SAMSUNG_TAG,         Key::SERVICE_DATA, 0xFD5A, 0, {}},
+    {BLEClass::SAMSUNG,             Key::COMPANY, SAMSUNG, 0, {}},
+    
+    {BLEClass::FAST_PAIR,           Key::SERVICE_DATA, 0xFE2C, 0, {}},
+    {BLEClass::GOOGLE,              Key::COMPANY, GOOGLE, 0, {}},
+    
+    {BLEClass::TILE,                Key::SERVICE, 0xFEED, 0, {}},
+    {BLEClass::TILE,                Key::SERVICE, 0xFEEC, 0, {}},
+    
+    {BLEClass::EDDYSTONE,           Key::SERVICE_DATA, 0xFEAA, 0, {}},
+    
+    // Flipper Zero lists a UUID per case colour (its name is a signature)
+    {BLEClass::FLIPPER,             Key::SERVICE, 0x3081, 0, {}},
+    {BLEClass::FLIPPER,             Key::SERVICE, 0x3082, 0, {}},
+    {BLEClass::FLIPPER,             Key::SERVICE, 0x3083, 0, {}},
+};
+
+constexpr bool classifiersValid() {
+    for (const Classifier& c : CLASSIFIERS) {
+        if (c.prefixLen > sizeof(c.prefix)) return false;
+        if (c.cls >= BLEClass::COUNT) return false;
+    }
+    return true;
+}
+static_assert(classifiersValid(), "BLE classifier table entry is malformed");
+
+const char* const CLASS_NAMES[] = {
+    "BLE", "AirTag", "Flipper", "Skimmer?", "iBeacon", "Eddystone",
+    "AirDrop", "AirPods", "AirPlay", "Handoff", "AppleAction", "Nearby",
+    "Apple", "SwiftPair", "Windows", "SmartTag", "Samsung", "FastPair",
+    "Google", "Tile",
+};
+static_assert(sizeof(CLASS_NAMES) / sizeof(CLASS_NAMES[0]) == (size_t)BLEClass::COUNT,
+              "CLASS_NAMES must name every BLEClass");
+              
+bool hasPrefix(const uint8_t* data, uint8_t len, const Classifier& c) {
+    return data && len >= c.prefixLen && memcmp(data, c.prefix, c.prefixLen) == 0;
+}
+
+}  // namespace
+
+void BLEAdvert::parse(const uint8_t* adv, size_t len) {
+    ADIterator it(adv, len);
+    ADStructure ad;
+    while (it.next(ad)) {
+        switch (ad.type) {
+            case AD_FLAGS:
+                if (ad.len >= 1) {
+                    flags = ad.data[0];
+                    hasFlags = true;
+                }
+                break;
+                
+            case AD_UUID16_SOME:
+            case AD_UUID16_ALL:
+                for (uint8_t i = 0; i + 1 < ad.len && serviceCount < MAX_SERVICES; i += 2) {
+                    services[serviceCount++] = ad.data[i] | (ad.data[i + 1] << 8);
+                }
+                break;
+                
+            case AD_NAME_COMPLETE:
+            case AD_NAME_SHORT:
+                // A complete name wins over a shortened one
+                if (name == nullptr || ad.type == AD_NAME_COMPLETE) {
+                    name = ad.data;
+                    nameLen = ad.len;
+                }
+                break;
+                
+            case AD_TX_POWER:
+                if (ad.len >= 1) {
+                    txPower = (int8_t)ad.data[0];
+                    hasTxPower = true;
+                }
+                break;
+                
+            case AD_SERVICE_DATA16:
+                if (ad.len >= 2 && serviceData == nullptr) {
+                    dataUuid = ad.data[0] | (ad.data[1] << 8);
+                    serviceData = ad.data + 2;
+                    serviceDataLen = ad.len - 2;
+                }
+                break;
+                
+            case AD_MANUFACTURER:
+                if (ad.len >= 2 && mfr == nullptr) {
+                    company = ad.data[0] | (ad.data[1] << 8);
+                    mfr = ad.data + 2;
+                    mfrLen = ad.len - 2;
+                }
+                break;
+                
+            default:
+                break;
+        }
+    }
+}
+
+bool BLEAdvert::hasService(uint16_t uuid) const {
+    for (uint8_t i = 0; i < serviceCount; i++) {
+        if (services[i] == uuid) return true;
+    }
+    return false;
+}
+
+BLEClass BLEAdvert::classify() const {
+    for (const Classifier& c : CLASSIFIERS) {
+        bool match = false;
+        switch (c.key) {
+            case Key::COMPANY:
+                match = company == c.id && hasPrefix(mfr, mfrLen, c);
+                break;
+            case Key::SERVICE:
+                match = hasService(c.id);
+                break;
+            case Key::SERVICE_DATA:
+                match = dataUuid == c.id && hasPrefix(serviceData, serviceDataLen, c);
+                break;
+        }
+        if (match) return c.cls;
+    }
+    return BLEClass::DEVICE;
+}
+
+const char* BLEAdvert::className(BLEClass cls) {
+    if (cls >= BLEClass::COUNT) return "?";
+    return CLASS_NAMES[(uint8_t)cls];
+}
+
+bool BLEAdvert::classByName(const char* name, BLEClass* cls) {
+    size_t n = strcspn(name, "?");
+    for (uint8_t i = 0; i < (uint8_t)BLEClass::COUNT; i++) {
+        size_t m = strcspn(CLASS_NAMES[i], "?");
+        if (m == n && strncasecmp(name, CLASS_NAMES[i], n) == 0) {
+            *cls = (BLEClass)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+
+// ============================================
+// BLE Advert
+// AD structure decoding and device classification
+// ============================================
+//
+// An advertisement (plus scan response) is a run of AD structures:
+// length (type + data), type, data. ADIterator walks them in place;
+// BLEAdvert::parse() makes one pass and keeps pointers to the fields the
+// classifiers look at, so nothing is copied out of the NimBLE buffer.
+//
+// classify() then tries a constexpr table (BLEAdvert.cpp), first match
+// wins, each entry keyed on one of: company ID + manufacturer data
+// prefix, 16-bit service UUID, or service data UUID + prefix. Names and
+// user-supplied patterns are matched by the SignatureSet.
+
+// Stream class values (StreamField::CLASS); keep existing numbers
+enum class BLEClass : uint8_t {
+    DEVICE,             // Nothing more specific
+    AIRTAG,             // Apple Find My (AirTag, offline finding)
+    FLIPPER,
+    SKIMMER,            // Serial modules typical of card skimmers
+    IBEACON,
+    EDDYSTONE,
+    APPLE_AIRDROP,
+    APPLE_AIRPODS,      // Continuity proximity pairing
+    APPLE_AIRPLAY,
+    APPLE_HANDOFF,
+    APPLE_NEARBY_ACTION,
+    APPLE_NEARBY,       // Nearby info (iPhone, Watch, Mac)
+    APPLE,              // Other Apple manufacturer data
+    MS_SWIFT_PAIR,
+    MICROSOFT,          // CDP beacons (Windows devices)
+    SAMSUNG_TAG,        // SmartTag
+    SAMSUNG,
+    FAST_PAIR,          // Google Fast Pair
+    GOOGLE,
+    TILE,
+    COUNT
+};
+
+struct ADStructure {
+    uint8_t type;
+    uint8_t len;            // Data bytes
+    const uint8_t* data;
+};
+
+class ADIterator {
+public:
+    ADIterator(const uint8_t* adv, size_t len) : _pos(adv), _end(adv + len) {}
+    
+    // Next well-formed structure; false at the end or on a bad length
+    bool next(ADStructure& ad) {
+        if (_end - _pos < 2 || _pos[0] == 0 || _pos[0] > _end - _pos - 1) return false;
+        ad.type = _pos[1];
+        ad.len = _pos[0] - 1;
+        ad.data = _pos + 2;
+        _pos += _pos[0] + 1;
+        return true;
+    }
+    
+private:
+    const uint8_t* _pos;
+    const uint8_t* _end;
+};
+
+// AD types used here (Bluetooth Assigned Numbers)
+enum : uint8_t {
+    AD_FLAGS = 0x01,
+    AD_UUID16_SOME = 0x02,
+    AD_UUID16_ALL = 0x03,
+    AD_NAME_SHORT = 0x08,
+    AD_NAME_COMPLETE = 0x09,
+    AD_TX_POWER = 0x0A,
+    AD_SERVICE_DATA16 = 0x16,
+    AD_MANUFACTURER = 0xFF
+};
+
+struct BLEAdvert {
+    static const uint8_t MAX_SERVICES = 4;
+    static const uint16_t NO_COMPANY = 0xFFFF;
+    
+    // Pointers into the parsed buffer, valid as long as it is
+    const uint8_t* name = nullptr;
+    uint8_t nameLen = 0;
+    uint8_t flags = 0;
+    bool hasFlags = false;
+    int8_t txPower = 0;
+    bool hasTxPower = false;
+    uint16_t company = NO_COMPANY;
+    const uint8_t* mfr = nullptr;       // Manufacturer data after the company ID
+    uint8_t mfrLen = 0;
+    uint16_t services[MAX_SERVICES];    // 16-bit service UUIDs
+    uint8_t serviceCount = 0;
+    uint16_t dataUuid = 0;              // First 16-bit service data
+    const uint8_t* serviceData = nullptr;
+    uint8_t serviceDataLen = 0;
+    
+    void parse(const uint8_t* adv, size_t len);
+    BLEClass classify() const;
+    bool hasService(uint16_t uuid) const;
+    
+    static const char* className(BLEClass cls);
+    // Inverse of className, case and a trailing '?' ignored
+    static bool classByName(const char* name, BLEClass* cls);
+};
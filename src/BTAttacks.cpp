@@ -8,6 +8,12 @@
 
 #include "BTAttacks.h"
 #include "SerialTUI.h"
+#include "EventLoop.h"
+#include "EventStream.h"
+#include "TrackerWatch.h"
+#include "SpamDetector.h"
+#include "SignatureSet.h"
+#include "ClassicScan.h"
 #include <esp_random.h>
 
 BTAttacks btAttacks;
@@ -61,18 +67,6 @@ const uint32_t googleModelIds[] = {
     0x0E30C3,   // Random device
 };
 
-// Card skimmer detection patterns
-const char* skimmerPatterns[] = {
-    "HC-05",
-    "HC-06",
-    "HC-08",
-    "BT_SKIMMER",
-    "RNBT",
-};
-
-// Flipper Zero detection
-const char* flipperPattern = "Flipper";
-
 // ============================================
 // BTAttacks Implementation
 // ============================================
@@ -84,63 +78,147 @@ void BTAttacks::begin() {
     // Get advertising instance
     _pAdvertising = NimBLEDevice::getAdvertising();
     
-    // Get scan instance
+    // Get scan instance. NimBLE would otherwise keep a heap-allocated
+    // device (and payload) per new address for the whole scan; _devices
+    // is the table here, so each one is freed after onResult.
     _pScan = NimBLEDevice::getScan();
-    _pScan->setInterval(100);
-    _pScan->setWindow(99);
-    _pScan->setActiveScan(true);
+    _pScan->setMaxResults(0);
+    applyProfile();
+}
+
+// ============================================
+// Scan Profiles
+// ============================================
+
+struct ScanParams {
+    const char* name;
+    uint16_t intervalMs;
+    uint16_t windowMs;      // Listening time per interval
+    bool active;            // Send scan requests
+    uint8_t dupFilter;      // 1 = controller drops repeats of a device
+};
+
+static const ScanParams SCAN_PROFILES[(uint8_t)BTScanProfile::COUNT] = {
+    {"survey",      100,  100, false, 1},
+    {"active",      100,   99, true,  0},
+    {"background", 1000,   50, false, 1},
+    {"tracker",      50,   50, false, 0},
+};
+
+const char* BTAttacks::profileName(BTScanProfile profile) {
+    if (profile >= BTScanProfile::COUNT) return "?";
+    return SCAN_PROFILES[(uint8_t)profile].name;
+}
+
+void BTAttacks::describeProfile(BTScanProfile profile, char* buf, size_t len) {
+    const ScanParams& p = SCAN_PROFILES[(uint8_t)profile];
+    snprintf(buf, len, "%s: %u/%u ms, %s, %s", p.name, p.windowMs, p.intervalMs,
+             p.active ? "active" : "passive", p.dupFilter ? "first advert" : "every advert");
+}
+
+void BTAttacks::setProfile(BTScanProfile profile) {
+    if (profile >= BTScanProfile::COUNT) return;
+    _profile = profile;
+    applyProfile();
+}
+
+void BTAttacks::applyProfile() {
+    if (_pScan == nullptr) return;
+    const ScanParams& p = SCAN_PROFILES[(uint8_t)_profile];
+    
+    // Parameters reach the controller when a scan starts
+    bool running = _pScan->isScanning();
+    if (running) _pScan->stop();
+    _pScan->setInterval(p.intervalMs);
+    _pScan->setWindow(p.windowMs);
+    _pScan->setActiveScan(p.active);
+    _pScan->setDuplicateFilter(p.dupFilter);
+    if (running) _pScan->start(0, false);
 }
 
 void BTAttacks::update() {
     if (_mode == BTMode::IDLE) return;
     
     uint32_t now = millis();
+    drainHits();
     
-    switch (_mode) {
-        case BTMode::SPAM_APPLE:
-            sendSpamPacket(BTSpamType::APPLE);
-            delay(20);
-            break;
-            
-        case BTMode::SPAM_WINDOWS:
-            sendSpamPacket(BTSpamType::WINDOWS);
-            delay(20);
-            break;
-            
-        case BTMode::SPAM_SAMSUNG:
-            sendSpamPacket(BTSpamType::SAMSUNG);
-            delay(20);
-            break;
-            
-        case BTMode::SPAM_GOOGLE:
-            sendSpamPacket(BTSpamType::GOOGLE);
-            delay(20);
-            break;
-            
-        case BTMode::SPAM_ALL:
-            // Cycle through all spam types
-            {
-                static uint8_t spamIdx = 0;
-                BTSpamType types[] = {BTSpamType::APPLE, BTSpamType::WINDOWS, 
-                                      BTSpamType::SAMSUNG, BTSpamType::GOOGLE};
-                sendSpamPacket(types[spamIdx]);
-                spamIdx = (spamIdx + 1) % 4;
-                delay(20);
-            }
-            break;
-            
-        default:
-            // Scanning modes - handled by callback
-            break;
+    // Spam modes send one advertisement every SPAM_INTERVAL ms
+    if (isSpamming() && now - _lastSpam >= SPAM_INTERVAL) {
+        _lastSpam = now;
+        
+        switch (_mode) {
+            case BTMode::SPAM_APPLE:
+                sendSpamPacket(BTSpamType::APPLE);
+                break;
+                
+            case BTMode::SPAM_WINDOWS:
+                sendSpamPacket(BTSpamType::WINDOWS);
+                break;
+                
+            case BTMode::SPAM_SAMSUNG:
+                sendSpamPacket(BTSpamType::SAMSUNG);
+                break;
+                
+            case BTMode::SPAM_GOOGLE:
+                sendSpamPacket(BTSpamType::GOOGLE);
+                break;
+                
+            case BTMode::SPAM_ALL:
+                // Cycle through all spam types
+                {
+                    static uint8_t spamIdx = 0;
+                    BTSpamType types[] = {BTSpamType::APPLE, BTSpamType::WINDOWS, 
+                                          BTSpamType::SAMSUNG, BTSpamType::GOOGLE};
+                    sendSpamPacket(types[spamIdx]);
+                    spamIdx = (spamIdx + 1) % 4;
+                }
+                break;
+                
+            default:
+                break;
+        }
     }
     
-    // Print status periodically
-    if (now - _lastUpdate > 2000) {
+    // The survey draws its own status bar and summaries
+    if (_mode == BTMode::SURVEY) return;
+    
+    // Statistics for the pinned status bar
+    if (now - _lastUpdate >= STATUS_INTERVAL) {
         char buf[64];
-        snprintf(buf, sizeof(buf), "BT packets: %d", _packetCount);
-        tui.printStatus(buf);
+        if (isSpamming()) {
+            snprintf(buf, sizeof(buf), "BT packets: %d", _packetCount);
+        } else {
+            snprintf(buf, sizeof(buf), "BT packets: %d, %u devices", _packetCount, deviceCount());
+        }
+        tui.setStats(buf);
+        // The bar repaints often; the stream gets a slower sample
+        if (now - _lastStatsEvent >= STATS_EVENT_MS) {
+            eventStream.emit(StreamEvent(StreamType::STATS)
+                .setCount(_packetCount).setDrops(eventStream.drops()));
+            _lastStatsEvent = now;
+        }
         _lastUpdate = now;
     }
+    
+    // Scans report each device once; the table is summarised now and then
+    if (!isSpamming() && now - _lastSummary >= BLE_SUMMARY_MS) {
+        printSummary(now);
+    }
+}
+
+uint32_t BTAttacks::nextWakeMs() const {
+    if (_mode == BTMode::IDLE) return EventLoop::FOREVER;
+    if (_hitCount > 0) return 0;
+    if (_mode == BTMode::SURVEY) return EventLoop::FOREVER;
+    
+    uint32_t now = millis();
+    uint32_t wait = msUntil(_lastUpdate, STATUS_INTERVAL, now);
+    if (isSpamming()) {
+        wait = min(wait, msUntil(_lastSpam, SPAM_INTERVAL, now));
+    } else {
+        wait = min(wait, msUntil(_lastSummary, BLE_SUMMARY_MS, now));
+    }
+    return wait;
 }
 
 void BTAttacks::stop() {
@@ -155,6 +233,7 @@ void BTAttacks::stop() {
     if (_pScan && _pScan->isScanning()) {
         _pScan->stop();
     }
+    drainHits();
     
     char buf[64];
     snprintf(buf, sizeof(buf), "BT stopped. Packets: %d", _packetCount);
@@ -168,74 +247,282 @@ void BTAttacks::stop() {
 // Scanning
 // ============================================
 
+static void emitDevice(const ResultMeta& meta, const char* name, BLEClass cls) {
+    StreamEvent ev(StreamType::BLE);
+    ev.setMac(meta.mac).setRssi(meta.rssi).setClass((uint8_t)cls);
+    if (name[0] != '\0') ev.setSsid(name);
+    eventStream.emit(ev);
+}
+
+// Runs for every advertisement, so it only reads the raw payload: one
+// pass over its AD structures for the signatures, one to pick out the
+// fields for the classifier table (used when no signature hits). No std::string
+// or String is built; text is formatted on the main loop (drainHits), and
+// only for devices being reported
 class ScanCallback : public NimBLEScanCallbacks {
 public:
     BTMode mode;
     
     void onResult(const NimBLEAdvertisedDevice* device) override {
-        String name = device->getName().c_str();
-        String addr = device->getAddress().toString().c_str();
-        int rssi = device->getRSSI();
+        const std::vector<uint8_t>& payload = device->getPayload();
+        const uint8_t* adv = payload.data();
+        size_t len = payload.size();
         
-        char buf[64];
+        BLEAdvert ad;
+        ad.parse(adv, len);
+        BLEClass cls = signatures.matchAdvert(adv, len);
+        if (cls == BLEClass::DEVICE) cls = ad.classify();
         
+        bool match = false;
         switch (mode) {
             case BTMode::SCAN_ALL:
-                if (name.length() > 0) {
-                    snprintf(buf, sizeof(buf), "%s [%s] %ddBm", 
-                             name.c_str(), addr.c_str(), rssi);
-                } else {
-                    snprintf(buf, sizeof(buf), "[%s] %ddBm", addr.c_str(), rssi);
-                }
-                tui.printResult(buf);
+            case BTMode::SURVEY:
+                match = true;
                 break;
-                
             case BTMode::SCAN_AIRTAG:
-                // Apple devices have manufacturer data 0x004C
-                if (device->haveManufacturerData()) {
-                    std::string mfr = device->getManufacturerData();
-                    if (mfr.length() >= 2 && mfr[0] == 0x4C && mfr[1] == 0x00) {
-                        // Check for FindMy/AirTag patterns
-                        if (mfr.length() > 4 && mfr[2] == 0x12) {
-                            snprintf(buf, sizeof(buf), "AIRTAG: %s %ddBm", 
-                                     addr.c_str(), rssi);
-                            tui.printResult(buf);
-                        }
-                    }
-                }
+                match = cls == BLEClass::AIRTAG;
                 break;
-                
             case BTMode::SCAN_FLIPPER:
-                if (name.length() > 0 && name.indexOf("Flipper") >= 0) {
-                    snprintf(buf, sizeof(buf), "FLIPPER: %s [%s] %ddBm",
-                             name.c_str(), addr.c_str(), rssi);
-                    tui.printResult(buf);
-                }
+                match = cls == BLEClass::FLIPPER;
                 break;
-                
             case BTMode::SCAN_SKIMMER:
-                // Check for common skimmer patterns
-                for (int i = 0; i < 5; i++) {
-                    if (name.indexOf(skimmerPatterns[i]) >= 0) {
-                        snprintf(buf, sizeof(buf), "SKIMMER?: %s [%s] %ddBm",
-                                 name.c_str(), addr.c_str(), rssi);
-                        tui.printResult(buf);
-                        break;
-                    }
-                }
+                match = cls == BLEClass::SKIMMER;
                 break;
-                
             default:
-                break;
+                return;
         }
+        
+        BTHit hit;
+        // NimBLE keeps addresses little-endian; records use display order
+        const uint8_t* val = device->getAddress().getVal();
+        for (int i = 0; i < 6; i++) hit.mac[i] = val[5 - i];
+        hit.rssi = device->getRSSI();
+        hit.cls = cls;
+        hit.nameLen = min((size_t)ad.nameLen, sizeof(hit.name) - 1);
+        if (hit.nameLen) memcpy(hit.name, ad.name, hit.nameLen);
+        hit.name[hit.nameLen] = '\0';
+        btAttacks.noteAdvert(hit, device->getAddressType(), ad.flags, match);
+        if (TrackerWatch::isTracker(cls)) trackerWatch.noteAdvert(hit.mac, hit.rssi, cls, ad);
+        spamDetector.noteAdvert(hit.mac, hit.rssi, ad, cls);
     }
 };
 
 static ScanCallback scanCallback;
 
+void BTAttacks::noteAdvert(const BTHit& adv, uint8_t addrType, uint8_t flags, bool match) {
+    uint32_t now = millis();
+    bool queued = false;
+    
+    portENTER_CRITICAL(&_scanMux);
+    _packetCount++;
+    
+    BTDevice* dev = nullptr;
+    for (uint8_t i = 0; i < _deviceCount; i++) {
+        if (memcmp(_devices[i].mac, adv.mac, 6) == 0) {
+            dev = &_devices[i];
+            break;
+        }
+    }
+    
+    if (dev) {
+        dev->advCount++;
+        dev->rssiAvg += (adv.rssi * 16 - dev->rssiAvg) / BLE_RSSI_EWMA_DIV;
+        dev->lastSeen = now;
+    } else {
+        if (_deviceCount < BLE_DEVICE_TABLE_LEN) {
+            dev = &_devices[_deviceCount++];
+        } else {
+            // Forget the device heard from least recently
+            dev = &_devices[0];
+            for (uint8_t i = 1; i < _deviceCount; i++) {
+                if ((int32_t)(_devices[i].lastSeen - dev->lastSeen) < 0) dev = &_devices[i];
+            }
+            _evictions++;
+        }
+        memcpy(dev->mac, adv.mac, 6);
+        dev->cls = BLEClass::DEVICE;
+        dev->name[0] = '\0';
+        dev->reported = false;
+        dev->advCount = 1;
+        dev->rssiAvg = adv.rssi * 16;
+        dev->firstSeen = now;
+        dev->lastSeen = now;
+        dev->flags = flags;     // Not the evicted device's
+    }
+    dev->addrType = addrType;
+    if (flags) dev->flags = flags;
+    // Class data and name may each be in only one of advert / scan response
+    if (adv.cls != BLEClass::DEVICE) dev->cls = adv.cls;
+    // The name may only come in a scan response
+    if (adv.nameLen > 0 && dev->name[0] == '\0') memcpy(dev->name, adv.name, adv.nameLen + 1);
+    
+    // Each device is reported once; with the queue full it is retried on
+    // its next advertisement
+    if (match && !dev->reported && _hitCount < BLE_HIT_QUEUE_LEN) {
+        BTHit& hit = _hits[(_hitHead + _hitCount) % BLE_HIT_QUEUE_LEN];
+        hit = adv;
+        hit.cls = dev->cls;
+        if (hit.nameLen == 0) {
+            hit.nameLen = strlen(dev->name);
+            memcpy(hit.name, dev->name, hit.nameLen + 1);
+        }
+        _hitCount++;
+        dev->reported = true;
+        queued = true;
+    }
+    portEXIT_CRITICAL(&_scanMux);
+    
+    if (queued) events.post(EventType::ALERT);
+}
+
+void BTAttacks::resetScan() {
+    portENTER_CRITICAL(&_scanMux);
+    _hitHead = 0;
+    _hitCount = 0;
+    _deviceCount = 0;
+    _evictions = 0;
+    _packetCount = 0;
+    _scanStart = millis();
+    portEXIT_CRITICAL(&_scanMux);
+    
+    _lastUpdate = millis();
+    _lastSummary = _lastUpdate;
+    _summaryPackets = 0;
+}
+
+void BTAttacks::drainHits() {
+    for (;;) {
+        BTHit hit;
+        portENTER_CRITICAL(&_scanMux);
+        bool have = _hitCount > 0;
+        if (have) {
+            hit = _hits[_hitHead];
+            _hitHead = (_hitHead + 1) % BLE_HIT_QUEUE_LEN;
+            _hitCount--;
+        }
+        portEXIT_CRITICAL(&_scanMux);
+        if (!have) break;
+        
+        char addr[18];
+        snprintf(addr, sizeof(addr), "%02x:%02x:%02x:%02x:%02x:%02x",
+                 hit.mac[0], hit.mac[1], hit.mac[2], hit.mac[3], hit.mac[4], hit.mac[5]);
+        // Detector hits keep their alert labels; other classes are tagged
+        // with their class name
+        ResultKind kind = ResultKind::BLE;
+        char label[20] = "";
+        switch (hit.cls) {
+            case BLEClass::AIRTAG:
+                kind = ResultKind::AIRTAG;
+                strcpy(label, "AIRTAG: ");
+                break;
+            case BLEClass::FLIPPER:
+                kind = ResultKind::FLIPPER;
+                strcpy(label, "FLIPPER: ");
+                break;
+            case BLEClass::SKIMMER:
+                kind = ResultKind::SKIMMER;
+                strcpy(label, "SKIMMER?: ");
+                break;
+            case BLEClass::DEVICE:
+                break;
+            default:
+                snprintf(label, sizeof(label), "%s: ", BLEAdvert::className(hit.cls));
+                break;
+        }
+        
+        char buf[64];
+        if (hit.nameLen > 0) {
+            snprintf(buf, sizeof(buf), "%s%s [%s] %ddBm", label, hit.name, addr, hit.rssi);
+        } else {
+            snprintf(buf, sizeof(buf), "%s%s %ddBm", label, addr, hit.rssi);
+        }
+        
+        ResultMeta meta(hit.rssi, 0, hit.mac);
+        tui.printResult(buf, kind, ResultQueue::keyOf(hit.mac, 6), &meta);
+        emitDevice(meta, hit.name, hit.cls);
+    }
+}
+
+bool BTAttacks::churn(uint32_t since, uint8_t* active, uint8_t* fresh) {
+    *active = 0;
+    *fresh = 0;
+    if (_mode == BTMode::IDLE || isSpamming()) return false;
+    
+    portENTER_CRITICAL(&_scanMux);
+    bool covered = (int32_t)(since - _scanStart) >= 0;
+    for (uint8_t i = 0; covered && i < _deviceCount; i++) {
+        const BTDevice& dev = _devices[i];
+        if ((int32_t)(dev.lastSeen - since) < 0) continue;
+        (*active)++;
+        if ((int32_t)(dev.firstSeen - since) >= 0) (*fresh)++;
+    }
+    portEXIT_CRITICAL(&_scanMux);
+    return covered;
+}
+
+// Address kind for the summary: public, or random by its top two bits
+// (static, resolvable private, non-resolvable); "bre" for BR/EDR
+static const char* addrKind(uint8_t addrType, const uint8_t* mac) {
+    if (addrType == BT_ADDR_CLASSIC) return "bre";
+    if (addrType == BLE_ADDR_PUBLIC || addrType == BLE_ADDR_PUBLIC_ID) return "pub";
+    switch (mac[0] >> 6) {
+        case 3:  return "sta";
+        case 1:  return "rpa";
+        case 0:  return "nrp";
+        default: return "rnd";
+    }
+}
+
+// Table totals and the strongest devices heard since the last summary
+void BTAttacks::printSummary(uint32_t now) {
+    BTDevice top[BLE_SUMMARY_TOP];
+    uint8_t topCount = 0;
+    uint8_t active = 0;
+    
+    portENTER_CRITICAL(&_scanMux);
+    uint8_t total = _deviceCount;
+    uint32_t packets = _packetCount;
+    uint32_t evictions = _evictions;
+    for (uint8_t i = 0; i < _deviceCount; i++) {
+        const BTDevice& dev = _devices[i];
+        if (now - dev.lastSeen >= BLE_SUMMARY_MS) continue;
+        active++;
+        // Insertion into the short top list, strongest first
+        uint8_t pos = topCount;
+        while (pos > 0 && top[pos - 1].rssiAvg < dev.rssiAvg) pos--;
+        if (pos >= BLE_SUMMARY_TOP) continue;
+        if (topCount < BLE_SUMMARY_TOP) topCount++;
+        for (uint8_t j = topCount - 1; j > pos; j--) top[j] = top[j - 1];
+        top[pos] = dev;
+    }
+    portEXIT_CRITICAL(&_scanMux);
+    
+    uint32_t elapsed = now - _lastSummary;
+    uint32_t rate = elapsed ? (uint32_t)((uint64_t)(packets - _summaryPackets) * 1000 / elapsed) : 0;
+    _lastSummary = now;
+    _summaryPackets = packets;
+    
+    char buf[64];
+    snprintf(buf, sizeof(buf), "BLE: %u devices, %u active, %lu adv/s%s", total, active,
+             (unsigned long)rate, evictions ? " (table full)" : "");
+    tui.printResult(buf, ResultKind::INFO);
+    for (uint8_t i = 0; i < topCount; i++) {
+        const BTDevice& dev = top[i];
+        // Flags byte as hex: 06 is LE-only discoverable, 1a dual mode
+        char flags[3] = "--";
+        if (dev.flags) snprintf(flags, sizeof(flags), "%02x", dev.flags);
+        snprintf(buf, sizeof(buf), "  %02x:%02x:%02x:%02x:%02x:%02x %s f%s %s %.10s %ddBm x%lu",
+                 dev.mac[0], dev.mac[1], dev.mac[2], dev.mac[3], dev.mac[4], dev.mac[5],
+                 addrKind(dev.addrType, dev.mac), flags, BLEAdvert::className(dev.cls),
+                 dev.name[0] ? dev.name : "-", dev.rssiAvg / 16, (unsigned long)dev.advCount);
+        tui.printResult(buf, ResultKind::INFO);
+    }
+}
+
 void BTAttacks::startScanAll() {
     _mode = BTMode::SCAN_ALL;
     _packetCount = 0;
+    resetScan();
     
     scanCallback.mode = BTMode::SCAN_ALL;
     _pScan->setScanCallbacks(&scanCallback);
@@ -247,6 +534,7 @@ void BTAttacks::startScanAll() {
 void BTAttacks::startScanAirtag() {
     _mode = BTMode::SCAN_AIRTAG;
     _packetCount = 0;
+    resetScan();
     
     scanCallback.mode = BTMode::SCAN_AIRTAG;
     _pScan->setScanCallbacks(&scanCallback);
@@ -258,6 +546,7 @@ void BTAttacks::startScanAirtag() {
 void BTAttacks::startScanFlipper() {
     _mode = BTMode::SCAN_FLIPPER;
     _packetCount = 0;
+    resetScan();
     
     scanCallback.mode = BTMode::SCAN_FLIPPER;
     _pScan->setScanCallbacks(&scanCallback);
@@ -269,6 +558,7 @@ void BTAttacks::startScanFlipper() {
 void BTAttacks::startScanSkimmer() {
     _mode = BTMode::SCAN_SKIMMER;
     _packetCount = 0;
+    resetScan();
     
     scanCallback.mode = BTMode::SCAN_SKIMMER;
     _pScan->setScanCallbacks(&scanCallback);
@@ -277,6 +567,35 @@ void BTAttacks::startScanSkimmer() {
     tui.printStatus("Detecting card skimmers...");
 }
 
+void BTAttacks::startSurvey() {
+    _mode = BTMode::SURVEY;
+    resetScan();
+    
+    // Started by pauseScan(false) when the first BLE slice comes round
+    scanCallback.mode = BTMode::SURVEY;
+    _pScan->setScanCallbacks(&scanCallback);
+}
+
+void BTAttacks::pauseScan(bool pause) {
+    if (pause) {
+        if (_pScan->isScanning()) _pScan->stop();
+    } else {
+        _pScan->start(0, false);
+    }
+}
+
+void BTAttacks::releaseRadio() {
+    if (_pScan && _pScan->isScanning()) _pScan->stop();
+    // Objects kept, so the scan settings and console server survive
+    NimBLEDevice::deinit(false);
+}
+
+void BTAttacks::reclaimRadio() {
+    begin();
+    _pScan->setScanCallbacks(&scanCallback);
+    if (_mode >= BTMode::SCAN_ALL && _mode <= BTMode::SCAN_SKIMMER) _pScan->start(0, false);
+}
+
 // ============================================
 // Spam Attacks
 // ============================================
@@ -370,7 +689,7 @@ NimBLEAdvertisementData BTAttacks::getWindowsPayload() {
     idx += 7;
     
     // Microsoft SwiftPair
-    payload[idx++] = 0x09;  // Length
+    payload[idx++] = 0x08;  // Length: type, company, beacon, flags, salt
     payload[idx++] = 0xFF;  // Manufacturer specific
     payload[idx++] = 0x06;  // Microsoft (little endian)
     payload[idx++] = 0x00;
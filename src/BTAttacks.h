@@ -2,7 +2,9 @@
 
 #include <Arduino.h>
 #include "Config.h"
+#include "BLEAdvert.h"
 #include <NimBLEDevice.h>
+#include <freertos/FreeRTOS.h>
 
 // ============================================
 // Bluetooth Attack Module
@@ -25,6 +27,7 @@ enum class BTMode : uint8_t {
     SCAN_AIRTAG,
     SCAN_FLIPPER,
     SCAN_SKIMMER,
+    SURVEY,         // Scan all, sharing the radio with WiFi (RadioSurvey)
     SPAM_APPLE,
     SPAM_WINDOWS,
     SPAM_SAMSUNG,
@@ -32,12 +35,36 @@ enum class BTMode : uint8_t {
     SPAM_ALL
 };
 
-// Detected device
+// Scan duty cycle, independent of what the scan looks for
+enum class BTScanProfile : uint8_t {
+    SURVEY,     // Passive, continuous, duplicates filtered: who is around
+    ACTIVE,     // Scan requests for names and extra data (scan responses)
+    BACKGROUND, // Passive, 5% duty: leaves the radio to WiFi and the console
+    TRACKER,    // Passive, continuous, every advert: RSSI for following a device
+    COUNT
+};
+
+// Device aggregated over a scan, one per address
 struct BTDevice {
-    String mac;
-    String name;
-    int8_t rssi;
+    uint8_t mac[6];         // Display order
+    uint8_t addrType;       // NimBLE address type (public, random...)
+    uint8_t flags;          // Last AD flags byte seen, 0 if none
+    BLEClass cls;           // Last class other than DEVICE seen
+    bool reported;          // Result line sent
+    int16_t rssiAvg;        // EWMA, 1/16 dBm
+    uint32_t advCount;
+    uint32_t firstSeen;
     uint32_t lastSeen;
+    char name[30];          // First advertised name, truncated, terminated
+};
+
+// Scan match, queued by the NimBLE task and formatted on the main loop
+struct BTHit {
+    uint8_t mac[6];         // Display order
+    int8_t rssi;
+    BLEClass cls;
+    uint8_t nameLen;
+    char name[30];          // Advertised name, truncated, terminated
 };
 
 class BTAttacks {
@@ -45,12 +72,21 @@ public:
     void begin();
     void update();
     void stop();
+    uint32_t nextWakeMs() const;  // ms until update() has timed work due
     
     // Scanning
     void startScanAll();
     void startScanAirtag();
     void startScanFlipper();
     void startScanSkimmer();
+    void startSurvey();
+    
+    // Survey: scan off (or back on) while WiFi has the radio
+    void pauseScan(bool pause);
+    // Classic inquiry (ClassicScan): NimBLE shuts down so Bluedroid can
+    // have the controller, then comes back with the scan running again
+    void releaseRadio();
+    void reclaimRadio();
     
     // Spam attacks
     void startSpamApple();
@@ -60,11 +96,46 @@ public:
     void startSpamAll();
     
     bool isActive() const { return _mode != BTMode::IDLE; }
+    bool isSpamming() const { return _mode >= BTMode::SPAM_APPLE; }
+    
+    // Applied at once, restarting a running scan (NimBLE stays up)
+    void setProfile(BTScanProfile profile);
+    BTScanProfile profile() const { return _profile; }
+    static const char* profileName(BTScanProfile profile);
+    static void describeProfile(BTScanProfile profile, char* buf, size_t len);
+    
+    // NimBLE task: one advertisement, match = the scan filter accepted it
+    void noteAdvert(const BTHit& adv, uint8_t addrType, uint8_t flags, bool match);
+    uint8_t deviceCount() const { return _deviceCount; }
+    uint32_t advertCount() const { return _packetCount; }
+    uint32_t evictions() const { return _evictions; }
+    // Devices heard since since, and how many of those were new; false
+    // unless a scan has been running since then
+    bool churn(uint32_t since, uint8_t* active, uint8_t* fresh);
     
 private:
     BTMode _mode = BTMode::IDLE;
     uint32_t _lastUpdate = 0;
+    uint32_t _lastStatsEvent = 0;
+    uint32_t _lastSpam = 0;
     uint32_t _packetCount = 0;
+    static const uint32_t SPAM_INTERVAL = 20;      // ms between spam adverts
+    static const uint32_t STATUS_INTERVAL = STATUS_BAR_REFRESH_MS;  // ms between stats updates
+    
+    // Scan state, shared with the NimBLE task under _scanMux: the device
+    // table, and new matching devices awaiting the main loop
+    BTDevice _devices[BLE_DEVICE_TABLE_LEN];
+    uint8_t _deviceCount = 0;
+    uint32_t _evictions = 0;
+    uint32_t _scanStart = 0;
+    BTHit _hits[BLE_HIT_QUEUE_LEN];
+    uint8_t _hitHead = 0;
+    uint8_t _hitCount = 0;
+    portMUX_TYPE _scanMux = portMUX_INITIALIZER_UNLOCKED;
+    uint32_t _lastSummary = 0;
+    uint32_t _summaryPackets = 0;
+    
+    BTScanProfile _profile = BLE_SCAN_PROFILE;
     
     NimBLEAdvertising* _pAdvertising = nullptr;
     NimBLEScan* _pScan = nullptr;
@@ -76,6 +147,10 @@ private:
     NimBLEAdvertisementData getGooglePayload();
     
     // Helper
+    void applyProfile();
+    void resetScan();
+    void drainHits();
+    void printSummary(uint32_t now);
     void randomizeMac();
     void sendSpamPacket(BTSpamType type);
 };
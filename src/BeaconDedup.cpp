@@ -0,0 +1,89 @@
+/**
+ * ESP32 Marauder TUI - Beacon Dedup
+ *
+ * A linear scan over a few dozen BSSIDs costs less than the CRC of the
+ * frame it saves sending, so the cache is a plain array with LRU
+ * replacement.
+ */
+
+#include "BeaconDedup.h"
+#include "EventStream.h"
+
+static const size_t SEQ_OFFSET = 22;
+static const size_t TSF_OFFSET = 24;
+static const size_t BODY_OFFSET = 32;   // First byte after the TSF
+static const size_t IE_OFFSET = 36;     // After beacon interval and capabilities
+static const uint8_t TIM_ID = 5;
+
+bool BeaconDedup::isBeacon(const uint8_t* frame, size_t stored) {
+    // Management, subtype 8
+    return stored >= BODY_OFFSET && frame[0] == 0x80;
+}
+
+uint64_t BeaconDedup::tsf(const uint8_t* frame) {
+    uint64_t value;
+    memcpy(&value, frame + TSF_OFFSET, 8);
+    return value;
+}
+
+uint16_t BeaconDedup::seqCtrl(const uint8_t* frame) {
+    return frame[SEQ_OFFSET] | (frame[SEQ_OFFSET + 1] << 8);
+}
+
+void BeaconDedup::reset() {
+    _count = 0;
+    _fulls = 0;
+    _deltas = 0;
+}
+
+// Everything but sequence, TSF and TIM; an element cut off by the
+// snaplen counts as far as it was stored
+static uint32_t beaconCrc(const uint8_t* frame, size_t stored, uint16_t len) {
+    size_t pos = min(stored, IE_OFFSET);
+    uint32_t crc = EventStream::crc32(frame, SEQ_OFFSET);
+    crc = EventStream::crc32(frame + BODY_OFFSET, pos - BODY_OFFSET, crc);
+    while (pos < stored) {
+        size_t n = pos + 1 < stored ? 2 + frame[pos + 1] : 1;
+        n = min(n, stored - pos);
+        if (frame[pos] != TIM_ID) crc = EventStream::crc32(frame + pos, n, crc);
+        pos += n;
+    }
+    return EventStream::crc32((const uint8_t*)&len, sizeof(len), crc);
+}
+
+bool BeaconDedup::unchanged(const uint8_t* frame, size_t stored, uint16_t len, uint32_t now) {
+    uint32_t crc = beaconCrc(frame, stored, len);
+    
+    const uint8_t* bssid = frame + 16;
+    Entry* entry = nullptr;
+    for (uint8_t i = 0; i < _count; i++) {
+        if (memcmp(_entries[i].bssid, bssid, 6) == 0) {
+            entry = &_entries[i];
+            break;
+        }
+    }
+    
+    if (entry && entry->crc == crc && now - entry->lastFull < BEACON_REFRESH_MS) {
+        entry->lastUsed = now;
+        _deltas++;
+        return true;
+    }
+    
+    if (entry == nullptr) {
+        if (_count < BEACON_CACHE_LEN) {
+            entry = &_entries[_count++];
+        } else {
+            // Evict the BSSID heard from least recently
+            entry = &_entries[0];
+            for (uint8_t i = 1; i < _count; i++) {
+                if ((int32_t)(_entries[i].lastUsed - entry->lastUsed) < 0) entry = &_entries[i];
+            }
+        }
+        memcpy(entry->bssid, bssid, 6);
+    }
+    entry->crc = crc;
+    entry->lastFull = now;
+    entry->lastUsed = now;
+    _fulls++;
+    return false;
+}
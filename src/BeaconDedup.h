@@ -0,0 +1,57 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+
+// ============================================
+// Beacon Dedup
+// Unchanged beacons as delta records
+// ============================================
+//
+// An AP repeats the same beacon about ten times a second; only the
+// sequence number (offset 22), the TSF timestamp (offset 24) and the TIM
+// element (DTIM count, buffered-traffic bitmap) move. The frame encoder
+// keeps a CRC of the rest of the last beacon per BSSID and, when it
+// matches, sends a BEACON record (TSF, sequence control, RSSI, channel)
+// instead of the whole frame. The host decoder patches the last full
+// frame of that BSSID to rebuild it.
+//
+// Limits of a rebuilt frame:
+//   - its TIM is the one of the last full frame, not its own; a TIM of
+//     a different length changes the frame length and is sent whole
+//   - only the stored bytes (TRIGGER_SNAPLEN) are compared, but only
+//     those are ever sent, so a change past them is lost either way
+//
+// A full frame is still sent every BEACON_REFRESH_MS per BSSID, so a
+// decoder that joins late or lost a record catches up, and a stale TIM
+// is replaced that often.
+
+class BeaconDedup {
+public:
+    // Frame encoder: true if this beacon (stored bytes of a frame len
+    // long) repeats the last full one of its BSSID; false means send it
+    // whole (it is remembered as the new reference)
+    bool unchanged(const uint8_t* frame, size_t stored, uint16_t len, uint32_t now);
+    void reset();
+    
+    // Reads the fields a BEACON record carries
+    static bool isBeacon(const uint8_t* frame, size_t stored);
+    static uint64_t tsf(const uint8_t* frame);
+    static uint16_t seqCtrl(const uint8_t* frame);
+    
+    uint32_t fulls() const { return _fulls; }
+    uint32_t deltas() const { return _deltas; }
+    
+private:
+    struct Entry {
+        uint8_t bssid[6];
+        uint32_t crc;           // Frame without sequence and TSF
+        uint32_t lastFull;      // millis() of the last full frame sent
+        uint32_t lastUsed;      // LRU
+    };
+    
+    Entry _entries[BEACON_CACHE_LEN];
+    uint8_t _count = 0;
+    uint32_t _fulls = 0;
+    uint32_t _deltas = 0;
+};
@@ -0,0 +1,297 @@
+/**
+ * ESP32 Marauder TUI - Capture Log
+ *
+ * Segment files rather than one big circular file: LittleFS handles
+ * wear levelling and power-loss safety per file, and dropping the oldest
+ * segment is one truncate instead of a rewrite.
+ */
+
+#include "CaptureLog.h"
+#include "EventStream.h"
+#include "EventLoop.h"
+#include "Transport.h"
+#include <LittleFS.h>
+
+CaptureLog captureLog;
+
+static const uint32_t SEGMENT_MAGIC = 0x4C43544D;  // "MTCL"
+static const uint16_t SEGMENT_VERSION = 1;
+static const char* const CAPTURE_DIR = "/cap";
+static const size_t FS_RESERVE = 24 * 1024;        // Session file + filesystem metadata
+
+static_assert(CAPTURE_WRITE_CHUNK <= Compressor::BLOCK_MAX, "CAPTURE_WRITE_CHUNK exceeds a block");
+
+void CaptureLog::slotPath(uint8_t slot, char* buf, size_t len) {
+    snprintf(buf, len, "%s/%02u.seg", CAPTURE_DIR, slot);
+}
+
+bool CaptureLog::readHeader(uint8_t slot, SegmentHeader& hdr) {
+    char path[20];
+    slotPath(slot, path, sizeof(path));
+    if (!LittleFS.exists(path)) return false;
+    
+    File f = LittleFS.open(path, FILE_READ);
+    if (!f) return false;
+    bool ok = f.read((uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr) &&
+              hdr.magic == SEGMENT_MAGIC && hdr.headerSize >= sizeof(hdr);
+    f.close();
+    return ok;
+}
+
+bool CaptureLog::begin() {
+    // Whatever the partition holds after the session file, in whole segments
+    size_t total = LittleFS.totalBytes();
+    size_t room = total > FS_RESERVE ? total - FS_RESERVE : 0;
+    _slotCount = min((size_t)CAPTURE_MAX_SEGMENTS, room / CAPTURE_SEGMENT_SIZE);
+    if (_slotCount == 0) return false;
+    
+    LittleFS.mkdir(CAPTURE_DIR);
+    
+    // Continue after the newest segment left by a previous boot
+    bool found = false;
+    for (uint8_t s = 0; s < _slotCount; s++) {
+        SegmentHeader hdr;
+        if (readHeader(s, hdr) && (!found || (int32_t)(hdr.seq - _seq) > 0)) {
+            _seq = hdr.seq;
+            _slot = s;
+            found = true;
+        }
+    }
+    if (found) {
+        _slot = (_slot + 1) % _slotCount;
+        _seq++;
+    }
+    return true;
+}
+
+// ============================================
+// Recording
+// ============================================
+
+bool CaptureLog::openSegment(bool fresh) {
+    char path[20];
+    slotPath(_slot, path, sizeof(path));
+    
+    if (!fresh) {
+        // Keep filling the current segment if it has room
+        _file = LittleFS.open(path, FILE_APPEND);
+        if (_file && _file.size() > 0 && _file.size() < CAPTURE_SEGMENT_SIZE) {
+            _segBytes = _file.size();
+            return true;
+        }
+        if (_file) _file.close();
+        _slot = (_slot + 1) % _slotCount;
+        _seq++;
+        slotPath(_slot, path, sizeof(path));
+    }
+    
+    // "w" truncates: this is where the oldest segment is dropped
+    _file = LittleFS.open(path, FILE_WRITE);
+    if (!_file) return false;
+    
+    SegmentHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = SEGMENT_MAGIC;
+    hdr.version = SEGMENT_VERSION;
+    hdr.headerSize = sizeof(hdr);
+    hdr.seq = _seq;
+    _file.write((const uint8_t*)&hdr, sizeof(hdr));
+    _segBytes = sizeof(hdr);
+    return true;
+}
+
+bool CaptureLog::start() {
+    if (_recording) return true;
+    if (_slotCount == 0) return false;
+    
+    // Resume the segment this boot was writing, else begin the next one
+    if (!openSegment(_segBytes == 0)) return false;
+    _lastSync = millis();
+    _recording = true;
+    return true;
+}
+
+void CaptureLog::stop() {
+    if (!_recording) return;
+    _recording = false;
+    writeStaged(true);
+    _file.close();
+}
+
+void CaptureLog::clear() {
+    bool wasRecording = _recording;
+    stop();
+    
+    char path[20];
+    for (uint8_t s = 0; s < _slotCount; s++) {
+        slotPath(s, path, sizeof(path));
+        LittleFS.remove(path);
+    }
+    portENTER_CRITICAL(&_mux);
+    _stageHead = 0;
+    _stageUsed = 0;
+    _drops = 0;
+    portEXIT_CRITICAL(&_mux);
+    
+    _slot = 0;
+    _seq = 0;
+    _segBytes = 0;
+    if (wasRecording) start();
+}
+
+void CaptureLog::append(const uint8_t* record, size_t len) {
+    if (!_recording) return;
+    
+    portENTER_CRITICAL(&_mux);
+    if (_stageUsed + len > sizeof(_stage)) {
+        _drops++;
+    } else {
+        size_t tail = (_stageHead + _stageUsed) % sizeof(_stage);
+        size_t first = min(len, sizeof(_stage) - tail);
+        memcpy(_stage + tail, record, first);
+        memcpy(_stage, record + first, len - first);
+        _stageUsed += len;
+    }
+    portEXIT_CRITICAL(&_mux);
+}
+
+size_t CaptureLog::takeRecords(uint8_t* out, size_t cap) {
+    // Whole records only, so a segment never ends mid-record
+    size_t n = 0;
+    portENTER_CRITICAL(&_mux);
+    while (_stageUsed >= 4) {
+        uint8_t lenByte = _stage[(_stageHead + 3) % sizeof(_stage)];
+        size_t rec = EventStream::binaryLength(lenByte);
+        if (n + rec > cap) break;
+        for (size_t i = 0; i < rec; i++) {
+            out[n++] = _stage[_stageHead];
+            _stageHead = (_stageHead + 1) % sizeof(_stage);
+        }
+        _stageUsed -= rec;
+    }
+    portEXIT_CRITICAL(&_mux);
+    return n;
+}
+
+void CaptureLog::writeStaged(bool all) {
+    uint8_t chunk[CAPTURE_WRITE_CHUNK];
+#if CAPTURE_COMPRESS
+    uint8_t block[Compressor::BLOCK_MAX + Compressor::OVERHEAD];
+#endif
+
+    while (_stageUsed >= (all ? 1 : CAPTURE_WRITE_CHUNK)) {
+        // Room left in this segment decides how much to take (a block
+        // never comes out longer than its input plus framing)
+        size_t room = CAPTURE_SEGMENT_SIZE - _segBytes;
+#if CAPTURE_COMPRESS
+        room = room > Compressor::OVERHEAD ? room - Compressor::OVERHEAD : 0;
+#endif
+        size_t n = takeRecords(chunk, min(sizeof(chunk), room));
+        if (n == 0) {
+            // Segment full: move to the next slot, overwriting the oldest
+            _file.close();
+            _slot = (_slot + 1) % _slotCount;
+            _seq++;
+            if (!openSegment(true)) {
+                _recording = false;
+                return;
+            }
+            continue;
+        }
+#if CAPTURE_COMPRESS
+        n = _compressor.compress(chunk, n, block, sizeof(block));
+        _file.write(block, n);
+#else
+        _file.write(chunk, n);
+#endif
+        _segBytes += n;
+    }
+}
+
+void CaptureLog::update() {
+    if (!_recording) return;
+    
+    writeStaged(false);
+    
+    // Bound what a power cut can lose: commit the tail now and then
+    if (millis() - _lastSync >= CAPTURE_SYNC_MS) {
+        writeStaged(true);
+        _file.flush();
+        _lastSync = millis();
+    }
+}
+
+uint32_t CaptureLog::nextWakeMs() const {
+    if (!_recording) return EventLoop::FOREVER;
+    if (_stageUsed >= CAPTURE_WRITE_CHUNK) return 0;
+    return msUntil(_lastSync, CAPTURE_SYNC_MS, millis());
+}
+
+// ============================================
+// Readout
+// ============================================
+
+uint32_t CaptureLog::storedBytes() const {
+    uint32_t total = 0;
+    char path[20];
+    for (uint8_t s = 0; s < _slotCount; s++) {
+        slotPath(s, path, sizeof(path));
+        if (!LittleFS.exists(path)) continue;
+        File f = LittleFS.open(path, FILE_READ);
+        if (f && f.size() > sizeof(SegmentHeader)) total += f.size() - sizeof(SegmentHeader);
+        f.close();
+    }
+    return total;
+}
+
+size_t CaptureLog::dump(Stream& out) {
+    // Everything staged goes to flash first so the dump is complete
+    if (_recording) {
+        writeStaged(true);
+        _file.flush();
+    }
+    
+    // Segments in sequence order (slot count is small)
+    uint8_t order[CAPTURE_MAX_SEGMENTS];
+    uint32_t seqs[CAPTURE_MAX_SEGMENTS];
+    uint8_t count = 0;
+    for (uint8_t s = 0; s < _slotCount; s++) {
+        SegmentHeader hdr;
+        if (!readHeader(s, hdr)) continue;
+        uint8_t i = count++;
+        while (i > 0 && (int32_t)(seqs[i - 1] - hdr.seq) > 0) {
+            order[i] = order[i - 1];
+            seqs[i] = seqs[i - 1];
+            i--;
+        }
+        order[i] = s;
+        seqs[i] = hdr.seq;
+    }
+    
+    uint8_t chunk[512];
+    size_t written = 0;
+    char path[20];
+    for (uint8_t i = 0; i < count; i++) {
+        slotPath(order[i], path, sizeof(path));
+        File f = LittleFS.open(path, FILE_READ);
+        if (!f) continue;
+        SegmentHeader hdr;
+        f.read((uint8_t*)&hdr, sizeof(hdr));
+        f.seek(hdr.headerSize);
+        
+        size_t n;
+        while ((n = f.read(chunk, sizeof(chunk))) > 0) {
+            // Blocking writes: the dump runs at whatever the link sustains
+            out.write(chunk, n);
+            written += n;
+            if (console.available()) {
+                console.read();  // The key only stops the dump
+                f.close();
+                return written;
+            }
+        }
+        f.close();
+    }
+    out.flush();
+    return written;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Compressor.h"
+#include <FS.h>
+#include <freertos/FreeRTOS.h>
+
+// ============================================
+// Capture Log
+// Append-only event log in a ring of flash segments
+// ============================================
+//
+// While recording, every event the analyzers emit is stored as a binary
+// stream record (see EventStream.h), whatever the output mode, so a run
+// can be captured with no host attached and read out later.
+//
+// The log is CAPTURE_SEGMENT_SIZE files under /cap, as many as the
+// partition holds (up to CAPTURE_MAX_SEGMENTS). Each segment starts with
+// a small header carrying a sequence number; when the last slot is full
+// the oldest segment is truncated and reused. Producers append whole
+// records to a RAM staging ring; the main loop writes them out in
+// CAPTURE_WRITE_CHUNK pieces, so flash sees few, page-sized, strictly
+// sequential writes, and nothing is ever rewritten in place. With
+// CAPTURE_COMPRESS each write is one LZSS block (see Compressor.h), so a
+// segment holds more records.
+//
+// dump() writes every stored record, oldest first, as one stream that
+// tools/decode_events.py decodes like live binary output.
+
+class CaptureLog {
+public:
+    // After the LittleFS partition is mounted (SessionStore::begin)
+    bool begin();
+    bool available() const { return _slotCount > 0; }
+    
+    bool start();
+    void stop();
+    bool recording() const { return _recording; }
+    void clear();
+    
+    // Any task: one whole encoded record; dropped (and counted) if the
+    // staging ring is full
+    void append(const uint8_t* record, size_t len);
+    
+    // Main loop: move staged records to flash
+    void update();
+    uint32_t nextWakeMs() const;
+    
+    // Write every stored record, oldest first; a key on the console stops
+    // it early. Returns the number of bytes written.
+    size_t dump(Stream& out);
+    
+    uint8_t segmentCount() const { return _slotCount; }
+    uint32_t storedBytes() const;
+    uint32_t drops() const { return _drops; }
+    size_t room() const { return sizeof(_stage) - _stageUsed; }
+    const Compressor& compressor() const { return _compressor; }
+    
+private:
+    struct __attribute__((packed)) SegmentHeader {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t headerSize;
+        uint32_t seq;           // Increases with every new segment
+        uint32_t reserved;
+    };
+    
+    uint8_t _stage[CAPTURE_STAGE_BUF];
+    size_t _stageHead = 0;
+    size_t _stageUsed = 0;
+    uint32_t _drops = 0;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    
+    bool _recording = false;
+    uint8_t _slotCount = 0;
+    uint8_t _slot = 0;          // Segment being written
+    uint32_t _seq = 0;          // Its sequence number
+    uint32_t _segBytes = 0;     // Its size so far
+    File _file;
+    uint32_t _lastSync = 0;
+    Compressor _compressor;
+    
+    static void slotPath(uint8_t slot, char* buf, size_t len);
+    bool readHeader(uint8_t slot, SegmentHeader& hdr);
+    bool openSegment(bool fresh);
+    size_t takeRecords(uint8_t* out, size_t cap);
+    void writeStaged(bool all);
+};
+
+// Global instance
+extern CaptureLog captureLog;
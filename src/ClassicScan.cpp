@@ -0,0 +1,303 @@
+/**
+ * ESP32 Marauder TUI - Classic Scan
+ *
+ * Bluedroid runs only for the inquiry and its name requests; outside
+ * them the controller and heap are NimBLE's as usual.
+ */
+
+#include "ClassicScan.h"
+#include "BTAttacks.h"
+#include "SignatureSet.h"
+#include "SerialTUI.h"
+#include "Transport.h"
+#include "EventLoop.h"
+
+#if BT_CLASSIC_SCAN && defined(CONFIG_BT_CLASSIC_ENABLED)
+#define CLASSIC_ENABLED 1
+#include <esp_bt.h>
+#include <esp_bt_main.h>
+#include <esp_gap_bt_api.h>
+#else
+#define CLASSIC_ENABLED 0
+#endif
+
+ClassicScan classicScan;
+
+// Inquiry as long as asked for, plus the controller's wind-down
+static const uint32_t INQUIRY_MS = CLASSIC_INQUIRY_LEN * 1280 + 2000;
+
+bool ClassicScan::supported() {
+    return CLASSIC_ENABLED;
+}
+
+#if CLASSIC_ENABLED
+
+// Every esp_bt_controller_mem_release() call lands here (linked with
+// --wrap). Classic memory is kept: once released it cannot come back.
+extern "C" esp_err_t __real_esp_bt_controller_mem_release(esp_bt_mode_t mode);
+extern "C" esp_err_t __wrap_esp_bt_controller_mem_release(esp_bt_mode_t mode) {
+    if (mode & ESP_BT_MODE_CLASSIC_BT) return ESP_OK;
+    return __real_esp_bt_controller_mem_release(mode);
+}
+
+static void onGap(esp_bt_gap_cb_event_t event, esp_bt_gap_cb_param_t* param) {
+    switch (event) {
+        case ESP_BT_GAP_DISC_RES_EVT: {
+            int8_t rssi = 0;
+            uint8_t* name = nullptr;
+            uint8_t nameLen = 0;
+            for (int i = 0; i < param->disc_res.num_prop; i++) {
+                esp_bt_gap_dev_prop_t& prop = param->disc_res.prop[i];
+                if (prop.type == ESP_BT_GAP_DEV_PROP_RSSI) {
+                    rssi = *(int8_t*)prop.val;
+                } else if (prop.type == ESP_BT_GAP_DEV_PROP_BDNAME && name == nullptr) {
+                    name = (uint8_t*)prop.val;
+                    nameLen = min(prop.len, (int)UINT8_MAX);
+                } else if (prop.type == ESP_BT_GAP_DEV_PROP_EIR && name == nullptr) {
+                    uint8_t* eir = (uint8_t*)prop.val;
+                    name = esp_bt_gap_resolve_eir_data(eir, ESP_BT_EIR_TYPE_CMPL_LOCAL_NAME, &nameLen);
+                    if (name == nullptr) {
+                        name = esp_bt_gap_resolve_eir_data(eir, ESP_BT_EIR_TYPE_SHRT_LOCAL_NAME, &nameLen);
+                    }
+                }
+            }
+            classicScan.onDevice(param->disc_res.bda, rssi, name, name ? nameLen : 0);
+            break;
+        }
+        
+        case ESP_BT_GAP_DISC_STATE_CHANGED_EVT:
+            if (param->disc_st_chg.state == ESP_BT_GAP_DISCOVERY_STOPPED) classicScan.onInquiryDone();
+            break;
+            
+        case ESP_BT_GAP_READ_REMOTE_NAME_EVT:
+            classicScan.onName(param->read_rmt_name.bda, param->read_rmt_name.stat == ESP_BT_STATUS_SUCCESS,
+                               param->read_rmt_name.rmt_name);
+            break;
+            
+        default:
+            break;
+    }
+}
+
+bool ClassicScan::classicUp() {
+    esp_bt_controller_config_t cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
+    if (esp_bt_controller_init(&cfg) != ESP_OK) return false;
+    if (esp_bt_controller_enable(ESP_BT_MODE_BTDM) != ESP_OK) return false;
+    if (esp_bluedroid_init() != ESP_OK || esp_bluedroid_enable() != ESP_OK) return false;
+    if (esp_bt_gap_register_callback(onGap) != ESP_OK) return false;
+    // Listen only: not connectable, not discoverable
+    esp_bt_gap_set_scan_mode(ESP_BT_NON_CONNECTABLE, ESP_BT_NON_DISCOVERABLE);
+    return true;
+}
+
+// Also undoes a partial classicUp(); steps that were not reached just fail
+void ClassicScan::classicDown() {
+    esp_bluedroid_disable();
+    esp_bluedroid_deinit();
+    esp_bt_controller_disable();
+    esp_bt_controller_deinit();
+}
+
+#else
+
+bool ClassicScan::classicUp() { return false; }
+void ClassicScan::classicDown() {}
+
+#endif
+
+void ClassicScan::start() {
+    if (!supported() || _failed) return;
+    if (console.kind() == TransportKind::BLE_NUS) {
+        tui.printResult("Classic inquiry off: the console is on BLE", ResultKind::INFO);
+        return;
+    }
+    _state = State::LE;
+    _stateStart = millis();
+    _inquiries = 0;
+    _found = 0;
+    _named = 0;
+    
+    char buf[64];
+    snprintf(buf, sizeof(buf), "Classic inquiry every %u s, %u s long",
+             CLASSIC_LE_SLICE_MS / 1000, CLASSIC_INQUIRY_LEN * 128 / 100);
+    tui.printResult(buf, ResultKind::INFO);
+}
+
+void ClassicScan::stop() {
+    if (_state == State::OFF) return;
+    bool classic = _state != State::LE;
+    _state = State::OFF;
+    if (!classic) return;
+    
+#if CLASSIC_ENABLED
+    esp_bt_gap_cancel_discovery();
+#endif
+    classicDown();
+    btAttacks.reclaimRadio();
+    console.resume();
+}
+
+void ClassicScan::enterInquiry() {
+    portENTER_CRITICAL(&_mux);
+    _pendingCount = 0;
+    _nameNext = 0;
+    _nameTries = 0;
+    _inquiryDone = false;
+    portEXIT_CRITICAL(&_mux);
+    
+    btAttacks.releaseRadio();
+    bool ok = classicUp();
+#if CLASSIC_ENABLED
+    ok = ok && esp_bt_gap_start_discovery(ESP_BT_INQ_MODE_GENERAL_INQUIRY, CLASSIC_INQUIRY_LEN, 0) == ESP_OK;
+#endif
+    if (!ok) {
+        // Not for this boot: carry on LE only
+        classicDown();
+        btAttacks.reclaimRadio();
+        console.resume();
+        _failed = true;
+        _state = State::OFF;
+        tui.printError("Classic inquiry unavailable, LE only");
+        return;
+    }
+    _inquiries++;
+    _state = State::INQUIRY;
+    _stateStart = millis();
+}
+
+void ClassicScan::enterLe() {
+    classicDown();
+    btAttacks.reclaimRadio();
+    console.resume();
+    _state = State::LE;
+    _stateStart = millis();
+    
+    char buf[64];
+    snprintf(buf, sizeof(buf), "Classic inquiry %lu: %lu responses, %lu names so far",
+             (unsigned long)_inquiries, (unsigned long)_found, (unsigned long)_named);
+    tui.printResult(buf, ResultKind::INFO);
+}
+
+// Next device without a name; false when none are left
+bool ClassicScan::requestName() {
+    portENTER_CRITICAL(&_mux);
+    bool have = _nameNext < _pendingCount;
+    if (have) {
+        memcpy(_nameBda, _pending[_nameNext], 6);
+        _nameRssi = _pendingRssi[_nameNext];
+        _nameDone = false;
+        _nameSent = true;       // A fast reply may beat the return below
+    }
+    portEXIT_CRITICAL(&_mux);
+    if (!have) return false;
+    
+    bool sent = true;
+#if CLASSIC_ENABLED
+    sent = esp_bt_gap_read_remote_name(_nameBda) == ESP_OK;
+#endif
+    // Refused (busy, usually with a late reply to the last one): the same
+    // device again after CLASSIC_NAME_RETRY_MS, a few times at most
+    if (!sent) _nameSent = false;
+    if (sent || ++_nameTries >= CLASSIC_NAME_TRIES) {
+        _nameNext++;
+        _nameTries = 0;
+    }
+    _state = State::NAMES;
+    _stateStart = millis();
+    return true;
+}
+
+// A refused request is retried sooner than an accepted one times out
+uint32_t ClassicScan::nameWaitMs() const {
+    return _nameSent ? CLASSIC_NAME_TIMEOUT_MS : CLASSIC_NAME_RETRY_MS;
+}
+
+void ClassicScan::update() {
+    uint32_t now = millis();
+    switch (_state) {
+        case State::LE:
+            if (now - _stateStart >= CLASSIC_LE_SLICE_MS) enterInquiry();
+            break;
+            
+        case State::INQUIRY:
+            if (_inquiryDone || now - _stateStart >= INQUIRY_MS) {
+#if CLASSIC_ENABLED
+                if (!_inquiryDone) esp_bt_gap_cancel_discovery();
+#endif
+                if (!requestName()) enterLe();
+            }
+            break;
+            
+        case State::NAMES:
+            if (_nameDone || now - _stateStart >= nameWaitMs()) {
+                if (!requestName()) enterLe();
+            }
+            break;
+            
+        default:
+            break;
+    }
+}
+
+uint32_t ClassicScan::nextWakeMs() const {
+    uint32_t now = millis();
+    switch (_state) {
+        case State::LE:      return msUntil(_stateStart, CLASSIC_LE_SLICE_MS, now);
+        case State::INQUIRY: return msUntil(_stateStart, INQUIRY_MS, now);
+        case State::NAMES:   return msUntil(_stateStart, nameWaitMs(), now);
+        default:             return EventLoop::FOREVER;
+    }
+}
+
+// Into the BLE device table, through the same signatures as LE names
+void ClassicScan::report(const uint8_t* bda, int8_t rssi, const uint8_t* name, uint8_t nameLen) {
+    BTHit hit;
+    memcpy(hit.mac, bda, 6);    // Bluedroid keeps display order
+    hit.rssi = rssi;
+    hit.cls = nameLen ? signatures.matchName(name, nameLen) : BLEClass::DEVICE;
+    hit.nameLen = min((size_t)nameLen, sizeof(hit.name) - 1);
+    if (hit.nameLen) memcpy(hit.name, name, hit.nameLen);
+    hit.name[hit.nameLen] = '\0';
+    // Only the skimmer scan runs inquiries
+    btAttacks.noteAdvert(hit, BT_ADDR_CLASSIC, 0, hit.cls == BLEClass::SKIMMER);
+}
+
+void ClassicScan::onDevice(const uint8_t* bda, int8_t rssi, const uint8_t* name, uint8_t nameLen) {
+    portENTER_CRITICAL(&_mux);
+    _found++;
+    // No name in the inquiry response: ask once the inquiry is over
+    if (nameLen == 0 && _pendingCount < CLASSIC_NAME_QUEUE) {
+        bool queued = false;
+        for (uint8_t i = 0; i < _pendingCount && !queued; i++) {
+            queued = memcmp(_pending[i], bda, 6) == 0;
+        }
+        if (!queued) {
+            memcpy(_pending[_pendingCount], bda, 6);
+            _pendingRssi[_pendingCount] = rssi;
+            _pendingCount++;
+        }
+    }
+    portEXIT_CRITICAL(&_mux);
+    report(bda, rssi, name, nameLen);
+}
+
+void ClassicScan::onInquiryDone() {
+    _inquiryDone = true;
+    events.post(EventType::ALERT);
+}
+
+void ClassicScan::onName(const uint8_t* bda, bool ok, const uint8_t* name) {
+    // A late reply to a request that timed out is not this one's
+    portENTER_CRITICAL(&_mux);
+    bool ours = _state == State::NAMES && _nameSent && memcmp(bda, _nameBda, 6) == 0;
+    int8_t rssi = _nameRssi;
+    portEXIT_CRITICAL(&_mux);
+    if (!ours) return;
+    
+    if (ok && name[0] != '\0') {
+        _named++;
+        report(bda, rssi, name, strnlen((const char*)name, UINT8_MAX));
+    }
+    _nameDone = true;
+    events.post(EventType::ALERT);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include <freertos/FreeRTOS.h>
+
+// ============================================
+// Classic Scan
+// BR/EDR inquiry alongside the BLE skimmer scan
+// ============================================
+//
+// The serial modules found in card skimmers (HC-05, HC-06, RNBT...) are
+// mostly Bluetooth Classic and never show up in an LE scan. On the
+// ESP32 (the only target here with a BR/EDR radio, built with
+// BT_CLASSIC_SCAN) the skimmer scan therefore alternates:
+//
+//   LE scan for CLASSIC_LE_SLICE_MS
+//   inquiry for CLASSIC_INQUIRY_LEN x 1.28 s (names from EIR where sent)
+//   remote name requests for devices that sent none, one at a time
+//
+// A name request that times out may still be answered during the next
+// one; replies are matched to the request by address, and a request
+// the stack refuses while it is busy is retried rather than skipped.
+//
+// Inquiry results go into the BTAttacks device table (address type
+// BT_ADDR_CLASSIC) and their names through the same signatures as LE
+// names, so hits are reported like BLE ones.
+//
+// The controller can do both, but the NimBLE host has no BR/EDR side,
+// so inquiry runs on Bluedroid: NimBLE is shut down for the inquiry and
+// brought back after it (a few hundred ms each way). LE scanning and the
+// BLE console's advertising stop meanwhile, and none of this runs with
+// the console on BLE. If Bluedroid cannot start (no heap) the scan
+// carries on LE only.
+//
+// NimBLE-Arduino hands the classic half of the controller memory back to
+// the heap at its first init, after which BR/EDR cannot start again until
+// reboot. Builds with BT_CLASSIC_SCAN link with
+// -Wl,--wrap=esp_bt_controller_mem_release (see platformio.ini) so that
+// this release is refused and the memory stays reserved for the inquiry.
+
+// BTDevice::addrType of inquiry results
+static const uint8_t BT_ADDR_CLASSIC = 0xFF;
+
+class ClassicScan {
+public:
+    static bool supported();
+    
+    // With the skimmer scan: start / stop the alternation (LE first)
+    void start();
+    void stop();
+    bool active() const { return _state != State::OFF; }
+    
+    // Main loop
+    void update();
+    uint32_t nextWakeMs() const;
+    
+    // Bluedroid task
+    void onDevice(const uint8_t* bda, int8_t rssi, const uint8_t* name, uint8_t nameLen);
+    void onInquiryDone();
+    void onName(const uint8_t* bda, bool ok, const uint8_t* name);
+    
+private:
+    enum class State : uint8_t { OFF, LE, INQUIRY, NAMES };
+    
+    State _state = State::OFF;
+    uint32_t _stateStart = 0;
+    bool _failed = false;           // Bluedroid would not start; LE only
+    
+    // Shared with the Bluedroid task under _mux
+    volatile bool _inquiryDone = false;
+    volatile bool _nameDone = false;
+    uint8_t _pending[CLASSIC_NAME_QUEUE][6];
+    int8_t _pendingRssi[CLASSIC_NAME_QUEUE];
+    uint8_t _pendingCount = 0;
+    uint8_t _nameNext = 0;          // Next to request
+    uint8_t _nameTries = 0;         // Refused requests for it so far
+    bool _nameSent = false;         // Accepted by the stack, else retried
+    uint8_t _nameBda[6];            // Request in flight
+    int8_t _nameRssi = 0;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    
+    uint32_t _inquiries = 0;
+    uint32_t _found = 0;            // Inquiry responses
+    uint32_t _named = 0;
+    
+    bool classicUp();
+    void classicDown();
+    void enterInquiry();
+    void enterLe();
+    bool requestName();
+    uint32_t nameWaitMs() const;
+    void report(const uint8_t* bda, int8_t rssi, const uint8_t* name, uint8_t nameLen);
+};
+
+// Global instance
+extern ClassicScan classicScan;
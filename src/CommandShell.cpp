@@ -0,0 +1,895 @@
+/**
+ * ESP32 Marauder TUI - Command Shell
+ *
+ * Lets multi-step runs ("scan, pick targets, attack for 60 s, sniff for
+ * 5 min") go unattended instead of needing a human at every menu step.
+ */
+
+#include "CommandShell.h"
+#include "SerialTUI.h"
+#include "WiFiAttacks.h"
+#include "BTAttacks.h"
+#include "APSelector.h"
+#include "EventLoop.h"
+#include "EventStream.h"
+#include "Transport.h"
+#include "SessionStore.h"
+#include "CaptureLog.h"
+#include "FrameTrigger.h"
+#include "Compressor.h"
+#include "MacFilter.h"
+#include "RadioSurvey.h"
+#include "TrackerWatch.h"
+#include "SignatureSet.h"
+
+CommandShell shell;
+
+// Command words (lower case, single spaces) -> menu action
+struct RunCommand {
+    const char* words;
+    MenuAction action;
+};
+
+static const RunCommand RUN_COMMANDS[] = {
+    {"scan ap",         MenuAction::WIFI_SCAN_AP},
+    {"scan sta",        MenuAction::WIFI_SCAN_STA},
+    {"live",            MenuAction::WIFI_LIVE_VIEW},
+    {"survey",          MenuAction::WIFI_SURVEY},
+    {"sniff beacon",    MenuAction::WIFI_SNIFF_BEACON},
+    {"sniff probe",     MenuAction::WIFI_SNIFF_PROBE},
+    {"sniff deauth",    MenuAction::WIFI_SNIFF_DEAUTH},
+    {"sniff pmkid",     MenuAction::WIFI_SNIFF_PMKID},
+    {"sniff pwn",       MenuAction::WIFI_SNIFF_PWN},
+    {"sniff raw",       MenuAction::WIFI_SNIFF_RAW},
+    {"attack deauth",   MenuAction::WIFI_ATTACK_DEAUTH},
+    {"attack beacon",   MenuAction::WIFI_ATTACK_BEACON_RANDOM},
+    {"attack list",     MenuAction::WIFI_ATTACK_BEACON_LIST},
+    {"attack rickroll", MenuAction::WIFI_ATTACK_RICKROLL},
+    {"attack funny",    MenuAction::WIFI_ATTACK_FUNNY},
+    {"bt scan",         MenuAction::BT_SCAN_ALL},
+    {"bt scan all",     MenuAction::BT_SCAN_ALL},
+    {"bt scan airtag",  MenuAction::BT_SCAN_AIRTAG},
+    {"bt scan flipper", MenuAction::BT_SCAN_FLIPPER},
+    {"bt scan skimmer", MenuAction::BT_SCAN_SKIMMER},
+    {"bt spam apple",   MenuAction::BT_SPAM_APPLE},
+    {"bt spam windows", MenuAction::BT_SPAM_WINDOWS},
+    {"bt spam samsung", MenuAction::BT_SPAM_SAMSUNG},
+    {"bt spam google",  MenuAction::BT_SPAM_GOOGLE},
+    {"bt spam all",     MenuAction::BT_SPAM_ALL},
+    {"list ap",         MenuAction::TARGETS_LIST_AP},
+    {"list sta",        MenuAction::TARGETS_LIST_STA},
+    {"list ssid",       MenuAction::TARGETS_LIST_SSID},
+};
+
+static const char* skipSpaces(const char* s) {
+    while (*s == ' ') s++;
+    return s;
+}
+
+// Table names accept the singular/plural forms used in the menus
+static const char* tableName(const char* word) {
+    if (strcmp(word, "ap") == 0 || strcmp(word, "aps") == 0) return "ap";
+    if (strcmp(word, "sta") == 0 || strcmp(word, "stations") == 0) return "sta";
+    if (strcmp(word, "ssid") == 0 || strcmp(word, "ssids") == 0) return "ssid";
+    return nullptr;
+}
+
+// AA:BB:CC:DD:EE:FF (or '-' separated)
+static bool parseMac(const char* text, uint8_t* mac) {
+    for (int i = 0; i < 6; i++) {
+        char* end = nullptr;
+        long b = strtol(text, &end, 16);
+        if (end - text != 2 || b < 0) return false;
+        if (i < 5 && *end != ':' && *end != '-') return false;
+        if (i == 5 && *end != '\0') return false;
+        mac[i] = b;
+        text = end + 1;
+    }
+    return true;
+}
+
+// ============================================
+// Parsing
+// ============================================
+
+bool CommandShell::submit(const char* line) {
+    char buf[COMMAND_LINE_LEN];
+    char* save = nullptr;
+    bool ok = true;
+    
+    // Every queued command must parse before any command of the chain
+    // runs; parse() reports the first bad one
+    strncpy(buf, line, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    for (char* cmd = strtok_r(buf, ";", &save); cmd; cmd = strtok_r(nullptr, ";", &save)) {
+        cmd = (char*)skipSpaces(cmd);
+        if (*cmd == '\0' || immediate(cmd, false, ok)) continue;
+        Job job;
+        memset(&job, 0, sizeof(job));
+        if (!parse(cmd, job)) return false;
+    }
+    
+    // parse() took the words apart: split a fresh copy
+    strncpy(buf, line, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    uint8_t queued = 0;
+    for (char* cmd = strtok_r(buf, ";", &save); ok && cmd; cmd = strtok_r(nullptr, ";", &save)) {
+        cmd = (char*)skipSpaces(cmd);
+        if (*cmd == '\0') continue;
+        if (immediate(cmd, true, ok)) {
+            if (strcasecmp(cmd, "cancel") == 0) queued = 0;
+            continue;
+        }
+        
+        Job job;
+        memset(&job, 0, sizeof(job));
+        strncpy(job.label, cmd, sizeof(job.label) - 1);
+        ok = parse(cmd, job);
+        if (ok && !enqueue(job)) {
+            tui.printError("Job queue full");
+            ok = false;
+        }
+        if (ok) queued++;
+    }
+    
+    if (!ok) {
+        // A bad argument to an immediate command (or a full queue) is only
+        // found as the chain runs: the immediate commands before it have
+        // taken effect, but none of its jobs are left queued
+        _count -= queued;
+        return false;
+    }
+    
+    if (queued > 0) {
+        char msg[40];
+        snprintf(msg, sizeof(msg), "Queued %u job(s), %u pending", queued, _count);
+        tui.printStatus(msg);
+    }
+    return true;
+}
+
+// Commands that act at once rather than as a job. False if cmd is not
+// one; with run false it is only recognised. ok is false if it failed.
+bool CommandShell::immediate(char* cmd, bool run, bool& ok) {
+    ok = true;
+    if (strcasecmp(cmd, "help") == 0) {
+        if (run) printHelp();
+        return true;
+    }
+    if (strcasecmp(cmd, "jobs") == 0) {
+        if (run) listJobs();
+        return true;
+    }
+    if (strcasecmp(cmd, "cancel") == 0) {
+        if (run) {
+            cancel();
+            tui.printStatus("Job queue cleared");
+        }
+        return true;
+    }
+    if (strncasecmp(cmd, "output ", 7) == 0) {
+        if (run) ok = setOutput(skipSpaces(cmd + 7));
+        return true;
+    }
+    if (strncasecmp(cmd, "console ", 8) == 0) {
+        if (run) ok = setConsole(skipSpaces(cmd + 8));
+        return true;
+    }
+    if (strncasecmp(cmd, "baud ", 5) == 0) {
+        if (run) ok = setBaud(skipSpaces(cmd + 5));
+        return true;
+    }
+    if (strncasecmp(cmd, "session ", 8) == 0) {
+        if (run) ok = runSession(skipSpaces(cmd + 8));
+        return true;
+    }
+    if (strncasecmp(cmd, "trigger", 7) == 0 && (cmd[7] == ' ' || cmd[7] == '\0')) {
+        if (run) ok = runTrigger(cmd + 7);
+        return true;
+    }
+    if (strncasecmp(cmd, "compress ", 9) == 0) {
+        if (run) ok = runCompress(skipSpaces(cmd + 9));
+        return true;
+    }
+    if (strncasecmp(cmd, "bt profile", 10) == 0 && (cmd[10] == ' ' || cmd[10] == '\0')) {
+        if (run) ok = setBtProfile(skipSpaces(cmd + 10));
+        return true;
+    }
+    if (strncasecmp(cmd, "macs", 4) == 0 && (cmd[4] == ' ' || cmd[4] == '\0')) {
+        if (run) ok = runMacs(skipSpaces(cmd + 4));
+        return true;
+    }
+    if (strncasecmp(cmd, "tracker", 7) == 0 && (cmd[7] == ' ' || cmd[7] == '\0')) {
+        if (run) ok = runTracker(cmd + 7);
+        return true;
+    }
+    if (strncasecmp(cmd, "sig", 3) == 0 && (cmd[3] == ' ' || cmd[3] == '\0')) {
+        if (run) ok = runSig(skipSpaces(cmd + 3));
+        return true;
+    }
+    if (strncasecmp(cmd, "log ", 4) == 0) {
+        if (run) ok = runLog(skipSpaces(cmd + 4));
+        return true;
+    }
+    return false;
+}
+
+bool CommandShell::parse(char* cmd, Job& job) {
+    char err[48];
+    
+    // Commands whose argument is free text (may contain '=' and spaces)
+    if (strncasecmp(cmd, "select ", 7) == 0) {
+        job.type = JobType::SELECT;
+        strncpy(job.arg, skipSpaces(cmd + 7), sizeof(job.arg) - 1);
+        return true;
+    }
+    if (strncasecmp(cmd, "ssid add ", 9) == 0) {
+        job.type = JobType::ADD_SSID;
+        strncpy(job.arg, skipSpaces(cmd + 9), sizeof(job.arg) - 1);
+        return job.arg[0] != '\0';
+    }
+    
+    // Split words from key=value options
+    char words[COMMAND_LINE_LEN] = "";
+    char opts[COMMAND_LINE_LEN] = "";
+    char* save = nullptr;
+    for (char* tok = strtok_r(cmd, " ", &save); tok; tok = strtok_r(nullptr, " ", &save)) {
+        for (char* p = tok; *p; p++) *p = tolower(*p);
+        char* dst = strchr(tok, '=') ? opts : words;
+        if (dst[0]) strncat(dst, " ", COMMAND_LINE_LEN - strlen(dst) - 1);
+        strncat(dst, tok, COMMAND_LINE_LEN - strlen(dst) - 1);
+    }
+    
+    if (strncmp(words, "wait ", 5) == 0 || strncmp(words, "channel ", 8) == 0) {
+        bool wait = words[0] == 'w';
+        char* end = nullptr;
+        long n = strtol(strchr(words, ' ') + 1, &end, 10);
+        if (*end != '\0' || n < 1 || (!wait && n > MAX_CHANNEL)) {
+            snprintf(err, sizeof(err), "Bad number: %s", words);
+            tui.printError(err);
+            return false;
+        }
+        job.type = wait ? JobType::WAIT : JobType::CHANNEL;
+        job.durationMs = wait ? n * 1000UL : 0;
+        job.channels[0] = n;
+        return true;
+    }
+    
+    if (strncmp(words, "export ", 7) == 0) {
+        const char* table = tableName(words + 7);
+        if (table == nullptr) {
+            tui.printError("Export what? ap, sta or ssid");
+            return false;
+        }
+        job.type = JobType::EXPORT;
+        strncpy(job.arg, table, sizeof(job.arg) - 1);
+        return true;
+    }
+    
+    // "list stations" etc. share the run table's short names
+    if (strncmp(words, "list ", 5) == 0 && tableName(words + 5)) {
+        snprintf(words, sizeof(words), "list %s", tableName(words + 5));
+    }
+    
+    for (const RunCommand& rc : RUN_COMMANDS) {
+        if (strcmp(words, rc.words) == 0) {
+            job.type = JobType::RUN;
+            job.action = rc.action;
+            return parseOptions(opts, job);
+        }
+    }
+    
+    snprintf(err, sizeof(err), "Unknown command: %.28s", words);
+    tui.printError(err);
+    return false;
+}
+
+bool CommandShell::parseOptions(char* opts, Job& job) {
+    char* save = nullptr;
+    for (char* tok = strtok_r(opts, " ", &save); tok; tok = strtok_r(nullptr, " ", &save)) {
+        char* end = nullptr;
+        bool ok = false;
+        
+        if (strncmp(tok, "dur=", 4) == 0) {
+            long secs = strtol(tok + 4, &end, 10);
+            ok = *end == '\0' && secs > 0;
+            job.durationMs = secs * 1000UL;
+        } else if (strncmp(tok, "ch=", 3) == 0) {
+            // Comma-separated channel list
+            char* p = tok + 3;
+            ok = *p != '\0';
+            while (ok && *p) {
+                long ch = strtol(p, &end, 10);
+                ok = end != p && ch >= 1 && ch <= MAX_CHANNEL && job.channelCount < MAX_CHANNEL;
+                if (ok) job.channels[job.channelCount++] = ch;
+                p = (*end == ',') ? end + 1 : end;
+            }
+        } else if (strncmp(tok, "wifi=", 5) == 0 || strncmp(tok, "ble=", 4) == 0) {
+            // Survey slice lengths, ms
+            bool wifi = tok[0] == 'w';
+            long ms = strtol(strchr(tok, '=') + 1, &end, 10);
+            ok = *end == '\0' && ms >= 20 && ms <= 10000;
+            job.sliceMs[wifi ? 0 : 1] = ms;
+        }
+        
+        if (!ok) {
+            char err[48];
+            snprintf(err, sizeof(err), "Bad option: %.32s", tok);
+            tui.printError(err);
+            return false;
+        }
+    }
+    return true;
+}
+
+// ============================================
+// Job Queue
+// ============================================
+
+bool CommandShell::enqueue(const Job& job) {
+    if (_count >= JOB_QUEUE_LEN) return false;
+    _jobs[(_head + _count) % JOB_QUEUE_LEN] = job;
+    _count++;
+    return true;
+}
+
+void CommandShell::cancel() {
+    _count = 0;
+    _running = false;
+    wifiAttacks.setHopChannels(nullptr, 0);
+}
+
+bool CommandShell::canStart() const {
+    // Never start over a run or an interactive screen the user is in
+    return _count > 0 && !_running && !tui.isScanning() && !tui.isInInputMode() &&
+           tui.getPendingAction() == MenuAction::NONE;
+}
+
+MenuAction CommandShell::update() {
+    uint32_t now = millis();
+    
+    if (_running) {
+        bool active = wifiAttacks.isActive() || btAttacks.isActive();
+        bool timedOut = _current.durationMs > 0 && now - _startTime >= _current.durationMs;
+        
+        if (_current.type == JobType::WAIT) {
+            if (!timedOut) return MenuAction::NONE;
+        } else if (active && !timedOut) {
+            return MenuAction::NONE;
+        }
+        
+        // Job over: restore the default channel plan and leave the live
+        // layout so the next job starts from the menu
+        _running = false;
+        wifiAttacks.setHopChannels(nullptr, 0);
+        radioSurvey.setSlices(0, 0);
+        if (tui.isScanning()) return MenuAction::BACK;
+    }
+    
+    if (!canStart()) return MenuAction::NONE;
+    
+    _current = _jobs[_head];
+    _head = (_head + 1) % JOB_QUEUE_LEN;
+    _count--;
+    _startTime = now;
+    
+    if (_current.type != JobType::RUN) {
+        _running = !runInline(_current);
+        return MenuAction::NONE;
+    }
+    
+    wifiAttacks.setHopChannels(_current.channels, _current.channelCount);
+    radioSurvey.setSlices(_current.sliceMs[0], _current.sliceMs[1]);
+    _running = true;
+    return _current.action;
+}
+
+uint32_t CommandShell::nextWakeMs() const {
+    if (_running) {
+        if (_current.durationMs > 0) {
+            return msUntil(_startTime, _current.durationMs, millis());
+        }
+        // Untimed run: goes on until stopped by a key, which cancels us
+        return (wifiAttacks.isActive() || btAttacks.isActive()) ? EventLoop::FOREVER : 0;
+    }
+    return canStart() ? 0 : EventLoop::FOREVER;
+}
+
+// Jobs that complete on the spot; false = still running (WAIT)
+bool CommandShell::runInline(const Job& job) {
+    switch (job.type) {
+        case JobType::WAIT:
+            return false;
+            
+        case JobType::SELECT:
+            if (strcasecmp(job.arg, "all") == 0 || strcasecmp(job.arg, "none") == 0) {
+                apSelector.setFilter("");
+            } else if (!apSelector.setFilter(job.arg)) {
+                tui.printError("Bad select filter");
+                return true;
+            }
+            apSelector.refresh();
+            apSelector.selectView(strcasecmp(job.arg, "none") != 0);
+            {
+                char msg[40];
+                snprintf(msg, sizeof(msg), "%s %u APs",
+                         strcasecmp(job.arg, "none") != 0 ? "Selected" : "Deselected",
+                         apSelector.viewSize());
+                tui.printStatus(msg);
+            }
+            return true;
+            
+        case JobType::EXPORT:
+            exportTable(job.arg);
+            return true;
+            
+        case JobType::CHANNEL:
+            {
+                wifiAttacks.setChannel(job.channels[0]);
+                char msg[32];
+                snprintf(msg, sizeof(msg), "Channel set to %d", job.channels[0]);
+                tui.printStatus(msg);
+            }
+            return true;
+            
+        case JobType::ADD_SSID:
+            {
+                wifiAttacks.addSSID(job.arg);
+                char msg[48];
+                snprintf(msg, sizeof(msg), "Added SSID: %s", job.arg);
+                tui.printStatus(msg);
+            }
+            return true;
+            
+        default:
+            return true;
+    }
+}
+
+// ============================================
+// Output
+// ============================================
+
+void CommandShell::exportTable(const char* what) {
+    char buf[RESULT_TEXT_LEN];
+    
+    if (strcmp(what, "ssid") == 0) {
+        auto* ssids = wifiAttacks.getSSIDs();
+        tui.printStatus("ssid,selected");
+        for (int i = 0; i < ssids->size(); i++) {
+            SSID s = ssids->get(i);
+            snprintf(buf, sizeof(buf), "%s,%d", s.name.c_str(), s.selected);
+            tui.printResult(buf);
+        }
+        return;
+    }
+    
+    bool aps = strcmp(what, "ap") == 0;
+    tui.printStatus(aps ? "bssid,channel,rssi,selected,essid"
+                        : "mac,bssid,channel,rssi,selected");
+                        
+    wifiAttacks.lockTables(portMAX_DELAY);
+    int n = aps ? wifiAttacks.getAPs()->size() : wifiAttacks.getStations()->size();
+    wifiAttacks.unlockTables();
+    
+    for (int i = 0; i < n; i++) {
+        // Copy out under the lock, print outside it
+        wifiAttacks.lockTables(portMAX_DELAY);
+        if (aps) {
+            AccessPoint ap = wifiAttacks.getAPs()->get(i);
+            wifiAttacks.unlockTables();
+            const uint8_t* b = ap.bssid;
+            snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X,%u,%d,%d,%s",
+                     b[0], b[1], b[2], b[3], b[4], b[5], ap.channel, ap.rssi, ap.selected, ap.essid);
+            ResultMeta meta(ap.rssi, ap.channel, ap.bssid);
+            tui.printResult(buf, ResultKind::AP, 0, &meta);
+        } else {
+            Station s = wifiAttacks.getStations()->get(i);
+            wifiAttacks.unlockTables();
+            const uint8_t* m = s.mac;
+            const uint8_t* b = s.bssid;
+            snprintf(buf, sizeof(buf), "%02X:%02X:%02X:%02X:%02X:%02X,%02X:%02X:%02X:%02X:%02X:%02X,%u,%d,%d",
+                     m[0], m[1], m[2], m[3], m[4], m[5], b[0], b[1], b[2], b[3], b[4], b[5],
+                     s.channel, s.rssi, s.selected);
+            ResultMeta meta(s.rssi, s.channel, s.mac);
+            tui.printResult(buf, ResultKind::STATION, 0, &meta);
+        }
+    }
+}
+
+bool CommandShell::setOutput(const char* name) {
+    for (uint8_t m = 0; m < (uint8_t)OutputMode::COUNT; m++) {
+        // Prefix match, so "bin" selects binary
+        const char* full = EventStream::modeName((OutputMode)m);
+        if (name[0] && strncasecmp(full, name, strlen(name)) == 0) {
+            eventStream.setMode((OutputMode)m);
+            char msg[32];
+            snprintf(msg, sizeof(msg), "Output: %s", full);
+            tui.printStatus(msg);
+            return true;
+        }
+    }
+    tui.printError("Output: text, json or bin");
+    return false;
+}
+
+bool CommandShell::setConsole(const char* name) {
+    for (uint8_t k = 0; k < (uint8_t)TransportKind::COUNT; k++) {
+        TransportKind kind = (TransportKind)k;
+        if (strcasecmp(name, Console::kindName(kind)) != 0) continue;
+        if (!Console::supports(kind)) break;
+        
+        // Announced on the old link; the new one must see a key to stick
+        char msg[48];
+        snprintf(msg, sizeof(msg), "Console: %s, press a key there within %lus",
+                 Console::kindName(kind), (unsigned long)(CONSOLE_CONFIRM_MS / 1000));
+        tui.printStatus(msg);
+        if (kind == TransportKind::BLE_NUS) {
+            snprintf(msg, sizeof(msg), "BLE console: pair with passkey %06lu",
+                     (unsigned long)BleNusTransport::passkey());
+            tui.printStatus(msg);
+        }
+        if (console.use(kind)) return true;
+        break;
+    }
+    tui.printError("Console: uart, usb (native USB boards) or ble");
+    return false;
+}
+
+bool CommandShell::setBaud(const char* arg) {
+    uint32_t baud = strtoul(arg, nullptr, 10);
+    if (console.kind() != TransportKind::UART) {
+        tui.printError("Baud: only the UART console has a rate");
+        return false;
+    }
+    if (!UartTransport::validBaud(baud)) {
+        tui.printError("Baud: 9600..2000000 (standard rates)");
+        return false;
+    }
+    
+    char msg[48];
+    snprintf(msg, sizeof(msg), "Baud %lu: reconnect, press a key within %lus",
+             (unsigned long)baud, (unsigned long)(CONSOLE_CONFIRM_MS / 1000));
+    tui.printStatus(msg);
+    return console.setBaud(baud);
+}
+
+bool CommandShell::runSession(const char* what) {
+    char msg[56];
+    bool ok;
+    if (strcasecmp(what, "save") == 0) {
+        ok = session.save();
+    } else if (strcasecmp(what, "load") == 0) {
+        ok = session.restore();
+    } else if (strcasecmp(what, "clear") == 0) {
+        ok = session.clear();
+        if (ok) tui.printStatus("Session: saved snapshot deleted");
+        else tui.printError("Session: delete failed");
+        return ok;
+    } else {
+        tui.printError("Session: save, load or clear");
+        return false;
+    }
+    
+    if (!ok) {
+        tui.printError(session.mounted() ? "Session: no valid snapshot / flash error"
+                                         : "Session: storage unavailable");
+        return false;
+    }
+    snprintf(msg, sizeof(msg), "Session %s: %u APs, %u STAs, %u SSIDs (%lu ms)", what,
+             session.lastApCount(), session.lastStaCount(), session.lastSsidCount(),
+             (unsigned long)session.lastMs());
+    tui.printStatus(msg);
+    return true;
+}
+
+// Ratio and CPU cost per block of one compressor, a result line each
+static void printCompressorStats(const char* name, const Compressor& z) {
+    char msg[RESULT_TEXT_LEN];
+    snprintf(msg, sizeof(msg), "%s: %lu -> %lu bytes (%u%%)",
+             name, (unsigned long)z.rawBytes(), (unsigned long)z.packedBytes(), z.percent());
+    tui.printResult(msg);
+    snprintf(msg, sizeof(msg), "%s: %lu blocks, %lu/%lu us avg/max per block",
+             name, (unsigned long)z.blocks(), (unsigned long)z.avgMicros(), (unsigned long)z.maxMicros());
+    tui.printResult(msg);
+}
+
+bool CommandShell::runCompress(const char* what) {
+    if (strcasecmp(what, "on") == 0 || strcasecmp(what, "off") == 0) {
+        bool on = strcasecmp(what, "on") == 0;
+        if (on && !eventStream.compressed()) streamCompressor.resetStats();
+        eventStream.setCompressed(on);
+        tui.printStatus(on ? "Stream: LZSS blocks (decode_events.py unpacks them)"
+                           : "Stream: uncompressed");
+        return true;
+    }
+    if (strcasecmp(what, "stats") == 0) {
+        tui.printStatus(eventStream.compressed() ? "Compression: stream on" : "Compression: stream off");
+        printCompressorStats("Stream", streamCompressor);
+        printCompressorStats("Log", captureLog.compressor());
+        return true;
+    }
+    tui.printError("Compress: on, off or stats");
+    return false;
+}
+
+bool CommandShell::runLog(const char* what) {
+    char msg[64];
+    if (!captureLog.available()) {
+        tui.printError("Log: storage unavailable");
+        return false;
+    }
+    
+    if (strcasecmp(what, "start") == 0) {
+        if (!captureLog.start()) {
+            tui.printError("Log: cannot open segment");
+            return false;
+        }
+        tui.printStatus("Log: recording events");
+    } else if (strcasecmp(what, "stop") == 0) {
+        captureLog.stop();
+        tui.printStatus("Log: stopped");
+    } else if (strcasecmp(what, "clear") == 0) {
+        captureLog.clear();
+        tui.printStatus("Log: cleared");
+    } else if (strcasecmp(what, "dump") == 0) {
+        // Raw binary records follow; decode with tools/decode_events.py
+        snprintf(msg, sizeof(msg), "Log: dumping %lu bytes, any key stops",
+                 (unsigned long)captureLog.storedBytes());
+        tui.printStatus(msg);
+        size_t n = captureLog.dump(console);
+        console.println();
+        snprintf(msg, sizeof(msg), "Log: %lu bytes sent", (unsigned long)n);
+        tui.printStatus(msg);
+    } else if (strcasecmp(what, "status") == 0) {
+        snprintf(msg, sizeof(msg), "Log: %s, %lu bytes in %u segments, %lu dropped",
+                 captureLog.recording() ? "recording" : "stopped",
+                 (unsigned long)captureLog.storedBytes(), captureLog.segmentCount(),
+                 (unsigned long)captureLog.drops());
+        tui.printStatus(msg);
+    } else {
+        tui.printError("Log: start, stop, dump, clear or status");
+        return false;
+    }
+    return true;
+}
+
+bool CommandShell::setBtProfile(const char* name) {
+    char msg[64];
+    char desc[48];
+    if (*name != '\0') {
+        uint8_t p = 0;
+        while (p < (uint8_t)BTScanProfile::COUNT &&
+               strcasecmp(name, BTAttacks::profileName((BTScanProfile)p)) != 0) p++;
+        if (p == (uint8_t)BTScanProfile::COUNT) {
+            tui.printError("BT profile: survey, active, background or tracker");
+            return false;
+        }
+        btAttacks.setProfile((BTScanProfile)p);
+    }
+    BTAttacks::describeProfile(btAttacks.profile(), desc, sizeof(desc));
+    snprintf(msg, sizeof(msg), "BT profile %s", desc);
+    tui.printStatus(msg);
+    return true;
+}
+
+bool CommandShell::runMacs(const char* what) {
+    char msg[80];
+    if (strcasecmp(what, "clear") == 0) {
+        macHistory.clear();
+        tui.printStatus("MAC history cleared");
+        return true;
+    }
+    if (*what != '\0' && strcasecmp(what, "status") != 0) {
+        tui.printError("Macs: status or clear");
+        return false;
+    }
+    uint16_t bp = macHistory.falsePositiveBp();
+    snprintf(msg, sizeof(msg), "MACs: %lu distinct, %u/%u this generation, %lu rotations",
+             (unsigned long)macHistory.distinct(), macHistory.current(), MAC_HISTORY_LEN,
+             (unsigned long)macHistory.rotations());
+    tui.printStatus(msg);
+    snprintf(msg, sizeof(msg), "False positives now %u.%02u%%, %u bytes",
+             bp / 100, bp % 100, (unsigned)(2 * MacFilter::BITS / 8));
+    tui.printResult(msg);
+    return true;
+}
+
+bool CommandShell::runSig(const char* what) {
+    char msg[64];
+    if (strncasecmp(what, "add ", 4) == 0) {
+        if (!signatures.add(skipSpaces(what + 4))) {
+            tui.printError("Sig: add name|mfr|svc <pattern> <class>");
+            return false;
+        }
+        if (!signatures.compile()) {
+            tui.printError("Sig: matcher full, signature dropped");
+            return false;
+        }
+    } else if (strcasecmp(what, "list") == 0) {
+        for (uint16_t i = 0; i < signatures.count(); i++) {
+            signatures.describe(i, msg, sizeof(msg));
+            tui.printResult(msg);
+        }
+        return true;
+    } else if (strcasecmp(what, "reset") == 0) {
+        signatures.reset();
+    } else if (strcasecmp(what, "save") == 0 || strcasecmp(what, "load") == 0) {
+        bool save = strcasecmp(what, "save") == 0;
+        if (!save) signatures.reset();
+        if (!(save ? signatures.save() : signatures.load())) {
+            tui.printError(save ? "Sig: save failed" : "Sig: no saved signatures");
+            return false;
+        }
+    } else if (*what != '\0' && strcasecmp(what, "status") != 0) {
+        tui.printError("Sig: status, list, add, reset, save or load");
+        return false;
+    }
+    snprintf(msg, sizeof(msg), "Signatures: %u (%u built in), %u/%u nodes, %lu hits",
+             signatures.count(), signatures.builtins(), signatures.nodes(), SIG_MAX_NODES,
+             (unsigned long)signatures.hits());
+    tui.printStatus(msg);
+    return true;
+}
+
+bool CommandShell::runTracker(char* args) {
+    args = (char*)skipSpaces(args);
+    if (*args == '\0' || strcasecmp(args, "status") == 0) {
+        trackerWatch.printStatus();
+        return true;
+    }
+    if (strcasecmp(args, "moved") == 0) {
+        trackerWatch.moved();
+        tui.printStatus("Tracker watch: new place");
+        return true;
+    }
+    if (strcasecmp(args, "clear") == 0) {
+        trackerWatch.clear();
+        tui.printStatus("Tracker watch cleared");
+        return true;
+    }
+    
+    char* save = nullptr;
+    for (char* tok = strtok_r(args, " ", &save); tok; tok = strtok_r(nullptr, " ", &save)) {
+        char* end = nullptr;
+        if (strncasecmp(tok, "follow=", 7) == 0) {
+            unsigned long minutes = strtoul(tok + 7, &end, 10);
+            if (end == tok + 7 || *end != '\0' || minutes < 1 || minutes > 1440) {
+                tui.printError("Tracker: follow=1..1440 (minutes)");
+                return false;
+            }
+            trackerWatch.setFollowMs(minutes * 60000);
+        } else if (strncasecmp(tok, "places=", 7) == 0) {
+            unsigned long places = strtoul(tok + 7, &end, 10);
+            if (end == tok + 7 || *end != '\0' || places < 1 || places > 20) {
+                tui.printError("Tracker: places=1..20");
+                return false;
+            }
+            trackerWatch.setMinPlaces(places);
+        } else {
+            tui.printError("Tracker: status, moved, clear, follow=MIN, places=N");
+            return false;
+        }
+    }
+    
+    char msg[64];
+    snprintf(msg, sizeof(msg), "Tracker alert: %lu min over %u places",
+             (unsigned long)(trackerWatch.followMs() / 60000), trackerWatch.minPlaces());
+    tui.printStatus(msg);
+    return true;
+}
+
+bool CommandShell::runTrigger(char* args) {
+    char msg[64];
+    args = (char*)skipSpaces(args);
+    
+    if (*args == '\0' || strcasecmp(args, "status") == 0) {
+        if (!frameTrigger.active()) {
+            snprintf(msg, sizeof(msg), "Trigger: off, %lu captures", (unsigned long)frameTrigger.shots());
+        } else {
+            snprintf(msg, sizeof(msg), "Trigger: %s, %s", FrameTrigger::kindName(frameTrigger.kind()),
+                     frameTrigger.fired() ? "capturing" : "armed");
+        }
+        tui.printStatus(msg);
+        const BeaconDedup& dedup = frameTrigger.dedup();
+        snprintf(msg, sizeof(msg), "Beacons: %lu full, %lu as deltas",
+                 (unsigned long)dedup.fulls(), (unsigned long)dedup.deltas());
+        tui.printResult(msg);
+        return true;
+    }
+    if (strcasecmp(args, "off") == 0) {
+        frameTrigger.disarm();
+        tui.printStatus("Trigger: off");
+        return true;
+    }
+    
+    TriggerKind kind = TriggerKind::NONE;
+    uint8_t mac[6];
+    bool haveMac = false;
+    bool rearm = false;
+    uint32_t preMs = TRIGGER_PRE_MS;
+    uint32_t postMs = TRIGGER_POST_MS;
+    
+    char* save = nullptr;
+    for (char* tok = strtok_r(args, " ", &save); tok; tok = strtok_r(nullptr, " ", &save)) {
+        char* end = nullptr;
+        bool ok = true;
+        if (kind == TriggerKind::NONE) {
+            for (uint8_t k = 1; k < (uint8_t)TriggerKind::COUNT; k++) {
+                if (strcasecmp(tok, FrameTrigger::kindName((TriggerKind)k)) == 0) kind = (TriggerKind)k;
+            }
+            ok = kind != TriggerKind::NONE;
+        } else if (strncasecmp(tok, "pre=", 4) == 0 || strncasecmp(tok, "post=", 5) == 0) {
+            bool pre = tolower(tok[1]) == 'r';
+            long secs = strtol(strchr(tok, '=') + 1, &end, 10);
+            ok = *end == '\0' && secs >= 0 && secs <= 60;
+            (pre ? preMs : postMs) = secs * 1000UL;
+        } else if (strcasecmp(tok, "rearm") == 0) {
+            rearm = true;
+        } else {
+            ok = !haveMac && parseMac(tok, mac);
+            haveMac = ok;
+        }
+        
+        if (!ok) {
+            snprintf(msg, sizeof(msg), "Bad trigger option: %.32s", tok);
+            tui.printError(msg);
+            return false;
+        }
+    }
+    
+    if (!frameTrigger.arm(kind, haveMac ? mac : nullptr, preMs, postMs, rearm)) {
+        tui.printError("Trigger: deauth|eapol|roll [MAC], bssid MAC");
+        return false;
+    }
+    if (kind == TriggerKind::ROLL) {
+        snprintf(msg, sizeof(msg), "Capture rolling: every %sframe", haveMac ? "matching " : "");
+    } else {
+        snprintf(msg, sizeof(msg), "Trigger armed: %s, %lus before, %lus after%s",
+                 FrameTrigger::kindName(kind), (unsigned long)(preMs / 1000),
+                 (unsigned long)(postMs / 1000), rearm ? ", rearm" : "");
+    }
+    tui.printStatus(msg);
+    
+    // Frames are committed as stream records; text mode has nowhere to put them
+    if (!eventStream.structured() && !captureLog.recording()) {
+        tui.printStatus("Trigger: frames need ':output bin|json' or ':log start'");
+    }
+    return true;
+}
+
+void CommandShell::listJobs() {
+    char buf[48];
+    if (_running) {
+        snprintf(buf, sizeof(buf), "Running: %s", _current.label);
+        tui.printStatus(buf);
+    }
+    snprintf(buf, sizeof(buf), "%u job(s) queued", _count);
+    tui.printStatus(buf);
+    for (uint8_t i = 0; i < _count; i++) {
+        const Job& job = _jobs[(_head + i) % JOB_QUEUE_LEN];
+        snprintf(buf, sizeof(buf), "%u: %s", i + 1, job.label);
+        tui.printResult(buf);
+    }
+}
+
+void CommandShell::printHelp() {
+    tui.printStatus("Commands (';' chains, dur=S, ch=1,6,11):");
+    tui.printResult("scan ap|sta, live, sniff <type>");
+    tui.printResult("survey [wifi=MS ble=MS] (WiFi + BLE)");
+    tui.printResult("attack deauth|beacon|list|rickroll|funny");
+    tui.printResult("bt scan [airtag|flipper|skimmer]");
+    tui.printResult("bt spam apple|windows|samsung|google|all");
+    tui.printResult("bt profile survey|active|background|tracker");
+    tui.printResult("list|export ap|sta|ssid");
+    tui.printResult("select all|none|<filter>, ssid add <name>");
+    tui.printResult("channel N, wait S, jobs, cancel");
+    tui.printResult("output text|json|bin, compress on|off|stats");
+    tui.printResult("console uart|usb|ble, baud N");
+    tui.printResult("session save|load|clear");
+    tui.printResult("log start|stop|dump|clear|status, macs [clear]");
+    tui.printResult("tracker [moved|clear|follow=MIN places=N]");
+    tui.printResult("sig [list|add <f> <pat> <cls>|reset|save|load]");
+    tui.printResult("trigger deauth|eapol|bssid [MAC] [pre=S post=S rearm]");
+    tui.printResult("trigger roll [MAC] | off | status");
+}
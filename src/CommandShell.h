@@ -0,0 +1,109 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include "MenuDefs.h"
+
+// ============================================
+// Command Shell
+// Line commands queued as timed jobs
+// ============================================
+//
+// A line typed after ':' (or sent by a script) is split on ';' into
+// commands, and each command becomes a job. Jobs run back to back: a job
+// with dur=N is stopped after N seconds, one without runs until it ends
+// by itself or is stopped. Runs are dispatched through the same
+// handleAction() path as the menu. A keypress that stops a run also drops
+// the rest of the queue.
+//
+// Some commands (output, console, session, trigger, tracker, sig...) act
+// at once instead of queuing a job. A line runs nothing unless all its
+// job commands parse. A bad argument to an immediate command is only
+// found when it runs: the commands before it have then taken effect, but
+// the jobs of the line are dropped.
+//
+//   scan ap | scan sta | live | survey
+//   sniff beacon|probe|deauth|pmkid|pwn|raw
+//   attack deauth|beacon|list|rickroll|funny
+//   bt scan [airtag|flipper|skimmer] | bt spam apple|windows|samsung|google|all
+//   bt profile [survey|active|background|tracker]
+//   list ap|sta|ssid | export ap|sta|ssid
+//   select all|none|<filter> | ssid add <name> | channel N | wait N
+//   jobs | cancel | output text|json|bin | compress on|off|stats
+//   console uart|usb|ble | baud N
+//   session save|load|clear | log start|stop|dump|clear|status
+//   macs [status|clear]
+//   tracker [moved|clear|follow=MIN places=N]
+//   sig [list|add <f> <pat> <cls>|reset|save|load]
+//   trigger deauth|eapol|bssid [MAC] [pre=S] [post=S] [rearm]
+//   trigger roll [MAC] | trigger off|status | help
+//
+// Options on runs: dur=SECONDS, ch=1,6,11 (sniff channel plan),
+// wifi=MS ble=MS (survey slices)
+
+enum class JobType : uint8_t {
+    RUN,        // Menu action, optionally time-limited
+    WAIT,       // Idle for durationMs
+    SELECT,     // Select APs by filter (arg), "all" or "none"
+    EXPORT,     // Dump a target table as CSV lines
+    CHANNEL,    // Set the WiFi channel
+    ADD_SSID    // Add arg to the beacon SSID list
+};
+
+struct Job {
+    JobType type;
+    MenuAction action;
+    uint32_t durationMs;            // 0 = until the run ends by itself
+    uint8_t channels[MAX_CHANNEL];
+    uint8_t channelCount;           // 0 = hop all channels
+    uint16_t sliceMs[2];            // Survey WiFi / BLE slices, 0 = default
+    char arg[33];
+    char label[32];                 // Command as typed, for "jobs"
+};
+
+class CommandShell {
+public:
+    // Parse and queue a command line; errors are reported on the TUI
+    bool submit(const char* line);
+    
+    // Main loop: next action to dispatch via handleAction(), or NONE
+    MenuAction update();
+    uint32_t nextWakeMs() const;
+    
+    // Drop queued jobs (the user stopped the run by hand)
+    void cancel();
+    bool isBusy() const { return _running || _count > 0; }
+    
+private:
+    Job _jobs[JOB_QUEUE_LEN];
+    uint8_t _head = 0;
+    uint8_t _count = 0;
+    
+    Job _current;
+    bool _running = false;
+    uint32_t _startTime = 0;
+    
+    bool immediate(char* cmd, bool run, bool& ok);
+    bool parse(char* cmd, Job& job);
+    bool parseOptions(char* opts, Job& job);
+    bool enqueue(const Job& job);
+    bool canStart() const;
+    bool runInline(const Job& job);
+    void exportTable(const char* what);
+    bool setOutput(const char* name);
+    bool setConsole(const char* name);
+    bool setBaud(const char* arg);
+    bool runSession(const char* what);
+    bool runLog(const char* what);
+    bool runCompress(const char* what);
+    bool setBtProfile(const char* name);
+    bool runMacs(const char* what);
+    bool runTracker(char* args);
+    bool runSig(const char* what);
+    bool runTrigger(char* args);
+    void listJobs();
+    void printHelp();
+};
+
+// Global instance
+extern CommandShell shell;
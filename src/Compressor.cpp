@@ -0,0 +1,130 @@
+/**
+ * ESP32 Marauder TUI - Compressor
+ *
+ * Greedy parse with short hash chains: at console rates a block is
+ * compressed in well under a millisecond, which matters more here than
+ * the last few percent an optimal parse would find.
+ */
+
+#include "Compressor.h"
+#include "EventStream.h"
+
+Compressor streamCompressor;
+
+static const uint8_t SYNC_0 = 0xA5;
+static const uint8_t SYNC_1 = 0x5C;
+static const uint8_t FLAG_STORED = 0x01;
+
+static const size_t HEADER = 7;         // sync, flags, rawLen, dataLen
+static const size_t MIN_MATCH = 3;
+static const size_t MAX_MATCH = 66;
+static const size_t WINDOW = 1024;
+static const uint8_t CHAIN_DEPTH = 8;   // Candidates tried per position
+
+static inline uint8_t hash3(const uint8_t* p) {
+    return (p[0] * 33 + p[1]) * 33 + p[2];
+}
+
+// LZSS body into out; 0 if it would not come out smaller than limit
+size_t Compressor::pack(const uint8_t* in, size_t n, uint8_t* out, size_t limit) {
+    for (size_t h = 0; h < HASH_SIZE; h++) _head[h] = NONE;
+    
+    size_t pos = 0;
+    size_t flagPos = 0;
+    uint8_t bit = 8;
+    size_t i = 0;
+    while (i < n) {
+        // Worst next step: a flag byte and a token
+        if (pos + 3 > limit) return 0;
+        if (bit == 8) {
+            flagPos = pos++;
+            out[flagPos] = 0;
+            bit = 0;
+        }
+        
+        size_t bestLen = 0;
+        size_t bestOff = 0;
+        if (i + MIN_MATCH <= n) {
+            size_t maxLen = min(MAX_MATCH, n - i);
+            uint16_t cand = _head[hash3(in + i)];
+            for (uint8_t depth = 0; cand != NONE && depth < CHAIN_DEPTH; depth++) {
+                size_t off = i - cand;
+                if (off > WINDOW) break;
+                size_t len = 0;
+                while (len < maxLen && in[cand + len] == in[i + len]) len++;
+                if (len > bestLen) {
+                    bestLen = len;
+                    bestOff = off;
+                    if (len == maxLen) break;
+                }
+                cand = _prev[cand];
+            }
+        }
+        
+        size_t step = 1;
+        if (bestLen >= MIN_MATCH) {
+            uint16_t token = ((bestOff - 1) << 6) | (bestLen - MIN_MATCH);
+            out[pos++] = token & 0xFF;
+            out[pos++] = token >> 8;
+            step = bestLen;
+        } else {
+            out[flagPos] |= 1 << bit;
+            out[pos++] = in[i];
+        }
+        bit++;
+        
+        // Index every position covered, so later matches can start inside
+        for (size_t end = i + step; i < end; i++) {
+            if (i + MIN_MATCH > n) continue;
+            uint8_t h = hash3(in + i);
+            _prev[i] = _head[h];
+            _head[h] = i;
+        }
+    }
+    return pos < limit ? pos : 0;
+}
+
+size_t Compressor::compress(const uint8_t* in, size_t n, uint8_t* out, size_t cap) {
+    if (n == 0 || n > BLOCK_MAX || cap < maxFrame(n)) return 0;
+    uint32_t start = micros();
+    
+    uint8_t flags = 0;
+    size_t len = pack(in, n, out + HEADER, n);
+    if (len == 0) {
+        flags = FLAG_STORED;
+        memcpy(out + HEADER, in, n);
+        len = n;
+    }
+    
+    out[0] = SYNC_0;
+    out[1] = SYNC_1;
+    out[2] = flags;
+    out[3] = n & 0xFF;
+    out[4] = n >> 8;
+    out[5] = len & 0xFF;
+    out[6] = len >> 8;
+    uint32_t crc = EventStream::crc32(out + 2, HEADER - 2 + len);
+    memcpy(out + HEADER + len, &crc, 4);
+    size_t total = HEADER + len + 4;
+    
+    uint32_t us = micros() - start;
+    _rawBytes += n;
+    _packedBytes += total;
+    _blocks++;
+    _totalUs += us;
+    _maxUs = max(_maxUs, us);
+    return total;
+}
+
+uint8_t Compressor::percent() const {
+    if (_rawBytes == 0) return 100;
+    return (uint8_t)min((uint64_t)255, (uint64_t)_packedBytes * 100 / _rawBytes);
+}
+
+void Compressor::resetStats() {
+    _rawBytes = 0;
+    _packedBytes = 0;
+    _blocks = 0;
+    _totalUs = 0;
+    _maxUs = 0;
+}
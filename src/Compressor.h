@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+
+// ============================================
+// Compressor
+// LZSS blocks for the event stream and capture log
+// ============================================
+//
+// Event and frame records repeat a lot (MACs, SSIDs, TLV headers, beacon
+// bodies), so plain LZSS with a window the size of the block gets most
+// of the gain for a few KB of RAM and no heap.
+//
+// Block:  A5 5C | flags | rawLen u16 | dataLen u16 | data | crc u32
+//         little endian; crc (as EventStream::crc32) covers flags..data.
+//         flags bit 0: data is stored raw (it did not compress).
+//
+// Data is LZSS: a flag byte announces the next eight items, LSB first;
+// bit set = one literal byte, clear = a match token u16 with
+// (offset - 1) << 6 | (length - 3), offset 1..1024, length 3..66.
+// Blocks are independent, and their raw bytes continue one stream
+// (a block may end mid-record). tools/decode_events.py unpacks them.
+
+class Compressor {
+public:
+    static const size_t BLOCK_MAX = 1024;   // Raw bytes per block
+    static const size_t OVERHEAD = 11;      // Block framing
+    // Worst case: a stored block
+    static size_t maxFrame(size_t raw) { return raw + OVERHEAD; }
+    
+    // Frames in[0..n) as one block into out; n <= BLOCK_MAX and
+    // cap >= maxFrame(n). Returns the block length.
+    size_t compress(const uint8_t* in, size_t n, uint8_t* out, size_t cap);
+    
+    // Running totals, for ratio and CPU cost per block
+    uint32_t rawBytes() const { return _rawBytes; }
+    uint32_t packedBytes() const { return _packedBytes; }
+    uint32_t blocks() const { return _blocks; }
+    uint32_t avgMicros() const { return _blocks ? _totalUs / _blocks : 0; }
+    uint32_t maxMicros() const { return _maxUs; }
+    uint8_t percent() const;    // Output as % of input
+    void resetStats();
+    
+private:
+    static const uint16_t NONE = 0xFFFF;
+    static const size_t HASH_SIZE = 256;
+    
+    // Hash chains over the block: newest position per hash, and the
+    // previous position with the same hash
+    uint16_t _head[HASH_SIZE];
+    uint16_t _prev[BLOCK_MAX];
+    
+    uint32_t _rawBytes = 0;
+    uint32_t _packedBytes = 0;
+    uint32_t _blocks = 0;
+    uint32_t _totalUs = 0;
+    uint32_t _maxUs = 0;
+    
+    size_t pack(const uint8_t* in, size_t n, uint8_t* out, size_t limit);
+};
+
+// Console stream instance (the capture log keeps its own)
+extern Compressor streamCompressor;
@@ -24,13 +24,112 @@
 // Serial settings
 #define SERIAL_BAUD 115200
 
+// Console transport (see Transport.h)
+#if ARDUINO_USB_CDC_ON_BOOT
+#define CONSOLE_TRANSPORT TransportKind::USB_CDC   // Serial is native USB on this board
+#else
+#define CONSOLE_TRANSPORT TransportKind::UART
+#endif
+#ifndef CONSOLE_BLE_ATTACH
+#define CONSOLE_BLE_ATTACH 0        // Advertise a BLE UART at boot; a paired central takes the console
+#endif
+// Pairing passkey of the BLE console: random at each boot and shown on the
+// wired console, unless a fixed one is built in with -DCONSOLE_BLE_PASSKEY=N
+#define CONSOLE_BLE_NAME "Marauder-TUI"
+#define CONSOLE_CONFIRM_MS 30000    // A key must arrive over a new link/baud before it sticks
+#define BLE_NUS_TX_BUF 2048         // Output buffered for BLE notifications
+
 // TUI settings
 #define TUI_REFRESH_MS 100
 #define TUI_WIDTH 40
+#define TUI_HEIGHT 24       // Assumed terminal rows before output scrolls
+#define STATUS_BAR_REFRESH_MS 250   // Max repaint rate of the live-run status bar
+#define STATS_EVENT_MS 2000         // STATS stream events during a run, slower than the bar
+#define LIVE_TABLE_ROWS 12          // Top-N rows in the live AP/station view
+#define LIVE_TABLE_REFRESH_MS 500   // Max repaint rate of the live view
+#define RESULT_QUEUE_LEN 32         // Pending results before coalescing kicks in
+#define RESULT_TEXT_LEN 64          // Bytes per formatted result line
+#define RESULT_HISTORY_LEN 64       // Recent results kept for the pager
+#define BLE_HIT_QUEUE_LEN 16        // BLE scan matches awaiting the main loop
+#define BLE_DEVICE_TABLE_LEN 64     // Devices aggregated per BLE scan (least recent replaced)
+#define BLE_RSSI_EWMA_DIV 8         // RSSI average moves 1/N of the way per advert
+#define BLE_SUMMARY_MS 10000        // BLE scan table summary interval
+#define BLE_SUMMARY_TOP 3           // Strongest devices listed per summary
+#define BLE_SCAN_PROFILE BTScanProfile::ACTIVE   // Boot scan profile (:bt profile)
+#define SURVEY_WIFI_SLICE_MS 400    // WiFi + BLE survey: promiscuous capture per cycle
+#define SURVEY_BLE_SLICE_MS 200     // ... then BLE scanning (see RadioSurvey.h)
+#define SURVEY_SUMMARY_MS 10000     // Inventory and radio-sharing summary interval
+#ifndef BT_CLASSIC_SCAN
+#define BT_CLASSIC_SCAN 0           // Skimmer scan adds BR/EDR inquiries (ESP32 only, see ClassicScan.h)
+#endif
+#define CLASSIC_LE_SLICE_MS 15000   // LE scanning between two inquiries
+#define CLASSIC_INQUIRY_LEN 8       // Inquiry length, x 1.28 s
+#define CLASSIC_NAME_QUEUE 8        // Devices per inquiry awaiting a remote name request
+#define CLASSIC_NAME_TIMEOUT_MS 6000    // Longest wait for one remote name
+#define CLASSIC_NAME_RETRY_MS 500   // Wait before asking again when the stack refuses a name request...
+#define CLASSIC_NAME_TRIES 4        // ...and asks before that device is skipped
+#define TRACKER_TABLE_LEN 16        // Trackers followed (see TrackerWatch.h; least recent replaced)
+#define TRACKER_SAMPLES 16          // Sighting windows kept per tracker for :tracker
+#define TRACKER_WINDOW_MS 60000     // Sighting window; moves are detected per window
+#define TRACKER_FOLLOW_MS 600000    // Alert: a tracker around this long (:tracker follow=MIN)...
+#define TRACKER_MIN_PLACES 2        // ... over this many places (:tracker places=N)...
+#define TRACKER_PRESENCE_PCT 50     // ... and heard in this share of its windows
+#define TRACKER_GAP_MS 900000       // Unheard this long: its history starts over
+#define TRACKER_MOVE_PCT 60         // Share of BLE devices new in a window taken as a move
+#define TRACKER_MOVE_MIN 4          // Devices a window needs before a move is judged
+#define SPAM_WINDOW_MS 1000        // BLE spam rates are counted per window (see SpamDetector.h)
+#define SPAM_ADDR_BITS 4096         // Address hash bits per spam shape and generation: under 40% full
+                                    // at 500 new addresses/s over 2 x SPAM_ADDR_WINDOWS s
+#define SPAM_ADDR_WINDOWS 2         // Windows per address generation: addresses are new after 2-4 s
+#define SPAM_MIN_RATE 10            // Flood: this many adverts/s of one shape...
+#define SPAM_FRESH_PCT 50           // ... this share of them from new addresses
+#define SPAM_REPORT_MS 10000        // Flood update interval while it lasts
+#define SPAM_QUIET_WINDOWS 3        // Windows without a flood before it is over
+#define EVENT_QUEUE_LEN 16
+#define JOB_QUEUE_LEN 8             // Queued line-command jobs
+#define COMMAND_LINE_LEN 96         // Longest command line (';' chains commands)
+#define EVENT_STAGE_BUF 4096        // Raw events from radio tasks awaiting encoding
+#define EVENT_STREAM_BUF 4096       // Encoded JSON/binary events awaiting TX
+#define STREAM_COMPRESS 0           // LZSS-compress the stream at boot (:compress)
+#define COMPRESS_FLUSH_MS 250       // Longest a partial block is held back
+
+// Session snapshot on the LittleFS partition (see SessionStore.h)
+#define SESSION_FILE "/session.bin"
+#define SESSION_IDLE_SAVE_MS 5000       // Save this long after the last change
+#define SESSION_CHECKPOINT_MS 60000     // Save interval during long runs
+
+// Capture log segments on the same partition (see CaptureLog.h)
+#define CAPTURE_SEGMENT_SIZE 16384      // Bytes per segment file
+#define CAPTURE_MAX_SEGMENTS 16         // Upper bound; the partition may hold fewer
+#define CAPTURE_STAGE_BUF 4096          // Records awaiting a flash write
+#define CAPTURE_WRITE_CHUNK 1024        // Raw bytes per flash write (max 1024)
+#define CAPTURE_COMPRESS 1              // Store segments as LZSS blocks
+#define CAPTURE_SYNC_MS 2000            // Longest a record waits in RAM
+#define CAPTURE_LOG_AT_BOOT 0           // Start recording at power-on
+
+// Trigger capture (see FrameTrigger.h); RAM = frames x (snaplen + 8)
+#define TRIGGER_RING_FRAMES 64          // Pre/post-trigger frame slots
+#define TRIGGER_SNAPLEN 128             // Bytes kept per frame (max 128)
+#define TRIGGER_PRE_MS 2000             // Default window before the event
+#define TRIGGER_POST_MS 2000            // Default window after it
+#define BEACON_CACHE_LEN 32             // BSSIDs whose last beacon is remembered
+#define BEACON_REFRESH_MS 10000         // Full beacon at least this often per BSSID
+
+// BLE signatures (see SignatureSet.h); RAM ~ 12 x nodes + pool + 8 x count
+#define SIGNATURE_FILE "/signatures.txt"   // Uploaded signatures (:sig save)
+#define SIG_MAX_COUNT 256               // Signatures, built-in ones included
+#define SIG_MAX_NODES 1024              // Matcher states (about one per pattern byte)
+#define SIG_POOL_LEN 2048               // Pattern bytes
+#define SIG_MAX_LEN 32                  // Longest pattern
 
 // Memory constraints (no PSRAM)
 #define MAX_APS 50
 #define MAX_STATIONS 50
 #define MAX_SSIDS 20
-#define MAC_HISTORY_LEN 512
-                                                            
+
+// Station history beyond MAX_STATIONS (see MacFilter.h); RAM = 2 x bits / 8
+#define MAC_HISTORY_LEN 2048            // MACs per filter generation
+#define MAC_FILTER_BITS (MAC_HISTORY_LEN * 10)  // Bits per generation (~0.8% false positives)
+#define MAC_FILTER_HASHES 7             // Bits set per MAC (optimal for 10 bits/MAC)
+#define MAC_FILTER_AGE_MS 300000        // Longest a generation lasts
+
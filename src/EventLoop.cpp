@@ -0,0 +1,68 @@
+/**
+ * ESP32 Marauder TUI - Event Loop
+ *
+ * The main loop blocks on one FreeRTOS queue instead of polling.
+ * Keystrokes, analyzer alerts and stop requests are posted to the queue;
+ * module deadlines (attack cadence, channel hops, status lines) become
+ * the wait timeout, so the CPU idles when nothing is due.
+ */
+
+#include "EventLoop.h"
+
+EventLoop events;
+
+void EventLoop::begin() {
+    if (_queue == nullptr) {
+        _queue = xQueueCreate(EVENT_QUEUE_LEN, sizeof(Event));
+    }
+}
+
+bool EventLoop::post(EventType type) {
+    if (_queue == nullptr) return false;
+    
+    uint8_t idx = (uint8_t)type;
+    if (_pending[idx]) return true;  // Already queued, the loop will see it
+    _pending[idx] = true;
+    
+    Event ev = {type};
+    if (xQueueSend(_queue, &ev, 0) != pdTRUE) {
+        _pending[idx] = false;
+        return false;
+    }
+    return true;
+}
+
+bool EventLoop::postFromISR(EventType type) {
+    if (_queue == nullptr) return false;
+    
+    uint8_t idx = (uint8_t)type;
+    if (_pending[idx]) return true;
+    _pending[idx] = true;
+    
+    Event ev = {type};
+    BaseType_t woken = pdFALSE;
+    if (xQueueSendFromISR(_queue, &ev, &woken) != pdTRUE) {
+        _pending[idx] = false;
+        return false;
+    }
+    portYIELD_FROM_ISR(woken);
+    return true;
+}
+
+Event EventLoop::wait(uint32_t timeoutMs) {
+    Event ev = {EventType::TIMER};
+    if (_queue == nullptr) {
+        delay(timeoutMs == FOREVER ? 10 : min(timeoutMs, (uint32_t)10));
+        return ev;
+    }
+    
+    TickType_t ticks = (timeoutMs == FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+    if (xQueueReceive(_queue, &ev, ticks) == pdTRUE) {
+        // Clear before the caller processes, so anything posted while we
+        // handle this event queues a fresh wake-up
+        _pending[(uint8_t)ev.type] = false;
+    } else {
+        ev.type = EventType::TIMER;
+    }
+    return ev;
+}
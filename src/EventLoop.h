@@ -0,0 +1,53 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+// ============================================
+// Event Loop
+// Single wake-up source for the main loop
+// ============================================
+
+// Event sources that can wake the main loop
+enum class EventType : uint8_t {
+    NONE,
+    UART_RX,    // Bytes waiting on the console link (UART, USB or BLE)
+    TIMER,      // A module deadline expired (synthesised by wait())
+    ALERT,      // Analyzer output from a radio callback
+    STOP,       // Stop request for the running scan/attack
+    COUNT
+};
+
+struct Event {
+    EventType type;
+};
+
+class EventLoop {
+public:
+    static constexpr uint32_t FOREVER = UINT32_MAX;
+    
+    void begin();
+    
+    // Post from task context (radio callbacks, UART event task, main loop).
+    // Repeated posts of a type that is still queued are collapsed.
+    bool post(EventType type);
+    bool postFromISR(EventType type);
+    
+    // Block until an event arrives or timeoutMs elapses (returns TIMER)
+    Event wait(uint32_t timeoutMs);
+    
+private:
+    QueueHandle_t _queue = nullptr;
+    volatile bool _pending[(uint8_t)EventType::COUNT] = {};
+};
+
+// Milliseconds left until `interval` has elapsed since `last` (0 = due now)
+inline uint32_t msUntil(uint32_t last, uint32_t interval, uint32_t now) {
+    uint32_t elapsed = now - last;
+    return elapsed >= interval ? 0 : interval - elapsed;
+}
+
+// Global instance
+extern EventLoop events;
@@ -0,0 +1,322 @@
+/**
+ * ESP32 Marauder TUI - Event Stream
+ *
+ * Producers copy the raw event into the staging ring in one critical
+ * section. The main loop assigns seq, encodes into the byte ring and
+ * drains that by TX space, so the radio tasks never touch the port and
+ * keep only the event itself on their stacks.
+ */
+
+#include "EventStream.h"
+#include "CaptureLog.h"
+#include "EventLoop.h"
+#include <ArduinoJson.h>
+
+EventStream eventStream;
+
+static const char* const MODE_NAMES[] = {"text", "json", "binary"};
+static const char* const TYPE_NAMES[] = {
+    "?", "ap", "station", "probe", "deauth", "eapol", "ble", "stats", "pwnagotchi",
+    "trigger", "frame", "beacon", "tracker", "spam"
+};
+
+static const uint8_t SYNC_0 = 0xA5;
+static const uint8_t SYNC_1 = 0x5A;
+
+void EventStream::setMode(OutputMode mode) {
+    portENTER_CRITICAL(&_mux);
+    _mode = mode;
+    _stageHead = 0;
+    _stageUsed = 0;
+    _head = 0;
+    _used = 0;
+    portEXIT_CRITICAL(&_mux);
+    _blockLen = 0;
+    _blockPos = 0;
+}
+
+const char* EventStream::modeName(OutputMode mode) {
+    return MODE_NAMES[(uint8_t)mode];
+}
+
+// ============================================
+// CRC-32 (IEEE 802.3, reflected; matches zlib.crc32)
+// ============================================
+// Nibble table: 64 bytes of flash instead of 1 KB, fast enough for
+// record-sized inputs.
+
+static const uint32_t CRC_NIBBLE[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint32_t EventStream::crc32(const uint8_t* data, size_t len, uint32_t crc) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ CRC_NIBBLE[crc & 0x0F];
+        crc = (crc >> 4) ^ CRC_NIBBLE[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+// ============================================
+// Encoding
+// ============================================
+
+static void formatMac(char* buf, const uint8_t* m) {
+    snprintf(buf, 18, "%02X:%02X:%02X:%02X:%02X:%02X", m[0], m[1], m[2], m[3], m[4], m[5]);
+}
+
+size_t EventStream::encodeJson(const StreamEvent& ev, uint32_t seq, uint32_t ms,
+                               char* buf, size_t len) {
+    StaticJsonDocument<384> doc;
+    char mac[18], bssid[18], dst[18];
+    
+    doc["t"] = TYPE_NAMES[(uint8_t)ev.type];
+    doc["seq"] = seq;
+    doc["ms"] = ms;
+    if (ev.has(StreamField::MAC)) { formatMac(mac, ev.mac); doc["mac"] = (const char*)mac; }
+    if (ev.has(StreamField::BSSID)) { formatMac(bssid, ev.bssid); doc["bssid"] = (const char*)bssid; }
+    if (ev.has(StreamField::DST)) { formatMac(dst, ev.dst); doc["dst"] = (const char*)dst; }
+    if (ev.has(StreamField::RSSI)) doc["rssi"] = ev.rssi;
+    if (ev.has(StreamField::CHANNEL)) doc["ch"] = ev.channel;
+    if (ev.has(StreamField::SSID)) doc["ssid"] = (const char*)ev.ssid;
+    if (ev.has(StreamField::REASON)) doc["reason"] = ev.reason;
+    if (ev.has(StreamField::COUNT)) doc["count"] = ev.count;
+    if (ev.has(StreamField::CLASS)) doc["class"] = ev.cls;
+    if (ev.has(StreamField::DROPS)) doc["drops"] = ev.drops;
+    if (ev.has(StreamField::LENGTH)) doc["len"] = ev.length;
+    if (ev.has(StreamField::TSF)) doc["tsf"] = ev.tsf;
+    if (ev.has(StreamField::SEQCTRL)) doc["seqctl"] = ev.seqCtrl;
+    
+    // const char* values are stored by reference, so the hex stays out of
+    // the document pool
+    char hex[2 * StreamEvent::MAX_FRAME + 1];
+    if (ev.has(StreamField::FRAME)) {
+        static const char DIGITS[] = "0123456789abcdef";
+        for (uint8_t i = 0; i < ev.frameLen; i++) {
+            hex[2 * i] = DIGITS[ev.frame[i] >> 4];
+            hex[2 * i + 1] = DIGITS[ev.frame[i] & 0x0F];
+        }
+        hex[2 * ev.frameLen] = '\0';
+        doc["frame"] = (const char*)hex;
+    }
+    
+    // Room for ,"crc":"xxxxxxxx"}\n (19 bytes) after the closing brace
+    size_t n = serializeJson(doc, buf, len - 20);
+    if (n < 2) return 0;
+    
+    uint32_t crc = crc32((const uint8_t*)buf, n);
+    n--;  // Drop '}' and append the crc member in its place
+    n += snprintf(buf + n, len - n, ",\"crc\":\"%08lx\"}\n", (unsigned long)crc);
+    return n;
+}
+
+static size_t putTlv(uint8_t* buf, size_t pos, size_t len, StreamField tag,
+                     const void* value, uint8_t n) {
+    if (pos + 2 + n > len) return pos;
+    buf[pos++] = (uint8_t)tag;
+    buf[pos++] = n;
+    memcpy(buf + pos, value, n);
+    return pos + n;
+}
+
+size_t EventStream::encodeBinary(const StreamEvent& ev, uint32_t seq, uint32_t ms,
+                                 uint8_t* buf, size_t len) {
+    // Header: sync, type, payload length (patched below), seq, ms
+    size_t pos = 0;
+    buf[pos++] = SYNC_0;
+    buf[pos++] = SYNC_1;
+    buf[pos++] = (uint8_t)ev.type;
+    buf[pos++] = 0;
+    memcpy(buf + pos, &seq, 4);
+    pos += 4;
+    memcpy(buf + pos, &ms, 4);
+    pos += 4;
+    size_t body = pos;
+    
+    size_t cap = len - 4;  // Keep room for the CRC
+    if (ev.has(StreamField::MAC)) pos = putTlv(buf, pos, cap, StreamField::MAC, ev.mac, 6);
+    if (ev.has(StreamField::BSSID)) pos = putTlv(buf, pos, cap, StreamField::BSSID, ev.bssid, 6);
+    if (ev.has(StreamField::DST)) pos = putTlv(buf, pos, cap, StreamField::DST, ev.dst, 6);
+    if (ev.has(StreamField::RSSI)) pos = putTlv(buf, pos, cap, StreamField::RSSI, &ev.rssi, 1);
+    if (ev.has(StreamField::CHANNEL)) pos = putTlv(buf, pos, cap, StreamField::CHANNEL, &ev.channel, 1);
+    if (ev.has(StreamField::SSID)) pos = putTlv(buf, pos, cap, StreamField::SSID, ev.ssid, strlen(ev.ssid));
+    if (ev.has(StreamField::REASON)) pos = putTlv(buf, pos, cap, StreamField::REASON, &ev.reason, 2);
+    if (ev.has(StreamField::COUNT)) pos = putTlv(buf, pos, cap, StreamField::COUNT, &ev.count, 4);
+    if (ev.has(StreamField::CLASS)) pos = putTlv(buf, pos, cap, StreamField::CLASS, &ev.cls, 1);
+    if (ev.has(StreamField::DROPS)) pos = putTlv(buf, pos, cap, StreamField::DROPS, &ev.drops, 4);
+    if (ev.has(StreamField::LENGTH)) pos = putTlv(buf, pos, cap, StreamField::LENGTH, &ev.length, 2);
+    if (ev.has(StreamField::FRAME)) pos = putTlv(buf, pos, cap, StreamField::FRAME, ev.frame, ev.frameLen);
+    if (ev.has(StreamField::TSF)) pos = putTlv(buf, pos, cap, StreamField::TSF, &ev.tsf, 8);
+    if (ev.has(StreamField::SEQCTRL)) pos = putTlv(buf, pos, cap, StreamField::SEQCTRL, &ev.seqCtrl, 2);
+    
+    buf[3] = pos - body;
+    uint32_t crc = crc32(buf + 2, pos - 2);
+    memcpy(buf + pos, &crc, 4);
+    return pos + 4;
+}
+
+// ============================================
+// Ring
+// ============================================
+
+void EventStream::stagePut(const void* data, size_t len) {
+    size_t tail = (_stageHead + _stageUsed) % sizeof(_stage);
+    size_t first = min(len, sizeof(_stage) - tail);
+    memcpy(_stage + tail, data, first);
+    memcpy(_stage, (const uint8_t*)data + first, len - first);
+    _stageUsed += len;
+}
+
+void EventStream::stageGet(void* data, size_t len) {
+    size_t first = min(len, sizeof(_stage) - _stageHead);
+    memcpy(data, _stage + _stageHead, first);
+    memcpy((uint8_t*)data + first, _stage, len - first);
+    _stageHead = (_stageHead + len) % sizeof(_stage);
+    _stageUsed -= len;
+}
+
+void EventStream::emit(const StreamEvent& ev) {
+    if (_mode == OutputMode::TEXT && !captureLog.recording()) return;
+    
+    uint32_t ms = ev.timed ? ev.time : millis();
+    uint8_t frameLen = ev.has(StreamField::FRAME) ? ev.frameLen : 0;
+    size_t n = sizeof(ms) + sizeof(ev) + frameLen;
+    bool wake = false;
+    
+    portENTER_CRITICAL(&_mux);
+    if (_stageUsed + n > sizeof(_stage)) {
+        // Its seq is skipped, so the host still sees the gap
+        _drops++;
+        _seqSkip++;
+    } else {
+        wake = _stageUsed == 0;
+        stagePut(&ms, sizeof(ms));
+        stagePut(&ev, sizeof(ev));
+        if (frameLen) stagePut(ev.frame, frameLen);
+    }
+    portEXIT_CRITICAL(&_mux);
+    
+    if (wake) events.post(EventType::ALERT);
+}
+
+void EventStream::update() {
+    uint32_t ms;
+    StreamEvent ev(StreamType::STATS);
+    uint8_t frame[StreamEvent::MAX_FRAME];
+    uint8_t record[MAX_RECORD];
+    
+    for (;;) {
+        OutputMode mode = _mode;
+        // Whole records only: leave the rest staged until TX catches up
+        if (mode != OutputMode::TEXT && sizeof(_ring) - _used < MAX_RECORD) break;
+        
+        portENTER_CRITICAL(&_mux);
+        if (_stageUsed == 0) {
+            portEXIT_CRITICAL(&_mux);
+            break;
+        }
+        stageGet(&ms, sizeof(ms));
+        stageGet(&ev, sizeof(ev));
+        if (ev.has(StreamField::FRAME)) stageGet(frame, ev.frameLen);
+        _seq += _seqSkip;
+        _seqSkip = 0;
+        uint32_t seq = _seq++;
+        portEXIT_CRITICAL(&_mux);
+        ev.frame = frame;
+        
+        size_t n = 0;
+        if (mode == OutputMode::JSON) {
+            n = encodeJson(ev, seq, ms, (char*)record, sizeof(record));
+        } else if (mode == OutputMode::BINARY) {
+            n = encodeBinary(ev, seq, ms, record, sizeof(record));
+        }
+        if (n > 0) enqueue(record, n);
+        
+        // The capture log stores binary records whatever the output mode
+        if (captureLog.recording()) {
+            if (mode != OutputMode::BINARY) n = encodeBinary(ev, seq, ms, record, sizeof(record));
+            captureLog.append(record, n);
+        }
+    }
+}
+
+void EventStream::enqueue(const uint8_t* record, size_t n) {
+    portENTER_CRITICAL(&_mux);
+    if (_used + n > sizeof(_ring)) {
+        // Whole records only; the host sees the gap in seq
+        _drops++;
+    } else {
+        if (_used == 0) _pendingSince = millis();
+        size_t tail = (_head + _used) % sizeof(_ring);
+        size_t first = min(n, sizeof(_ring) - tail);
+        memcpy(_ring + tail, record, first);
+        memcpy(_ring, record + first, n - first);
+        _used += n;
+    }
+    portEXIT_CRITICAL(&_mux);
+}
+
+// Up to len bytes off the ring, in contiguous pieces
+size_t EventStream::take(uint8_t* out, size_t len) {
+    size_t n = 0;
+    portENTER_CRITICAL(&_mux);
+    while (n < len && _used > 0) {
+        size_t piece = min(min(_used, len - n), sizeof(_ring) - _head);
+        memcpy(out + n, _ring + _head, piece);
+        _head = (_head + piece) % sizeof(_ring);
+        _used -= piece;
+        n += piece;
+    }
+    if (_used > 0) _pendingSince = millis();
+    portEXIT_CRITICAL(&_mux);
+    return n;
+}
+
+void EventStream::drain(Print& out, size_t room) {
+    uint8_t chunk[128];
+    
+    while (room > 0) {
+        // A block already started always goes out whole
+        if (_blockPos < _blockLen) {
+            size_t n = min(room, _blockLen - _blockPos);
+            out.write(_block + _blockPos, n);
+            _blockPos += n;
+            room -= n;
+            continue;
+        }
+        
+        if (_compress) {
+            if (!ready()) break;
+            uint8_t raw[Compressor::BLOCK_MAX];
+            size_t n = take(raw, sizeof(raw));
+            _blockLen = streamCompressor.compress(raw, n, _block, sizeof(_block));
+            _blockPos = 0;
+            continue;
+        }
+        
+        size_t n = take(chunk, min(room, sizeof(chunk)));
+        if (n == 0) break;
+        out.write(chunk, n);
+        room -= n;
+    }
+}
+
+bool EventStream::ready() const {
+    if (_blockPos < _blockLen) return true;
+    if (_used == 0) return false;
+    // Full blocks compress best; a trickle goes out after the flush delay
+    return !_compress || _used >= Compressor::BLOCK_MAX ||
+           millis() - _pendingSince >= COMPRESS_FLUSH_MS;
+}
+
+uint32_t EventStream::nextWakeMs() const {
+    // Staged events held back by a full ring: TX has caught up
+    if (_stageUsed > 0 && (_mode == OutputMode::TEXT || sizeof(_ring) - _used >= MAX_RECORD)) return 0;
+    if (_used == 0 || ready()) return EventLoop::FOREVER;
+    return msUntil(_pendingSince, COMPRESS_FLUSH_MS, millis());
+}
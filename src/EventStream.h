@@ -0,0 +1,203 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include "Compressor.h"
+#include <freertos/FreeRTOS.h>
+
+// ============================================
+// Event Stream
+// Machine-readable capture output for host tools
+// ============================================
+//
+// In JSON or BINARY mode, analyzers emit typed events instead of the
+// coloured "[+]" result lines. Each event carries a sequence number (gaps
+// = dropped events) and a CRC-32 (IEEE, same as zlib.crc32) so a host can
+// resynchronise and validate at full rate. Menus still render as text;
+// decoders skip anything that is not a valid record.
+//
+// JSON line:  {"t":"ap","seq":7,"ms":1234,...,"crc":"89abcdef"}
+//             crc covers the line with the crc member removed, i.e. the
+//             text up to ,"crc" followed by a closing brace.
+//
+// Binary:     A5 5A | type | len | seq u32 | ms u32 | TLVs[len] | crc u32
+//             little endian; crc covers type..TLVs; TLV = tag, len, value
+//
+// Radio tasks only copy the raw StreamEvent (and its frame bytes) into a
+// staging ring; the main loop numbers, encodes and queues them, so seq
+// follows record order and no encoder runs on a stack we do not own.
+//
+// With compression on, the drained bytes go out as LZSS blocks instead
+// (see Compressor.h), each holding up to a block of the byte stream
+// above. A partial block waits up to COMPRESS_FLUSH_MS for more records.
+//
+// tools/decode_events.py decodes all of these.
+
+enum class OutputMode : uint8_t {
+    TEXT,       // Human-readable results (default)
+    JSON,       // JSON lines
+    BINARY,     // Framed TLV records
+    COUNT
+};
+
+enum class StreamType : uint8_t {
+    AP = 1,
+    STATION,
+    PROBE,
+    DEAUTH,
+    EAPOL,
+    BLE,
+    STATS,
+    PWNAGOTCHI,
+    TRIGGER,    // Trigger fired; FRAME records around it follow
+    FRAME,      // Raw 802.11 frame (ms = capture time)
+    BEACON,     // Repeat of the last beacon FRAME of a BSSID (BeaconDedup.h)
+    TRACKER,    // BLE tracker following (TrackerWatch.h); count = windows heard
+    SPAM        // BLE spam flood (SpamDetector.h); count = adverts/s, 0 when over
+};
+
+// TLV tags; the matching bit in StreamEvent::fields says a field is set
+enum class StreamField : uint8_t {
+    MAC = 1,    // Transmitter / station / BLE address
+    BSSID,
+    DST,        // Receiver (deauth, EAPOL)
+    RSSI,       // int8
+    CHANNEL,    // uint8
+    SSID,       // String: SSID, probed SSID or BLE name
+    REASON,     // uint16 deauth reason
+    COUNT,      // uint32 packets (stats)
+    CLASS,      // uint8 BLE class (BLEClass in BLEAdvert.h);
+                // trigger kind (see FrameTrigger.h)
+    DROPS,      // uint32 events dropped by the stream (stats)
+    FRAME,      // Bytes: the frame, without FCS, cut to MAX_FRAME
+    LENGTH,     // uint16 frame length before the cut
+    TSF,        // uint64 beacon timestamp
+    SEQCTRL     // uint16 802.11 sequence control
+};
+
+struct StreamEvent {
+    StreamType type;
+    uint16_t fields = 0;
+    uint8_t mac[6];
+    uint8_t bssid[6];
+    uint8_t dst[6];
+    int8_t rssi;
+    uint8_t channel;
+    uint8_t cls;
+    uint16_t reason;
+    uint32_t count;
+    uint32_t drops;
+    uint16_t length;
+    uint16_t seqCtrl;
+    uint64_t tsf;
+    const uint8_t* frame;       // Not copied: emit() before it goes away
+    uint8_t frameLen;
+    bool timed = false;
+    uint32_t time;
+    char ssid[33];
+    
+    // Raw bytes a FRAME record carries (JSON doubles them as hex)
+    static const uint8_t MAX_FRAME = 128;
+    
+    explicit StreamEvent(StreamType t) : type(t) {}
+    
+    // Timestamp other than "now" (frames replayed from a buffer)
+    StreamEvent& at(uint32_t ms) { time = ms; timed = true; return *this; }
+    
+    StreamEvent& setMac(const uint8_t* m) { memcpy(mac, m, 6); return mark(StreamField::MAC); }
+    StreamEvent& setBssid(const uint8_t* b) { memcpy(bssid, b, 6); return mark(StreamField::BSSID); }
+    StreamEvent& setDst(const uint8_t* d) { memcpy(dst, d, 6); return mark(StreamField::DST); }
+    StreamEvent& setRssi(int8_t r) { rssi = r; return mark(StreamField::RSSI); }
+    StreamEvent& setChannel(uint8_t c) { channel = c; return mark(StreamField::CHANNEL); }
+    StreamEvent& setReason(uint16_t r) { reason = r; return mark(StreamField::REASON); }
+    StreamEvent& setCount(uint32_t c) { count = c; return mark(StreamField::COUNT); }
+    StreamEvent& setClass(uint8_t c) { cls = c; return mark(StreamField::CLASS); }
+    StreamEvent& setDrops(uint32_t d) { drops = d; return mark(StreamField::DROPS); }
+    StreamEvent& setLength(uint16_t n) { length = n; return mark(StreamField::LENGTH); }
+    StreamEvent& setTsf(uint64_t t) { tsf = t; return mark(StreamField::TSF); }
+    StreamEvent& setSeqCtrl(uint16_t s) { seqCtrl = s; return mark(StreamField::SEQCTRL); }
+    StreamEvent& setFrame(const uint8_t* f, size_t n) {
+        frame = f;
+        frameLen = min(n, (size_t)MAX_FRAME);
+        return mark(StreamField::FRAME);
+    }
+    StreamEvent& setSsid(const char* s) {
+        strncpy(ssid, s, sizeof(ssid) - 1);
+        ssid[sizeof(ssid) - 1] = '\0';
+        return mark(StreamField::SSID);
+    }
+    bool has(StreamField f) const { return fields & (1 << (uint8_t)f); }
+    
+private:
+    StreamEvent& mark(StreamField f) { fields |= 1 << (uint8_t)f; return *this; }
+};
+
+class EventStream {
+public:
+    OutputMode mode() const { return _mode; }
+    void setMode(OutputMode mode);
+    bool structured() const { return _mode != OutputMode::TEXT; }
+    static const char* modeName(OutputMode mode);
+    
+    // Any task. Stages the event; dropped (and counted) if full.
+    void emit(const StreamEvent& ev);
+    
+    // Main loop: number and encode staged events into the outgoing ring
+    // and the capture log
+    void update();
+    
+    // LZSS blocks on the console link
+    void setCompressed(bool on) { _compress = on; }
+    bool compressed() const { return _compress; }
+    
+    // Main loop: write as much as the port takes without blocking
+    void drain(Print& out, size_t room);
+    size_t pending() const { return _stageUsed + _used + (_blockLen - _blockPos); }
+    // Staging room; a full outgoing ring holds events back in staging
+    size_t room() const { return sizeof(_stage) - _stageUsed; }
+    // Something can go out now; else nextWakeMs() is when a held-back
+    // partial block is due
+    bool ready() const;
+    uint32_t nextWakeMs() const;
+    uint32_t drops() const { return _drops; }
+    
+    static uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc = 0);
+    
+    // Largest encoded record, either format
+    static const size_t MAX_RECORD = 384;
+    
+    // Size of a whole binary record given its length byte (offset 3)
+    static size_t binaryLength(uint8_t payloadLen) { return 16 + payloadLen; }
+    
+private:
+    OutputMode _mode = OutputMode::TEXT;
+    uint32_t _seq = 0;
+    uint32_t _drops = 0;
+    uint32_t _seqSkip = 0;      // Dropped while staging; their seq stays a gap
+    
+    // Entries: ms u32, StreamEvent, frame bytes
+    uint8_t _stage[EVENT_STAGE_BUF];
+    size_t _stageHead = 0;
+    size_t _stageUsed = 0;
+    
+    uint8_t _ring[EVENT_STREAM_BUF];
+    size_t _head = 0;           // Next byte to write out
+    size_t _used = 0;
+    uint32_t _pendingSince = 0;     // Ring went non-empty
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    
+    bool _compress = STREAM_COMPRESS;
+    uint8_t _block[Compressor::BLOCK_MAX + Compressor::OVERHEAD];
+    size_t _blockLen = 0;
+    size_t _blockPos = 0;           // Next byte of the block to write out
+    
+    size_t take(uint8_t* out, size_t len);
+    void stagePut(const void* data, size_t len);
+    void stageGet(void* data, size_t len);
+    void enqueue(const uint8_t* record, size_t len);
+    size_t encodeJson(const StreamEvent& ev, uint32_t seq, uint32_t ms, char* buf, size_t len);
+    size_t encodeBinary(const StreamEvent& ev, uint32_t seq, uint32_t ms, uint8_t* buf, size_t len);
+};
+
+// Global instance
+extern EventStream eventStream;
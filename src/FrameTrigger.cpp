@@ -0,0 +1,228 @@
+/**
+ * ESP32 Marauder TUI - Frame Trigger
+ *
+ * The ring holds fixed-size slots so the radio task only ever copies one
+ * frame under the lock; the main loop takes them out one at a time and
+ * encodes them at its own pace, bounded by what the outputs can hold.
+ */
+
+#include "FrameTrigger.h"
+#include "EventStream.h"
+#include "CaptureLog.h"
+#include "EventLoop.h"
+#include "SerialTUI.h"
+
+FrameTrigger frameTrigger;
+
+static_assert(TRIGGER_SNAPLEN <= StreamEvent::MAX_FRAME, "TRIGGER_SNAPLEN exceeds a FRAME record");
+static_assert(TRIGGER_RING_FRAMES <= 255, "TRIGGER_RING_FRAMES must fit the uint8_t indices");
+
+static_assert(TRIGGER_SNAPLEN >= 32, "TRIGGER_SNAPLEN must cover the beacon TSF");
+
+static const char* const KIND_NAMES[] = {"none", "deauth", "eapol", "bssid", "roll"};
+static const uint32_t RETRY_MS = 5;  // Outputs full: look again shortly
+
+const char* FrameTrigger::kindName(TriggerKind kind) {
+    return KIND_NAMES[(uint8_t)kind];
+}
+
+bool FrameTrigger::arm(TriggerKind kind, const uint8_t* bssid, uint32_t preMs, uint32_t postMs,
+                       bool rearm) {
+    if (kind == TriggerKind::NONE || kind >= TriggerKind::COUNT) return false;
+    if (kind == TriggerKind::BSSID && bssid == nullptr) return false;
+    
+    portENTER_CRITICAL(&_mux);
+    _kind = kind;
+    _filter = bssid != nullptr;
+    if (_filter) memcpy(_bssid, bssid, 6);
+    _preMs = preMs;
+    _postMs = postMs;
+    _rearm = rearm;
+    _head = 0;
+    _used = 0;
+    _pre = 0;
+    _post = 0;
+    _drops = 0;
+    _announce = false;
+    _fireMs = millis();
+    // Rolling: "fired" from the start, with no end to the post window
+    _state = kind == TriggerKind::ROLL ? State::POST : State::ARMED;
+    portEXIT_CRITICAL(&_mux);
+    _dedup.reset();
+    return true;
+}
+
+void FrameTrigger::disarm() {
+    portENTER_CRITICAL(&_mux);
+    _state = State::IDLE;
+    _used = 0;
+    _announce = false;
+    portEXIT_CRITICAL(&_mux);
+}
+
+bool FrameTrigger::involves(const uint8_t* frame, int len) const {
+    // addr1 always; addr2/addr3 when the frame is long enough to have them
+    if (len >= 10 && memcmp(frame + 4, _bssid, 6) == 0) return true;
+    if (len >= 16 && memcmp(frame + 10, _bssid, 6) == 0) return true;
+    return len >= 22 && memcmp(frame + 16, _bssid, 6) == 0;
+}
+
+// ============================================
+// Radio Task
+// ============================================
+
+void FrameTrigger::onFrame(const uint8_t* frame, int len, int8_t rssi, uint8_t channel) {
+    State state = _state;
+    if (state != State::ARMED && state != State::POST) return;
+    
+    len -= 4;  // sig_len counts the FCS
+    if (len < 10) return;
+    if (_filter && !involves(frame, len)) return;
+    
+    uint32_t now = millis();
+    bool wake = false;
+    portENTER_CRITICAL(&_mux);
+    if (_state == State::POST && !rolling() && now - _fireMs >= _postMs) _state = State::DRAIN;
+    
+    if (_state == State::ARMED || _state == State::POST) {
+        bool store = true;
+        if (_used == TRIGGER_RING_FRAMES) {
+            if (_state == State::ARMED) {
+                // Rolling window: the oldest frame makes room
+                _head = (_head + 1) % TRIGGER_RING_FRAMES;
+                _used--;
+            } else {
+                // Post-trigger frames the main loop has not taken yet
+                _drops++;
+                store = false;
+            }
+        }
+        if (store) {
+            Slot& slot = _ring[(_head + _used) % TRIGGER_RING_FRAMES];
+            slot.ms = now;
+            slot.len = len;
+            slot.rssi = rssi;
+            slot.channel = channel;
+            memcpy(slot.data, frame, min(len, TRIGGER_SNAPLEN));
+            _used++;
+            if (_state == State::POST) {
+                // Wake the main loop for the first frame and when the
+                // ring is filling up
+                _post++;
+                wake = _used == 1 || _used == TRIGGER_RING_FRAMES / 2;
+            }
+        }
+    }
+    bool hit = _state == State::ARMED && _kind == TriggerKind::BSSID;
+    portEXIT_CRITICAL(&_mux);
+    
+    if (hit) fire(TriggerKind::BSSID, frame);
+    if (wake) events.post(EventType::ALERT);
+}
+
+void FrameTrigger::fire(TriggerKind kind, const uint8_t* frame) {
+    if (_state != State::ARMED || kind != _kind) return;
+    if (_filter && !involves(frame, 24)) return;
+    
+    uint32_t now = millis();
+    portENTER_CRITICAL(&_mux);
+    if (_state != State::ARMED) {
+        portEXIT_CRITICAL(&_mux);
+        return;
+    }
+    // Keep only the pre-trigger window
+    while (_used > 0 && now - _ring[_head].ms > _preMs) {
+        _head = (_head + 1) % TRIGGER_RING_FRAMES;
+        _used--;
+    }
+    _pre = _used;
+    _post = 0;
+    _drops = 0;
+    _fireMs = now;
+    memcpy(_fireAddr, frame + 10, 6);
+    _announce = true;
+    _state = State::POST;
+    portEXIT_CRITICAL(&_mux);
+    
+    events.post(EventType::ALERT);
+}
+
+// ============================================
+// Commit (main loop)
+// ============================================
+
+bool FrameTrigger::outputsHaveRoom() const {
+    // Whole records only: wait rather than have the stream drop frames
+    if (eventStream.structured() && eventStream.room() < EventStream::MAX_RECORD) return false;
+    if (captureLog.recording() && captureLog.room() < EventStream::MAX_RECORD) return false;
+    return true;
+}
+
+void FrameTrigger::update() {
+    if (!fired()) return;
+    
+    if (_announce) {
+        _announce = false;
+        char buf[64];
+        snprintf(buf, sizeof(buf), "TRIGGER %s: %02X:%02X:%02X:%02X:%02X:%02X, %u frames before",
+                 kindName(_kind), _fireAddr[0], _fireAddr[1], _fireAddr[2],
+                 _fireAddr[3], _fireAddr[4], _fireAddr[5], _pre);
+        tui.printResult(buf);
+        eventStream.emit(StreamEvent(StreamType::TRIGGER)
+            .at(_fireMs).setClass((uint8_t)_kind).setMac(_fireAddr).setCount(_pre));
+    }
+    
+    // The post window also ends when no frame arrives to notice it
+    portENTER_CRITICAL(&_mux);
+    if (_state == State::POST && !rolling() && millis() - _fireMs >= _postMs) _state = State::DRAIN;
+    portEXIT_CRITICAL(&_mux);
+    
+    Slot slot;
+    while (outputsHaveRoom()) {
+        portENTER_CRITICAL(&_mux);
+        if (_used == 0) {
+            portEXIT_CRITICAL(&_mux);
+            break;
+        }
+        slot = _ring[_head];
+        _head = (_head + 1) % TRIGGER_RING_FRAMES;
+        _used--;
+        portEXIT_CRITICAL(&_mux);
+        
+        size_t stored = min((int)slot.len, TRIGGER_SNAPLEN);
+        if (BeaconDedup::isBeacon(slot.data, stored) &&
+            _dedup.unchanged(slot.data, stored, slot.len, slot.ms)) {
+            eventStream.emit(StreamEvent(StreamType::BEACON)
+                .at(slot.ms).setBssid(slot.data + 16).setRssi(slot.rssi).setChannel(slot.channel)
+                .setTsf(BeaconDedup::tsf(slot.data)).setSeqCtrl(BeaconDedup::seqCtrl(slot.data)));
+        } else {
+            eventStream.emit(StreamEvent(StreamType::FRAME)
+                .at(slot.ms).setRssi(slot.rssi).setChannel(slot.channel).setLength(slot.len)
+                .setFrame(slot.data, stored));
+        }
+    }
+    
+    if (_state == State::DRAIN && _used == 0) finish();
+}
+
+void FrameTrigger::finish() {
+    _shots++;
+    char buf[80];
+    snprintf(buf, sizeof(buf), "Trigger: %u frames committed (%u before, %u after, %lu lost)",
+             _pre + _post, _pre, _post, (unsigned long)_drops);
+    tui.printStatus(buf);
+    
+    portENTER_CRITICAL(&_mux);
+    _head = 0;
+    _state = _rearm ? State::ARMED : State::IDLE;
+    portEXIT_CRITICAL(&_mux);
+}
+
+uint32_t FrameTrigger::nextWakeMs() const {
+    if (!fired()) return EventLoop::FOREVER;
+    if (_announce) return 0;
+    if (_used > 0) return outputsHaveRoom() ? 0 : RETRY_MS;
+    if (_state == State::DRAIN) return 0;
+    if (rolling()) return EventLoop::FOREVER;  // The next frame wakes us
+    return msUntil(_fireMs, _postMs, millis());
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include "BeaconDedup.h"
+#include <freertos/FreeRTOS.h>
+
+// ============================================
+// Frame Trigger
+// Oscilloscope-style capture around one event
+// ============================================
+//
+// While armed, every sniffed frame (or, with a BSSID set, every frame to,
+// from or about that BSSID) goes into a RAM ring of TRIGGER_RING_FRAMES
+// slots, oldest overwritten. Nothing leaves the device until the trigger
+// fires: a deauth or EAPOL seen by the analyzers, or the first frame
+// involving the chosen BSSID. Then the frames of the last preMs are kept,
+// frames keep being collected for postMs, and the main loop commits them
+// all as FRAME records to the event stream / capture log, preceded by a
+// TRIGGER record.
+//
+// Single shot by default: the trigger disarms once the capture is out.
+// With rearm it waits for the next event instead. Roll mode has no event:
+// every frame is committed as it comes, for as long as it is armed.
+//
+// Repeated beacons go out as small BEACON delta records (BeaconDedup.h).
+
+enum class TriggerKind : uint8_t {
+    NONE,
+    DEAUTH,     // Deauth or disassoc (sniff deauth)
+    EAPOL,      // EAPOL key frame (sniff pmkid)
+    BSSID,      // Any frame involving the BSSID (any sniff mode)
+    ROLL,       // No event: continuous capture
+    COUNT
+};
+
+class FrameTrigger {
+public:
+    // bssid may be null (any) except for TriggerKind::BSSID
+    bool arm(TriggerKind kind, const uint8_t* bssid, uint32_t preMs, uint32_t postMs, bool rearm);
+    void disarm();
+    bool active() const { return _state != State::IDLE; }
+    bool fired() const { return _state == State::POST || _state == State::DRAIN; }
+    TriggerKind kind() const { return _kind; }
+    static const char* kindName(TriggerKind kind);
+    
+    // Promiscuous callback, before the analyzers see the frame
+    void onFrame(const uint8_t* frame, int len, int8_t rssi, uint8_t channel);
+    // From an analyzer: a kind event in this frame
+    void fire(TriggerKind kind, const uint8_t* frame);
+    
+    // Main loop: commit captured frames as the outputs take them
+    void update();
+    uint32_t nextWakeMs() const;
+    
+    // Last capture, for status lines
+    uint16_t lastPre() const { return _pre; }
+    uint16_t lastPost() const { return _post; }
+    uint32_t drops() const { return _drops; }
+    uint32_t shots() const { return _shots; }
+    const BeaconDedup& dedup() const { return _dedup; }
+    
+private:
+    enum class State : uint8_t {
+        IDLE,
+        ARMED,      // Ring rolling, waiting for the event
+        POST,       // Fired: collecting post-trigger frames
+        DRAIN       // Post window over: emptying the ring
+    };
+    
+    struct Slot {
+        uint32_t ms;
+        uint16_t len;           // Frame length without FCS
+        int8_t rssi;
+        uint8_t channel;
+        uint8_t data[TRIGGER_SNAPLEN];
+    };
+    
+    Slot _ring[TRIGGER_RING_FRAMES];
+    uint8_t _head = 0;
+    uint8_t _used = 0;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    
+    volatile State _state = State::IDLE;
+    TriggerKind _kind = TriggerKind::NONE;
+    bool _filter = false;
+    uint8_t _bssid[6];
+    uint32_t _preMs = TRIGGER_PRE_MS;
+    uint32_t _postMs = TRIGGER_POST_MS;
+    bool _rearm = false;
+    
+    uint32_t _fireMs = 0;
+    uint8_t _fireAddr[6];       // Transmitter of the triggering frame
+    bool _announce = false;     // TRIGGER record not yet emitted
+    uint16_t _pre = 0;
+    uint16_t _post = 0;
+    uint32_t _drops = 0;
+    uint32_t _shots = 0;
+    BeaconDedup _dedup;             // Main loop only
+    
+    bool rolling() const { return _kind == TriggerKind::ROLL; }
+    bool involves(const uint8_t* frame, int len) const;
+    bool outputsHaveRoom() const;
+    void finish();
+};
+
+// Global instance
+extern FrameTrigger frameTrigger;
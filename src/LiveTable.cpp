@@ -0,0 +1,284 @@
+/**
+ * ESP32 Marauder TUI - Live AP/Station Table
+ *
+ * The promiscuous callback updates records and sifts their position in a
+ * SortedIndex; the main loop snapshots the top rows at a bounded rate and
+ * repaints only the cells whose value changed.
+ */
+
+#include "LiveTable.h"
+#include "WiFiAttacks.h"
+#include "MenuDefs.h"
+#include "EventLoop.h"
+#include "Transport.h"
+
+LiveTable liveTable;
+
+// Column layout (1-based terminal columns), sized to TUI_WIDTH
+enum : uint8_t { COL_RANK, COL_ID, COL_CH, COL_PWR, COL_FRAMES, COL_AGE, COL_NAME, COL_COUNT };
+static const uint8_t COL_X[COL_COUNT] = {1, 4, 13, 16, 21, 27, 31};
+static const uint8_t COL_W[COL_COUNT] = {2, 8, 2, 4, 5, 3, TUI_WIDTH - 30};
+
+static const char* const SORT_NAMES[] = {"RSSI", "frames", "last seen"};
+
+// ============================================
+// Lifecycle
+// ============================================
+
+void LiveTable::begin(uint8_t topRow) {
+    _top = topRow;
+    _view = LiveView::APS;
+    _apOrder.clear();
+    _staOrder.clear();
+    applySort();
+    repaint();
+    _active = true;
+}
+
+void LiveTable::repaint() {
+    for (uint8_t r = 0; r < LIVE_TABLE_ROWS; r++) _shown[r].idx = 0xFF;
+    _shownTotal = 0xFF;
+    _titleDirty = true;
+    _lastDraw = 0;
+    
+    // Anything else printed during the run scrolls below the table
+    console.printf("\033[%u;r", _top + 2 + LIVE_TABLE_ROWS + 1);
+    console.printf("\033[%u;1H", _top + 2 + LIVE_TABLE_ROWS + 1);
+}
+
+void LiveTable::end() {
+    _active = false;
+}
+
+// ============================================
+// Record Updates (table lock held by caller)
+// ============================================
+
+void LiveTable::noteAP(uint8_t idx, int8_t rssi, uint16_t frames, uint32_t lastSeen) {
+    if (!_active || idx >= MAX_APS) return;
+    _apKeys.rssi[idx] = rssi;
+    _apKeys.frames[idx] = frames;
+    _apKeys.lastSeen[idx] = lastSeen;
+    _apOrder.update(idx);
+}
+
+void LiveTable::noteStation(uint8_t idx, int8_t rssi, uint16_t frames, uint32_t lastSeen) {
+    if (!_active || idx >= MAX_STATIONS) return;
+    _staKeys.rssi[idx] = rssi;
+    _staKeys.frames[idx] = frames;
+    _staKeys.lastSeen[idx] = lastSeen;
+    _staOrder.update(idx);
+}
+
+bool LiveTable::lessByKey(uint8_t a, uint8_t b, const void* ctx) {
+    const Keys* k = (const Keys*)ctx;
+    switch (k->sort) {
+        case LiveSort::FRAMES:
+            return k->frames[a] > k->frames[b];
+        case LiveSort::LAST_SEEN:
+            return (int32_t)(k->lastSeen[a] - k->lastSeen[b]) > 0;
+        default:
+            return k->rssi[a] > k->rssi[b];
+    }
+}
+
+void LiveTable::applySort() {
+    _apKeys.sort = _sort;
+    _staKeys.sort = _sort;
+    _apOrder.setOrder(lessByKey, &_apKeys);
+    _staOrder.setOrder(lessByKey, &_staKeys);
+}
+
+// ============================================
+// Input
+// ============================================
+
+bool LiveTable::handleKey(char c) {
+    if (!_active) return false;
+    
+    LiveSort sort = _sort;
+    switch (c) {
+        case 'r': case 'R': sort = LiveSort::RSSI; break;
+        case 'f': case 'F': sort = LiveSort::FRAMES; break;
+        case 'l': case 'L': sort = LiveSort::LAST_SEEN; break;
+        case 't': case 'T': case '\t':
+            _view = (_view == LiveView::APS) ? LiveView::STATIONS : LiveView::APS;
+            _titleDirty = true;
+            for (uint8_t r = 0; r < LIVE_TABLE_ROWS; r++) _shown[r].idx = 0xFF;
+            _lastDraw = 0;
+            return true;
+        default:
+            return false;
+    }
+    
+    if (sort != _sort) {
+        _sort = sort;
+        if (wifiAttacks.lockTables(portMAX_DELAY)) {
+            applySort();
+            wifiAttacks.unlockTables();
+        }
+        _titleDirty = true;
+        _lastDraw = 0;
+    }
+    return true;
+}
+
+// ============================================
+// Rendering
+// ============================================
+
+uint32_t LiveTable::nextWakeMs() const {
+    if (!_active) return EventLoop::FOREVER;
+    return msUntil(_lastDraw, LIVE_TABLE_REFRESH_MS, millis());
+}
+
+uint8_t LiveTable::snapshot(Row* rows) {
+    uint32_t now = millis();
+    uint8_t total = 0;
+    
+    if (!wifiAttacks.lockTables(portMAX_DELAY)) return 0;
+    
+    if (_view == LiveView::APS) {
+        auto* aps = wifiAttacks.getAPs();
+        total = _apOrder.size();
+        for (uint8_t r = 0; r < LIVE_TABLE_ROWS; r++) {
+            Row& row = rows[r];
+            if (r >= total) {
+                row.idx = 0xFF;
+                continue;
+            }
+            row.idx = _apOrder.at(r);
+            AccessPoint ap = aps->get(row.idx);
+            memcpy(row.mac, ap.bssid, 6);
+            memcpy(row.name, ap.essid, sizeof(row.name));
+            row.channel = ap.channel;
+            row.rssi = ap.rssi;
+            row.frames = ap.frames;
+            row.age = min((now - ap.lastSeen) / 1000, (uint32_t)999);
+        }
+    } else {
+        auto* stas = wifiAttacks.getStations();
+        total = _staOrder.size();
+        for (uint8_t r = 0; r < LIVE_TABLE_ROWS; r++) {
+            Row& row = rows[r];
+            if (r >= total) {
+                row.idx = 0xFF;
+                continue;
+            }
+            row.idx = _staOrder.at(r);
+            Station sta = stas->get(row.idx);
+            memcpy(row.mac, sta.mac, 6);
+            if (sta.bssid[0] & 0x01) {
+                strcpy(row.name, "(probing)");
+            } else {
+                snprintf(row.name, sizeof(row.name), ">%02X:%02X:%02X",
+                         sta.bssid[3], sta.bssid[4], sta.bssid[5]);
+            }
+            row.channel = sta.channel;
+            row.rssi = sta.rssi;
+            row.frames = sta.frames;
+            row.age = min((now - sta.lastSeen) / 1000, (uint32_t)999);
+        }
+    }
+    
+    wifiAttacks.unlockTables();
+    return total;
+}
+
+void LiveTable::update() {
+    if (!_active) return;
+    if (millis() - _lastDraw < LIVE_TABLE_REFRESH_MS) return;
+    _lastDraw = millis();
+    
+    Row rows[LIVE_TABLE_ROWS];
+    uint8_t total = snapshot(rows);
+    
+    console.print(ANSI::SAVE_CURSOR);
+    
+    if (_titleDirty || total != _shownTotal) {
+        drawTitle(total);
+        _shownTotal = total;
+    }
+    
+    for (uint8_t r = 0; r < LIVE_TABLE_ROWS; r++) {
+        Row& now = rows[r];
+        Row& was = _shown[r];
+        if (now.idx == 0xFF && was.idx == 0xFF) continue;
+        
+        bool full = now.idx != was.idx ||
+                    memcmp(now.mac, was.mac, 6) != 0 ||
+                    strcmp(now.name, was.name) != 0;
+        if (full || now.channel != was.channel || now.rssi != was.rssi ||
+            now.frames != was.frames || now.age != was.age) {
+            drawRow(r, now, full);
+            was = now;
+        }
+    }
+    
+    console.print(ANSI::RESET);
+    console.print(ANSI::RESTORE_CURSOR);
+}
+
+void LiveTable::drawTitle(uint8_t total) {
+    console.printf("\033[%u;1H", _top);
+    console.print(ANSI::CLEAR_LINE);
+    console.print(ANSI::FG_YELLOW);
+    console.print(ANSI::BOLD);
+    console.printf("%s %u by %s", _view == LiveView::APS ? "APs" : "STAs",
+                  total, SORT_NAMES[(uint8_t)_sort]);
+    console.print(ANSI::RESET);
+    console.print(ANSI::FG_GRAY);
+    console.print("  [R/F/L] sort [T] view");
+    
+    // Column headings
+    console.printf("\033[%u;1H", _top + 1);
+    console.print(ANSI::CLEAR_LINE);
+    console.printf("%-3s%-9s%-3s%-5s%-6s%-4s%s", "#",
+                  _view == LiveView::APS ? "BSSID" : "MAC",
+                  "CH", "PWR", "FRMS", "AGE",
+                  _view == LiveView::APS ? "ESSID" : "AP");
+    console.print(ANSI::RESET);
+    
+    _titleDirty = false;
+}
+
+void LiveTable::drawRow(uint8_t r, const Row& row, bool full) {
+    const Row& was = _shown[r];
+    char buf[34];
+    
+    if (row.idx == 0xFF) {
+        // Row emptied (view switched or table shrank)
+        console.printf("\033[%u;1H", _top + 2 + r);
+        console.print(ANSI::CLEAR_LINE);
+        return;
+    }
+    
+    if (full) {
+        snprintf(buf, sizeof(buf), "%u", r + 1);
+        drawCell(r, COL_RANK, buf);
+        snprintf(buf, sizeof(buf), "%02X:%02X:%02X", row.mac[3], row.mac[4], row.mac[5]);
+        drawCell(r, COL_ID, buf);
+        drawCell(r, COL_NAME, row.name[0] ? row.name : "<hidden>");
+    }
+    if (full || row.channel != was.channel) {
+        snprintf(buf, sizeof(buf), "%u", row.channel);
+        drawCell(r, COL_CH, buf);
+    }
+    if (full || row.rssi != was.rssi) {
+        snprintf(buf, sizeof(buf), "%d", row.rssi);
+        drawCell(r, COL_PWR, buf);
+    }
+    if (full || row.frames != was.frames) {
+        snprintf(buf, sizeof(buf), "%u", row.frames);
+        drawCell(r, COL_FRAMES, buf);
+    }
+    if (full || row.age != was.age) {
+        snprintf(buf, sizeof(buf), "%u", row.age);
+        drawCell(r, COL_AGE, buf);
+    }
+}
+
+void LiveTable::drawCell(uint8_t r, uint8_t col, const char* text) {
+    console.printf("\033[%u;%uH%-*.*s", _top + 2 + r, COL_X[col],
+                  COL_W[col], COL_W[col], text);
+}
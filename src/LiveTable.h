@@ -0,0 +1,89 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include "SortedIndex.h"
+
+// ============================================
+// Live Table
+// Airodump-style AP/station view, updated in place
+// ============================================
+
+enum class LiveSort : uint8_t {
+    RSSI,
+    FRAMES,
+    LAST_SEEN
+};
+
+enum class LiveView : uint8_t {
+    APS,
+    STATIONS
+};
+
+class LiveTable {
+public:
+    // topRow: first terminal row available below the status bar
+    void begin(uint8_t topRow);
+    void end();
+    
+    // Terminal was reset (console reattached): redraw every cell
+    void repaint();
+    bool isActive() const { return _active; }
+    
+    // Record changed; called by WiFiAttacks with the table lock held
+    void noteAP(uint8_t idx, int8_t rssi, uint16_t frames, uint32_t lastSeen);
+    void noteStation(uint8_t idx, int8_t rssi, uint16_t frames, uint32_t lastSeen);
+    
+    // Sort/view keys while running; false = not ours (stop the run)
+    bool handleKey(char c);
+    
+    void update();
+    uint32_t nextWakeMs() const;
+    
+private:
+    static constexpr uint8_t KEY_SLOTS = MAX_STATIONS > MAX_APS ? MAX_STATIONS : MAX_APS;
+    
+    // Sort keys mirrored from the tables so comparisons are O(1)
+    struct Keys {
+        int8_t rssi[KEY_SLOTS];
+        uint16_t frames[KEY_SLOTS];
+        uint32_t lastSeen[KEY_SLOTS];
+        LiveSort sort;
+    };
+    
+    // What one table row shows; compared cell by cell against the terminal
+    struct Row {
+        uint8_t idx;        // Table index, 0xFF = empty row
+        uint8_t mac[6];
+        char name[33];
+        uint8_t channel;
+        int8_t rssi;
+        uint16_t frames;
+        uint16_t age;       // Seconds since last seen
+    };
+    
+    bool _active = false;
+    uint8_t _top = 0;
+    LiveView _view = LiveView::APS;
+    LiveSort _sort = LiveSort::RSSI;
+    
+    Keys _apKeys;
+    Keys _staKeys;
+    SortedIndex<MAX_APS> _apOrder;
+    SortedIndex<MAX_STATIONS> _staOrder;
+    
+    Row _shown[LIVE_TABLE_ROWS];
+    uint8_t _shownTotal = 0xFF;
+    bool _titleDirty = true;
+    unsigned long _lastDraw = 0;
+    
+    static bool lessByKey(uint8_t a, uint8_t b, const void* ctx);
+    void applySort();
+    uint8_t snapshot(Row* rows);
+    void drawTitle(uint8_t total);
+    void drawRow(uint8_t r, const Row& row, bool full);
+    void drawCell(uint8_t r, uint8_t col, const char* text);
+};
+
+// Global instance
+extern LiveTable liveTable;
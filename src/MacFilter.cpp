@@ -0,0 +1,92 @@
+/**
+ * ESP32 Marauder TUI - MAC Filter
+ *
+ * Bit positions come from double hashing (h1 + i * h2) over one 64-bit
+ * mix of the MAC, so a lookup is a multiply chain and MAC_FILTER_HASHES
+ * byte reads; nothing is hashed twice.
+ */
+
+#include "MacFilter.h"
+#include <math.h>
+
+MacFilter macHistory;
+
+static const uint8_t HASHES = MAC_FILTER_HASHES;
+
+static uint64_t mix(const uint8_t* mac) {
+    uint64_t x = 0;
+    for (int i = 0; i < 6; i++) x = (x << 8) | mac[i];
+    // splitmix64 finalizer
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+// Maps a 32-bit hash onto 0..BITS-1 without a division
+static inline uint32_t bitIndex(uint32_t h) {
+    return (uint32_t)(((uint64_t)h * MacFilter::BITS) >> 32);
+}
+
+bool MacFilter::test(uint8_t gen, const uint8_t* mac) const {
+    uint64_t x = mix(mac);
+    uint32_t h1 = (uint32_t)x;
+    uint32_t h2 = (uint32_t)(x >> 32) | 1;
+    for (uint8_t i = 0; i < HASHES; i++) {
+        uint32_t b = bitIndex(h1 + i * h2);
+        if (!(_bits[gen][b >> 3] & (1 << (b & 7)))) return false;
+    }
+    return true;
+}
+
+void MacFilter::set(uint8_t gen, const uint8_t* mac) {
+    uint64_t x = mix(mac);
+    uint32_t h1 = (uint32_t)x;
+    uint32_t h2 = (uint32_t)(x >> 32) | 1;
+    for (uint8_t i = 0; i < HASHES; i++) {
+        uint32_t b = bitIndex(h1 + i * h2);
+        _bits[gen][b >> 3] |= 1 << (b & 7);
+    }
+    if (_fill[gen] < UINT16_MAX) _fill[gen]++;
+}
+
+void MacFilter::rotate(uint32_t now) {
+    _gen ^= 1;
+    memset(_bits[_gen], 0, sizeof(_bits[_gen]));
+    _fill[_gen] = 0;
+    _genStart = now;
+    _rotations++;
+}
+
+bool MacFilter::add(const uint8_t* mac, uint32_t now) {
+    if (_fill[_gen] >= MAC_HISTORY_LEN || now - _genStart >= MAC_FILTER_AGE_MS) rotate(now);
+    
+    if (test(_gen, mac)) return false;
+    bool seen = test(_gen ^ 1, mac);
+    set(_gen, mac);     // Copied forward, so it outlives the next rotation
+    if (!seen) _distinct++;
+    return !seen;
+}
+
+bool MacFilter::contains(const uint8_t* mac) const {
+    return test(_gen, mac) || test(_gen ^ 1, mac);
+}
+
+void MacFilter::clear() {
+    memset(_bits, 0, sizeof(_bits));
+    _fill[0] = 0;
+    _fill[1] = 0;
+    _genStart = millis();
+    _distinct = 0;
+}
+
+uint16_t MacFilter::falsePositiveBp() const {
+    // A new MAC passes a generation when all its bits are already set
+    float miss = 1.0f;
+    for (uint8_t gen = 0; gen < 2; gen++) {
+        uint32_t set = 0;
+        for (size_t i = 0; i < sizeof(_bits[gen]); i++) set += __builtin_popcount(_bits[gen][i]);
+        miss *= 1.0f - powf((float)set / BITS, HASHES);
+    }
+    return (uint16_t)lroundf((1.0f - miss) * 10000.0f);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+
+// ============================================
+// MAC Filter
+// "Seen before?" for more devices than the tables hold
+// ============================================
+//
+// The station table stops at MAX_STATIONS; past that, new devices used
+// to go unreported. This answers "seen before?" for MAC_HISTORY_LEN
+// devices in MAC_FILTER_BITS bits, with no per-device storage.
+//
+// Two Bloom filters of MAC_FILTER_HASHES bits per MAC, used as
+// generations: new MACs go into the current one, a lookup checks both,
+// and a MAC found only in the previous one is copied forward. The
+// current one becomes the previous (and the old previous is wiped) once
+// it holds MAC_HISTORY_LEN MACs or is MAC_FILTER_AGE_MS old. A device
+// seen at least once per generation is never forgotten; one gone for two
+// generations is reported as new again. Because no generation holds
+// more than MAC_HISTORY_LEN MACs, the false positive rate (a new device
+// taken as seen) stays at its design value however long the session:
+// about 0.8% per generation at capacity, so under 1.7% for both.
+//
+// Not locked: the station paths call it with the target tables locked.
+
+class MacFilter {
+public:
+    static const uint32_t BITS = MAC_FILTER_BITS;
+    
+    // True if mac was not seen before; either way it is seen now
+    bool add(const uint8_t* mac, uint32_t now);
+    bool contains(const uint8_t* mac) const;
+    void clear();
+    
+    // Distinct MACs added (new ones only, so slightly low by false positives)
+    uint32_t distinct() const { return _distinct; }
+    uint16_t current() const { return _fill[_gen]; }
+    uint32_t rotations() const { return _rotations; }
+    // False positive rate at the present fill, in 1/10000
+    uint16_t falsePositiveBp() const;
+    
+private:
+    uint8_t _bits[2][BITS / 8];
+    uint8_t _gen = 0;               // Current generation
+    uint16_t _fill[2] = {0, 0};     // MACs added to each
+    uint32_t _genStart = 0;
+    uint32_t _distinct = 0;
+    uint32_t _rotations = 0;
+    
+    bool test(uint8_t gen, const uint8_t* mac) const;
+    void set(uint8_t gen, const uint8_t* mac);
+    void rotate(uint32_t now);
+};
+
+// Station history (WiFiAttacks)
+extern MacFilter macHistory;
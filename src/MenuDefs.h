@@ -13,6 +13,13 @@ namespace ANSI {
     constexpr const char* CURSOR_HIDE = "\033[?25l";
     constexpr const char* CURSOR_SHOW = "\033[?25h";
     constexpr const char* CLEAR_LINE = "\033[2K";
+    constexpr const char* ERASE_EOL = "\033[K";
+    constexpr const char* ERASE_BELOW = "\033[J";
+    constexpr const char* SAVE_CURSOR = "\0337";
+    constexpr const char* RESTORE_CURSOR = "\0338";
+    constexpr const char* RESET_SCROLL_REGION = "\033[r";
+    constexpr const char* AUTOWRAP_OFF = "\033[?7l";
+    constexpr const char* AUTOWRAP_ON = "\033[?7h";
     
     // Colors (tasteful palette)
     constexpr const char* RESET = "\033[0m";
@@ -41,6 +48,8 @@ enum class MenuAction : uint8_t {
     SUBMENU,
     WIFI_SCAN_AP,
     WIFI_SCAN_STA,
+    WIFI_LIVE_VIEW,
+    WIFI_SURVEY,
     WIFI_SNIFF_BEACON,
     WIFI_SNIFF_PROBE,
     WIFI_SNIFF_DEAUTH,
@@ -68,7 +77,11 @@ enum class MenuAction : uint8_t {
     TARGETS_SELECT,
     TARGETS_ADD_SSID,
     TARGETS_CLEAR,
+    RESULTS_VIEW,
     SETTINGS_CHANNEL,
+    SETTINGS_OUTPUT,
+    SETTINGS_CONSOLE,
+    SETTINGS_BT_PROFILE,
     REBOOT,
     BACK
 };
@@ -113,6 +126,8 @@ const MenuItem wifiAttackMenu[] = {
 const MenuItem wifiMenu[] = {
     {"Scan APs", MenuAction::WIFI_SCAN_AP, nullptr, 0},
     {"Scan Stations", MenuAction::WIFI_SCAN_STA, nullptr, 0},
+    {"Live View", MenuAction::WIFI_LIVE_VIEW, nullptr, 0},
+    {"WiFi+BT Survey", MenuAction::WIFI_SURVEY, nullptr, 0},
     {"Sniff >", MenuAction::SUBMENU, wifiSniffMenu, 7},
     {"Attack >", MenuAction::SUBMENU, wifiAttackMenu, 6},
     {"Set Channel", MenuAction::WIFI_SET_CHANNEL, nullptr, 0},
@@ -153,17 +168,21 @@ const MenuItem targetsMenu[] = {
 // Settings submenu
 const MenuItem settingsMenu[] = {
     {"Channel", MenuAction::SETTINGS_CHANNEL, nullptr, 0},
+    {"Output Mode", MenuAction::SETTINGS_OUTPUT, nullptr, 0},
+    {"Console Link", MenuAction::SETTINGS_CONSOLE, nullptr, 0},
+    {"BT Scan Profile", MenuAction::SETTINGS_BT_PROFILE, nullptr, 0},
     {"< Back", MenuAction::BACK, nullptr, 0}
 };
 
 // Main menu
 const MenuItem mainMenu[] = {
-    {"WiFi", MenuAction::SUBMENU, wifiMenu, 6},
+    {"WiFi", MenuAction::SUBMENU, wifiMenu, 8},
     {"Bluetooth", MenuAction::SUBMENU, btMenu, 6},
     {"Targets", MenuAction::SUBMENU, targetsMenu, 7},
-    {"Settings", MenuAction::SUBMENU, settingsMenu, 2},
+    {"Results", MenuAction::RESULTS_VIEW, nullptr, 0},
+    {"Settings", MenuAction::SUBMENU, settingsMenu, 5},
     {"Reboot", MenuAction::REBOOT, nullptr, 0}
 };
 
-constexpr uint8_t MAIN_MENU_SIZE = 5;
+constexpr uint8_t MAIN_MENU_SIZE = 6;
 
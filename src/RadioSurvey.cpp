@@ -0,0 +1,153 @@
+/**
+ * ESP32 Marauder TUI - Radio Survey
+ *
+ * Switching costs an esp_wifi_set_promiscuous() call and a NimBLE scan
+ * stop/start (a few HCI commands), so slices are hundreds of ms, not the
+ * few ms the coexistence arbiter would use.
+ */
+
+#include "RadioSurvey.h"
+#include "WiFiAttacks.h"
+#include "BTAttacks.h"
+#include "SerialTUI.h"
+#include "EventLoop.h"
+#include "EventStream.h"
+
+RadioSurvey radioSurvey;
+
+void RadioSurvey::setSlices(uint16_t wifiMs, uint16_t bleMs) {
+    _sliceMs[WIFI] = wifiMs ? wifiMs : SURVEY_WIFI_SLICE_MS;
+    _sliceMs[BLE] = bleMs ? bleMs : SURVEY_BLE_SLICE_MS;
+}
+
+void RadioSurvey::start() {
+    uint32_t now = millis();
+    _active = true;
+    _radio = WIFI;
+    _airMs[WIFI] = 0;
+    _airMs[BLE] = 0;
+    _switches = 0;
+    _switchUs = 0;
+    _startMs = now;
+    _lastStats = now;
+    _lastSummary = now;
+    
+    // WiFi slice first: capture runs, the scan waits for its turn
+    btAttacks.startSurvey();
+    wifiAttacks.startSurvey();
+    _sliceStart = millis();
+    
+    char buf[64];
+    snprintf(buf, sizeof(buf), "WiFi + BLE survey: %u ms WiFi / %u ms BLE slices",
+             _sliceMs[WIFI], _sliceMs[BLE]);
+    tui.printStatus(buf);
+}
+
+void RadioSurvey::stop() {
+    if (!_active) return;
+    uint32_t now = millis();
+    _airMs[_radio] += now - _sliceStart;
+    _sliceStart = now;
+    printSummary(now);
+    _active = false;
+}
+
+void RadioSurvey::enter(Radio radio, uint32_t now) {
+    _airMs[_radio] += now - _sliceStart;
+    
+    // Off first, so the two never compete for the radio
+    uint32_t start = micros();
+    if (radio == BLE) {
+        wifiAttacks.pauseCapture(true);
+        btAttacks.pauseScan(false);
+    } else {
+        btAttacks.pauseScan(true);
+        wifiAttacks.pauseCapture(false);
+    }
+    _switchUs += micros() - start;
+    _switches++;
+    
+    _radio = radio;
+    _sliceStart = millis();
+}
+
+void RadioSurvey::update() {
+    if (!_active) return;
+    uint32_t now = millis();
+    
+    if (now - _sliceStart >= _sliceMs[_radio]) {
+        enter(_radio == WIFI ? BLE : WIFI, now);
+        now = millis();
+    }
+    
+    if (now - _lastStats >= STATUS_BAR_REFRESH_MS) {
+        printStats(now);
+        _lastStats = now;
+    }
+    if (now - _lastSummary >= SURVEY_SUMMARY_MS) {
+        printSummary(now);
+        _lastSummary = now;
+    }
+}
+
+uint32_t RadioSurvey::nextWakeMs() const {
+    if (!_active) return EventLoop::FOREVER;
+    uint32_t now = millis();
+    uint32_t wait = msUntil(_sliceStart, _sliceMs[_radio], now);
+    wait = min(wait, msUntil(_lastStats, STATUS_BAR_REFRESH_MS, now));
+    return min(wait, msUntil(_lastSummary, SURVEY_SUMMARY_MS, now));
+}
+
+// Time a radio has had since start, the running slice included
+uint32_t RadioSurvey::airMs(Radio radio, uint32_t now) const {
+    return _airMs[radio] + (_radio == radio ? now - _sliceStart : 0);
+}
+
+uint8_t RadioSurvey::airPercent(Radio radio, uint32_t now) const {
+    uint32_t total = now - _startMs;
+    return total ? (uint64_t)airMs(radio, now) * 100 / total : 0;
+}
+
+// Pinned status bar: share of the radio so far and totals per side
+void RadioSurvey::printStats(uint32_t now) {
+    uint32_t frames = wifiAttacks._packetCount;
+    uint32_t adverts = btAttacks.advertCount();
+    
+    char buf[64];
+    snprintf(buf, sizeof(buf), "WiFi %u%% %lu fr | BLE %u%% %lu adv %u dev",
+             airPercent(WIFI, now), (unsigned long)frames, airPercent(BLE, now),
+             (unsigned long)adverts, btAttacks.deviceCount());
+    tui.setStats(buf);
+    if (now - _lastStatsEvent >= STATS_EVENT_MS) {
+        eventStream.emit(StreamEvent(StreamType::STATS)
+            .setCount(frames + adverts).setDrops(eventStream.drops()));
+        _lastStatsEvent = now;
+    }
+}
+
+void RadioSurvey::printSummary(uint32_t now) {
+    uint32_t wifiMs = airMs(WIFI, now);
+    uint32_t bleMs = airMs(BLE, now);
+    uint32_t frames = wifiAttacks._packetCount;
+    uint32_t adverts = btAttacks.advertCount();
+    
+    char buf[64];
+    snprintf(buf, sizeof(buf), "Survey: %d APs, %d STAs, %u BLE devices",
+             wifiAttacks.getAPs()->size(), wifiAttacks.getStations()->size(),
+             btAttacks.deviceCount());
+    tui.printResult(buf, ResultKind::INFO);
+    snprintf(buf, sizeof(buf), "WiFi: %u%% air, %lu fr, %lu/s on air, %lu lock misses",
+             airPercent(WIFI, now), (unsigned long)frames,
+             (unsigned long)(wifiMs ? (uint64_t)frames * 1000 / wifiMs : 0),
+             (unsigned long)wifiAttacks._lockMisses);
+    tui.printResult(buf, ResultKind::INFO);
+    snprintf(buf, sizeof(buf), "BLE: %u%% air, %lu adv, %lu/s on air, %lu evicted",
+             airPercent(BLE, now), (unsigned long)adverts,
+             (unsigned long)(bleMs ? (uint64_t)adverts * 1000 / bleMs : 0),
+             (unsigned long)btAttacks.evictions());
+    tui.printResult(buf, ResultKind::INFO);
+    snprintf(buf, sizeof(buf), "Switching: %lux, %lu us avg, %lu stream drops",
+             (unsigned long)_switches, (unsigned long)(_switches ? _switchUs / _switches : 0),
+             (unsigned long)eventStream.drops());
+    tui.printResult(buf, ResultKind::INFO);
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+
+// ============================================
+// Radio Survey
+// WiFi capture and BLE scan sharing one radio
+// ============================================
+//
+// The ESP32 has a single 2.4 GHz radio. Left alone, the coexistence
+// arbiter splits it between promiscuous WiFi and a BLE scan as it sees
+// fit, and neither side can tell what it missed. The survey makes the
+// split explicit: a WiFi slice (promiscuous on, channel hopping, BLE
+// scan stopped) then a BLE slice (promiscuous off, hop clock frozen,
+// scan running), repeated. The split comes from SURVEY_WIFI_SLICE_MS /
+// SURVEY_BLE_SLICE_MS or the wifi= / ble= options of the survey command.
+//
+// Both sides feed the same event stream (AP, STATION and BLE records)
+// and the inventory is the AP / station tables plus the BLE device
+// table. Each summary shows per radio the share of time it had, its
+// rate while it had it, and what the pipeline dropped, plus the time
+// lost switching between the two.
+
+class RadioSurvey {
+public:
+    void start();
+    void stop();
+    bool active() const { return _active; }
+    
+    // Next survey's slice lengths (0 = Config default)
+    void setSlices(uint16_t wifiMs, uint16_t bleMs);
+    
+    // Main loop
+    void update();
+    uint32_t nextWakeMs() const;
+    
+private:
+    enum Radio : uint8_t { WIFI, BLE };
+    
+    bool _active = false;
+    Radio _radio = WIFI;
+    uint16_t _sliceMs[2] = {SURVEY_WIFI_SLICE_MS, SURVEY_BLE_SLICE_MS};
+    uint32_t _sliceStart = 0;
+    
+    // Since start: time each radio had, switching cost
+    uint32_t _airMs[2] = {0, 0};
+    uint32_t _switches = 0;
+    uint32_t _switchUs = 0;
+    
+    uint32_t _startMs = 0;
+    uint32_t _lastStats = 0;
+    uint32_t _lastStatsEvent = 0;
+    uint32_t _lastSummary = 0;
+    
+    void enter(Radio radio, uint32_t now);
+    uint32_t airMs(Radio radio, uint32_t now) const;
+    uint8_t airPercent(Radio radio, uint32_t now) const;
+    void printStats(uint32_t now);
+    void printSummary(uint32_t now);
+};
+
+// Global instance
+extern RadioSurvey radioSurvey;
@@ -0,0 +1,37 @@
+/**
+ * ESP32 Marauder TUI - Result History
+ */
+
+#include "ResultHistory.h"
+
+void ResultHistory::add(const ResultEntry& entry) {
+    _ring[_head] = entry;
+    _head = (_head + 1) % RESULT_HISTORY_LEN;
+    if (_size < RESULT_HISTORY_LEN) _size++;
+    _total++;
+}
+
+void ResultHistory::clear() {
+    _head = 0;
+    _size = 0;
+    _total = 0;
+}
+
+const ResultEntry& ResultHistory::at(uint8_t i) const {
+    uint8_t oldest = (_head + RESULT_HISTORY_LEN - _size) % RESULT_HISTORY_LEN;
+    return _ring[(oldest + i) % RESULT_HISTORY_LEN];
+}
+
+static bool containsNoCase(const char* haystack, const char* needle) {
+    size_t n = strlen(needle);
+    for (; *haystack; haystack++) {
+        if (strncasecmp(haystack, needle, n) == 0) return true;
+    }
+    return false;
+}
+
+bool ResultHistory::matches(const ResultEntry& entry, const char* filter) {
+    if (filter == nullptr || filter[0] == '\0') return true;
+    return containsNoCase(entry.text, filter) ||
+           containsNoCase(ResultQueue::kindName(entry.kind), filter);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include "ResultQueue.h"
+
+// ============================================
+// Result History
+// Fixed-size ring of the most recent results
+// ============================================
+//
+// Every result written to the terminal is also copied here (text plus the
+// structured record), so it can be paged, filtered and re-printed after
+// the live run's scroll region is torn down. The ring is a static array:
+// the oldest record is overwritten, nothing is allocated per line.
+// Main loop only.
+
+class ResultHistory {
+public:
+    void add(const ResultEntry& entry);
+    void clear();
+    
+    uint8_t size() const { return _size; }
+    uint32_t total() const { return _total; }  // Results recorded since clear()
+    
+    // 0 = oldest retained record
+    const ResultEntry& at(uint8_t i) const;
+    
+    // Case-insensitive substring match on the text or kind name ("" = all)
+    static bool matches(const ResultEntry& entry, const char* filter);
+    
+private:
+    ResultEntry _ring[RESULT_HISTORY_LEN];
+    uint8_t _head = 0;      // Next slot to write
+    uint8_t _size = 0;
+    uint32_t _total = 0;
+};
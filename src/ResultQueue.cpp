@@ -0,0 +1,174 @@
+/**
+ * ESP32 Marauder TUI - Result Queue
+ *
+ * Replaces time-based throttling (which discarded results arriving less
+ * than 100 ms apart) with bounded buffering plus coalescing.
+ */
+
+#include "ResultQueue.h"
+
+// Indexed by ResultKind
+static const ResultPriority KIND_PRIORITY[] = {
+    ResultPriority::NORMAL,   // INFO
+    ResultPriority::NORMAL,   // AP
+    ResultPriority::LOW,      // BEACON
+    ResultPriority::NORMAL,   // PROBE
+    ResultPriority::HIGH,     // STATION (new station)
+    ResultPriority::HIGH,     // DEAUTH
+    ResultPriority::HIGH,     // EAPOL
+    ResultPriority::HIGH,     // PWNAGOTCHI
+    ResultPriority::LOW,      // RAW
+    ResultPriority::LOW,      // BLE
+    ResultPriority::HIGH,     // AIRTAG
+    ResultPriority::HIGH,     // FLIPPER
+    ResultPriority::HIGH,     // SKIMMER
+    ResultPriority::HIGH,     // SPAM
+};
+
+static const char* const KIND_NAMES[] = {
+    "info", "ap", "beacon", "probe", "station", "deauth", "eapol",
+    "pwnagotchi", "raw", "ble", "airtag", "flipper", "skimmer", "spam"
+};
+
+ResultPriority ResultQueue::priorityOf(ResultKind kind) {
+    return KIND_PRIORITY[(uint8_t)kind];
+}
+
+const char* ResultQueue::kindName(ResultKind kind) {
+    return KIND_NAMES[(uint8_t)kind];
+}
+
+uint32_t ResultQueue::keyOf(const void* data, size_t len) {
+    const uint8_t* p = (const uint8_t*)data;
+    uint32_t h = 2166136261UL;
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ p[i]) * 16777619UL;
+    }
+    return h ? h : 1;  // 0 means "use the text"
+}
+
+void ResultQueue::push(ResultKind kind, const char* text, uint32_t key,
+                       const ResultMeta* meta) {
+    if (key == 0) key = keyOf(text, strlen(text));
+    ResultPriority prio = priorityOf(kind);
+    uint32_t now = millis();
+    
+    portENTER_CRITICAL(&_mux);
+    
+    // Same kind and identity already waiting: merge
+    for (uint8_t i = 0; i < RESULT_QUEUE_LEN; i++) {
+        ResultEntry& e = _slots[i];
+        if (_inUse[i] && e.kind == kind && e.key == key) {
+            if (e.count < UINT16_MAX) e.count++;
+            if (meta) e.meta = *meta;
+            strncpy(e.text, text, RESULT_TEXT_LEN - 1);
+            e.text[RESULT_TEXT_LEN - 1] = '\0';
+            _mergedTotal++;
+            portEXIT_CRITICAL(&_mux);
+            return;
+        }
+    }
+    
+    int slot = -1;
+    if (_used < RESULT_QUEUE_LEN) {
+        for (uint8_t i = 0; i < RESULT_QUEUE_LEN; i++) {
+            if (!_inUse[i]) { slot = i; break; }
+        }
+        _used++;
+    } else if (prio == ResultPriority::HIGH) {
+        slot = findVictim(ResultPriority::HIGH);
+        if (slot >= 0) {
+            // Evicted entry stays accounted for in the summary
+            ResultEntry& v = _slots[slot];
+            _overflow[(uint8_t)v.kind] += v.count;
+        } else {
+            _lostHigh++;
+        }
+    } else {
+        _overflow[(uint8_t)kind]++;
+    }
+    
+    if (slot >= 0) {
+        ResultEntry& e = _slots[slot];
+        e.kind = kind;
+        e.prio = prio;
+        e.count = 1;
+        e.key = key;
+        e.seq = _seq++;
+        e.time = now;
+        e.meta = meta ? *meta : ResultMeta();
+        strncpy(e.text, text, RESULT_TEXT_LEN - 1);
+        e.text[RESULT_TEXT_LEN - 1] = '\0';
+        _inUse[slot] = true;
+    }
+    
+    portEXIT_CRITICAL(&_mux);
+}
+
+int ResultQueue::findVictim(ResultPriority below) {
+    // Newest entry of the lowest priority present under `below`
+    int victim = -1;
+    for (uint8_t i = 0; i < RESULT_QUEUE_LEN; i++) {
+        if (!_inUse[i] || _slots[i].prio >= below) continue;
+        if (victim < 0 ||
+            _slots[i].prio < _slots[victim].prio ||
+            (_slots[i].prio == _slots[victim].prio && _slots[i].seq > _slots[victim].seq)) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+bool ResultQueue::pop(ResultEntry& out) {
+    portENTER_CRITICAL(&_mux);
+    
+    int oldest = -1;
+    for (uint8_t i = 0; i < RESULT_QUEUE_LEN; i++) {
+        if (_inUse[i] && (oldest < 0 || (int32_t)(_slots[i].seq - _slots[oldest].seq) < 0)) {
+            oldest = i;
+        }
+    }
+    if (oldest >= 0) {
+        out = _slots[oldest];
+        _inUse[oldest] = false;
+        _used--;
+    }
+    
+    portEXIT_CRITICAL(&_mux);
+    return oldest >= 0;
+}
+
+bool ResultQueue::takeOverflowSummary(char* buf, size_t len) {
+    uint32_t counts[(uint8_t)ResultKind::COUNT];
+    uint32_t lostHigh;
+    
+    portENTER_CRITICAL(&_mux);
+    memcpy(counts, _overflow, sizeof(counts));
+    memset(_overflow, 0, sizeof(_overflow));
+    lostHigh = _lostHigh;
+    _lostHigh = 0;
+    portEXIT_CRITICAL(&_mux);
+    
+    size_t pos = 0;
+    buf[0] = '\0';
+    for (uint8_t k = 0; k < (uint8_t)ResultKind::COUNT; k++) {
+        if (counts[k] == 0 || pos >= len) continue;
+        pos += snprintf(buf + pos, len - pos, "%s%s x%lu", pos ? ", " : "",
+                        KIND_NAMES[k], (unsigned long)counts[k]);
+    }
+    if (lostHigh > 0 && pos < len) {
+        pos += snprintf(buf + pos, len - pos, "%sLOST high-priority x%lu",
+                        pos ? ", " : "", (unsigned long)lostHigh);
+    }
+    return pos > 0;
+}
+
+void ResultQueue::clear() {
+    portENTER_CRITICAL(&_mux);
+    memset(_inUse, 0, sizeof(_inUse));
+    memset(_overflow, 0, sizeof(_overflow));
+    _used = 0;
+    _lostHigh = 0;
+    _mergedTotal = 0;
+    portEXIT_CRITICAL(&_mux);
+}
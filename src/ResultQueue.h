@@ -0,0 +1,104 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include <freertos/FreeRTOS.h>
+
+// ============================================
+// Result Queue
+// Bounded, priority-aware, coalescing result buffer
+// ============================================
+//
+// Radio callbacks push results; the main loop drains them as fast as the
+// transport accepts. Nothing is silently thrown away:
+//  - a result whose key matches a queued entry of the same kind is merged
+//    into it (count++, newest text kept) and printed as "xN"
+//  - when full, LOW/NORMAL results are folded into per-kind overflow
+//    counters that are reported as a summary line
+//  - HIGH results evict the newest lower-priority entry (which is itself
+//    folded into the overflow counters); only a queue made entirely of
+//    HIGH entries can lose one, and that is counted and reported too
+
+enum class ResultKind : uint8_t {
+    INFO,
+    AP,
+    BEACON,
+    PROBE,
+    STATION,
+    DEAUTH,
+    EAPOL,
+    PWNAGOTCHI,
+    RAW,
+    BLE,
+    AIRTAG,
+    FLIPPER,
+    SKIMMER,
+    SPAM,
+    COUNT
+};
+
+enum class ResultPriority : uint8_t {
+    LOW,
+    NORMAL,
+    HIGH
+};
+
+// Structured fields a producer can attach next to the formatted text
+struct ResultMeta {
+    int8_t rssi = 0;
+    uint8_t channel = 0;
+    uint8_t mac[6] = {};    // BSSID / station / BLE address, zero if none
+    
+    ResultMeta() = default;
+    ResultMeta(int8_t r, uint8_t ch, const uint8_t* addr = nullptr) : rssi(r), channel(ch) {
+        if (addr) memcpy(mac, addr, sizeof(mac));
+    }
+};
+
+struct ResultEntry {
+    ResultKind kind;
+    ResultPriority prio;
+    uint16_t count;         // Occurrences merged into this entry
+    uint32_t key;           // Coalescing identity (kind-scoped)
+    uint32_t seq;           // Arrival order
+    uint32_t time;          // millis() of the first occurrence
+    ResultMeta meta;        // Latest occurrence
+    char text[RESULT_TEXT_LEN];
+};
+
+class ResultQueue {
+public:
+    static ResultPriority priorityOf(ResultKind kind);
+    static const char* kindName(ResultKind kind);
+    
+    // FNV-1a over an identity (MAC, BSSID...) for use as a coalescing key
+    static uint32_t keyOf(const void* data, size_t len);
+    
+    // Any task. key = 0 coalesces on identical text.
+    void push(ResultKind kind, const char* text, uint32_t key = 0,
+              const ResultMeta* meta = nullptr);
+              
+    // Main loop. Oldest entry first.
+    bool pop(ResultEntry& out);
+    
+    // Formats and clears the overflow counters; false if nothing to report
+    bool takeOverflowSummary(char* buf, size_t len);
+    
+    uint8_t pending() const { return _used; }
+    uint32_t mergedTotal() const { return _mergedTotal; }
+    void clear();
+    
+private:
+    ResultEntry _slots[RESULT_QUEUE_LEN];
+    bool _inUse[RESULT_QUEUE_LEN] = {};
+    uint8_t _used = 0;
+    uint32_t _seq = 0;
+    
+    uint32_t _overflow[(uint8_t)ResultKind::COUNT] = {};
+    uint32_t _lostHigh = 0;
+    uint32_t _mergedTotal = 0;
+    
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    
+    int findVictim(ResultPriority below);
+};
@@ -0,0 +1,207 @@
+/**
+ * ESP32 Marauder TUI - Screen Model
+ *
+ * Differential renderer: a W/S keypress changes two menu rows, so only
+ * those two rows go over the wire instead of the whole header/menu/footer.
+ */
+
+#include "ScreenModel.h"
+#include "MenuDefs.h"
+
+static const uint32_t FNV_OFFSET = 2166136261UL;
+static const uint32_t FNV_PRIME = 16777619UL;
+
+// Escape parser states
+static const uint8_t ESC_NONE = 0;
+static const uint8_t ESC_START = 1;     // ESC seen
+static const uint8_t ESC_CSI = 2;       // ESC [ seen, parameters follow
+
+// SGR attribute bits
+static const uint8_t SGR_BOLD = 0x01;
+static const uint8_t SGR_DIM = 0x02;
+static const uint8_t SGR_ITALIC = 0x04;
+static const uint8_t SGR_UNDERLINE = 0x08;
+static const uint8_t SGR_BLINK = 0x10;
+static const uint8_t SGR_REVERSE = 0x20;
+
+// Attribute bits in order, with the SGR code that sets each
+static const uint8_t SGR_CODES[] = {1, 2, 3, 4, 5, 7};
+
+void ScreenModel::beginFrame() {
+    _row = 0;
+    _len = 0;
+    _hash = FNV_OFFSET;
+    _frameBytes = 0;
+    _sgr = 0;
+    _rowSgr = 0;
+    _esc = ESC_NONE;
+    
+    if (_fullRedraw) {
+        // Default attributes, as the row hashes assume
+        emit(ANSI::RESET);
+        emit(ANSI::CLEAR_SCREEN);
+        emit(ANSI::CURSOR_HOME);
+    }
+}
+
+void ScreenModel::endFrame() {
+    // Flush a trailing line without newline
+    if (_len > 0) commitLine();
+    
+    if (!_fullRedraw) {
+        // Park the cursor below the frame and wipe leftovers from a longer
+        // previous frame or from status lines printed since
+        cursorTo(_row);
+        if (_row < _rows || _externalRows > 0) {
+            emit(ANSI::ERASE_BELOW);
+        }
+    }
+    
+    _rows = _row;
+    _externalRows = 0;
+    _fullRedraw = false;
+}
+
+void ScreenModel::noteExternalLine() {
+    _externalRows++;
+    
+    // Once output may have scrolled the terminal, row addresses are stale
+    if (_rows + _externalRows >= TUI_HEIGHT) {
+        _fullRedraw = true;
+    }
+}
+
+size_t ScreenModel::write(uint8_t c) {
+    if (c == '\r') return 1;
+    if (c == '\n') {
+        commitLine();
+        return 1;
+    }
+    
+    if (_len < LINE_MAX) _line[_len++] = c;
+    _hash = (_hash ^ c) * FNV_PRIME;
+    track(c);
+    return 1;
+}
+
+// Follows CSI sequences; only SGR (final byte 'm') changes state
+void ScreenModel::track(uint8_t c) {
+    switch (_esc) {
+        case ESC_NONE:
+            if (c == 0x1B) _esc = ESC_START;
+            break;
+            
+        case ESC_START:
+            _esc = c == '[' ? ESC_CSI : ESC_NONE;
+            _paramCount = 0;
+            _params[0] = 0;
+            break;
+            
+        case ESC_CSI:
+            if (c >= '0' && c <= '9') {
+                uint16_t v = _params[_paramCount] * 10 + (c - '0');
+                _params[_paramCount] = v > UINT8_MAX ? UINT8_MAX : v;
+            } else if (c == ';') {
+                if (_paramCount < SGR_PARAMS - 1) _params[++_paramCount] = 0;
+            } else if (c >= 0x40 && c <= 0x7E) {
+                if (c == 'm') applySgr();
+                _esc = ESC_NONE;
+            }
+            break;
+    }
+}
+
+void ScreenModel::applySgr() {
+    uint8_t attrs = _sgr & 0xFF;
+    uint8_t fg = (_sgr >> 8) & 0xFF;
+    uint8_t bg = (_sgr >> 16) & 0xFF;
+    
+    for (uint8_t i = 0; i <= _paramCount; i++) {
+        uint8_t p = _params[i];
+        if (p == 0) {
+            attrs = fg = bg = 0;
+        } else if (p == 1) {
+            attrs |= SGR_BOLD;
+        } else if (p == 2) {
+            attrs |= SGR_DIM;
+        } else if (p == 22) {
+            attrs &= ~(SGR_BOLD | SGR_DIM);
+        } else if (p == 3 || p == 23) {
+            attrs = p == 3 ? attrs | SGR_ITALIC : attrs & ~SGR_ITALIC;
+        } else if (p == 4 || p == 24) {
+            attrs = p == 4 ? attrs | SGR_UNDERLINE : attrs & ~SGR_UNDERLINE;
+        } else if (p == 5 || p == 25) {
+            attrs = p == 5 ? attrs | SGR_BLINK : attrs & ~SGR_BLINK;
+        } else if (p == 7 || p == 27) {
+            attrs = p == 7 ? attrs | SGR_REVERSE : attrs & ~SGR_REVERSE;
+        } else if ((p >= 30 && p <= 37) || (p >= 90 && p <= 97)) {
+            fg = p;
+        } else if (p == 39) {
+            fg = 0;
+        } else if ((p >= 40 && p <= 47) || (p >= 100 && p <= 107)) {
+            bg = p;
+        } else if (p == 49) {
+            bg = 0;
+        } else if (p == 38 || p == 48) {
+            break;      // Extended colour: its arguments are not codes
+        }
+    }
+    _sgr = attrs | ((uint32_t)fg << 8) | ((uint32_t)bg << 16);
+}
+
+// Reset followed by whatever sgr sets, as one sequence
+size_t ScreenModel::sgrSequence(uint32_t sgr, char* buf, size_t size) {
+    size_t n = snprintf(buf, size, "\033[0");
+    for (uint8_t i = 0; i < sizeof(SGR_CODES); i++) {
+        if (sgr & (1 << i)) n += snprintf(buf + n, size - n, ";%u", SGR_CODES[i]);
+    }
+    uint8_t fg = (sgr >> 8) & 0xFF;
+    uint8_t bg = (sgr >> 16) & 0xFF;
+    if (fg) n += snprintf(buf + n, size - n, ";%u", fg);
+    if (bg) n += snprintf(buf + n, size - n, ";%u", bg);
+    n += snprintf(buf + n, size - n, "m");
+    return n;
+}
+
+void ScreenModel::commitLine() {
+    bool tracked = _row < MAX_ROWS;
+    // Same bytes under different carried-in colours are a different row
+    uint32_t hash = (_hash ^ _rowSgr) * FNV_PRIME;
+    
+    if (_fullRedraw) {
+        // Sequential output, identical to a plain render
+        emit(_line, _len);
+        emit("\r\n");
+    } else if (!tracked || _rowHash[_row] != hash) {
+        // Changed row: address it and repaint with the attributes the
+        // rows above left in effect, as a full redraw would have them
+        char sgr[40];
+        cursorTo(_row);
+        emit(sgr, sgrSequence(_rowSgr, sgr, sizeof(sgr)));
+        emit(_line, _len);
+        emit(ANSI::RESET);
+        emit(ANSI::ERASE_EOL);
+    }
+    
+    if (tracked) _rowHash[_row] = hash;
+    if (_row < 255) _row++;
+    
+    _len = 0;
+    _hash = FNV_OFFSET;
+    _rowSgr = _sgr;
+}
+
+void ScreenModel::cursorTo(uint8_t row) {
+    char buf[12];
+    int n = snprintf(buf, sizeof(buf), "\033[%u;1H", row + 1);
+    emit(buf, n);
+}
+
+void ScreenModel::emit(const char* s) {
+    emit(s, strlen(s));
+}
+
+void ScreenModel::emit(const char* s, size_t len) {
+    _out.write((const uint8_t*)s, len);
+    _frameBytes += len;
+}
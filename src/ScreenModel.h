@@ -0,0 +1,73 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+
+// ============================================
+// Screen Model
+// Row-addressed damage tracking for the TUI
+// ============================================
+//
+// Render functions print a whole frame into the model as before. Each
+// completed line is hashed and compared with what is already on the
+// terminal in that row; only rows whose bytes changed are re-sent, using
+// cursor addressing. After invalidate() the next frame is a full redraw.
+//
+// Colours set on one row carry over into the next unless reset, so the
+// model follows the SGR sequences it is given: the attributes in effect
+// at the start of a row are part of its hash, and a repainted row starts
+// by setting them rather than from a bare reset.
+
+class ScreenModel : public Print {
+public:
+    explicit ScreenModel(Print& out) : _out(out) {}
+    
+    void invalidate() { _fullRedraw = true; }
+    bool isInvalid() const { return _fullRedraw; }
+    
+    void beginFrame();
+    void endFrame();
+    
+    // Account for lines printed below the frame outside of render()
+    void noteExternalLine();
+    
+    // Bytes sent to the terminal by the last frame
+    uint16_t lastFrameBytes() const { return _frameBytes; }
+    
+    size_t write(uint8_t c) override;
+    using Print::write;
+    
+private:
+    static const uint8_t MAX_ROWS = 48;
+    static const uint8_t LINE_MAX = 160;   // Bytes per line incl. ANSI codes
+    
+    Print& _out;
+    
+    uint32_t _rowHash[MAX_ROWS] = {};
+    uint8_t _rows = 0;           // Rows drawn by the previous frame
+    uint8_t _row = 0;            // Row being drawn
+    uint8_t _externalRows = 0;   // Lines printed below it since then
+    bool _fullRedraw = true;
+    
+    char _line[LINE_MAX];
+    uint8_t _len = 0;
+    uint32_t _hash = 0;
+    uint16_t _frameBytes = 0;
+    
+    // SGR (colour/attribute) state: attribute bits, foreground << 8,
+    // background << 16; 0 is the terminal default
+    static const uint8_t SGR_PARAMS = 8;
+    uint32_t _sgr = 0;           // As of the last byte written
+    uint32_t _rowSgr = 0;        // At the start of the row being drawn
+    uint8_t _esc = 0;            // Escape sequence parser state
+    uint8_t _params[SGR_PARAMS];
+    uint8_t _paramCount = 0;
+    
+    void commitLine();
+    void track(uint8_t c);
+    void applySgr();
+    static size_t sgrSequence(uint32_t sgr, char* buf, size_t size);
+    void cursorTo(uint8_t row);
+    void emit(const char* s);
+    void emit(const char* s, size_t len);
+};
@@ -1,28 +1,81 @@
 #include "SerialTUI.h"
 #include "WiFiAttacks.h"
+#include "EventLoop.h"
+#include "LiveTable.h"
+#include "APSelector.h"
+#include "CommandShell.h"
+#include "EventStream.h"
+#include "Transport.h"
 
 SerialTUI tui;
 
+static const unsigned long ESCAPE_TIMEOUT_MS = 50;
+
+// Single-line editor shared by the filter prompts
+enum class LineEdit : uint8_t {
+    IGNORED,
+    CHANGED,
+    DONE,       // Enter
+    CANCEL      // Esc
+};
+
+static LineEdit editLine(char c, char* buf, uint8_t& len, size_t size) {
+    if (c == 27) return LineEdit::CANCEL;
+    if (c == '\r' || c == '\n') return LineEdit::DONE;
+    if (c == 8 || c == 127) {
+        if (len == 0) return LineEdit::IGNORED;
+        buf[--len] = '\0';
+        return LineEdit::CHANGED;
+    }
+    if (c >= 32 && c <= 126 && len < size - 1) {
+        buf[len++] = c;
+        buf[len] = '\0';
+        return LineEdit::CHANGED;
+    }
+    return LineEdit::IGNORED;
+}
+
 void SerialTUI::begin() {
-    Serial.begin(SERIAL_BAUD);
-    while (!Serial) delay(10);
+    // Picks the boot link and wires its RX wake-ups (see Transport.h)
+    console.begin();
     
     // Initialize input buffer
     memset(_inputBuffer, 0, sizeof(_inputBuffer));
     _inputPos = 0;
+    _pagerFilter[0] = '\0';
+    _selFilter[0] = '\0';
+    _cmdLine[0] = '\0';
     _resultCount = 0;
-    _lastResultTime = 0;
+    _statusText[0] = '\0';
+    _statsText[0] = '\0';
     
     // Clear screen and show menu
-    Serial.print(ANSI::CLEAR_SCREEN);
-    Serial.print(ANSI::CURSOR_HOME);
-    Serial.print(ANSI::CURSOR_HIDE);
+    console.print(ANSI::CLEAR_SCREEN);
+    console.print(ANSI::CURSOR_HOME);
+    console.print(ANSI::CURSOR_HIDE);
     
+    _screen.invalidate();
     _needsRedraw = true;
 }
 
 void SerialTUI::update() {
+    // New link, new baud or a host that just connected: full repaint
+    console.update();
+    if (console.takeAttached()) {
+        _screen.invalidate();
+        _needsRedraw = true;
+        if (_scanning) {
+            beginLiveLayout();
+            if (liveTable.isActive()) liveTable.repaint();
+        }
+    }
+    
     handleInput();
+    drainResults();
+    
+    if (_scanning && _barDirty && millis() - _lastBarDraw >= STATUS_BAR_REFRESH_MS) {
+        drawStatusBar();
+    }
     
     if (_needsRedraw && !_scanning) {
         render();
@@ -30,52 +83,152 @@ void SerialTUI::update() {
     }
 }
 
+uint32_t SerialTUI::nextWakeMs() const {
+    if (console.available() || (_needsRedraw && !_scanning)) return 0;
+    
+    // Link housekeeping: buffered BLE packets, baud/link probation
+    uint32_t wake = console.nextWakeMs();
+    
+    // Results/stream records waiting on TX space, or a partial
+    // compressed block waiting for more
+    if (_results.pending() > 0 || eventStream.ready()) {
+        wake = min(wake, (uint32_t)RESULT_RETRY_MS);
+    }
+    wake = min(wake, eventStream.nextWakeMs());
+    
+    if (_scanning && _barDirty) {
+        wake = min(wake, msUntil(_lastBarDraw, STATUS_BAR_REFRESH_MS, millis()));
+    }
+    
+    // Lone ESC resolves to "back" once the sequence times out
+    if (_escapeState > 0) {
+        wake = min(wake, msUntil(_lastEscapeTime, ESCAPE_TIMEOUT_MS + 1, millis()));
+    }
+    return wake;
+}
+
 void SerialTUI::setScanning(bool scanning) {
+    if (scanning == _scanning) return;
     _scanning = scanning;
-    if (!scanning) {
+    
+    // Scan output scrolls the terminal, so the next menu is a full redraw
+    _screen.invalidate();
+    
+    if (scanning) {
+        beginLiveLayout();
+    } else {
+        // Whatever is still queued goes out before the menu returns
+        ResultEntry entry;
+        while (_results.pop(entry)) writeResult(entry);
+        writeOverflowSummary();
+        endLiveLayout();
         _needsRedraw = true;
         _resultCount = 0;
-        Serial.print(ANSI::CURSOR_HIDE);
+        console.print(ANSI::CURSOR_HIDE);
     }
 }
 
-void SerialTUI::printResult(const char* result) {
-    // Output throttling - limit to one result per RESULT_THROTTLE_MS
-    unsigned long now = millis();
+void SerialTUI::printResult(const char* result, ResultKind kind, uint32_t key,
+                            const ResultMeta* meta) {
+    if (!_scanning) {
+        // Menu-driven listings go straight out
+        ResultEntry entry;
+        entry.kind = kind;
+        entry.count = 1;
+        entry.time = millis();
+        entry.meta = meta ? *meta : ResultMeta();
+        strncpy(entry.text, result, sizeof(entry.text) - 1);
+        entry.text[sizeof(entry.text) - 1] = '\0';
+        writeResult(entry);
+        _screen.noteExternalLine();
+        return;
+    }
+    
+    // May run on a radio task: queue it and wake the main loop
     _resultCount++;
+    _barDirty = true;
+    _results.push(kind, result, key, meta);
+    events.post(EventType::ALERT);
+}
+
+void SerialTUI::drainResults() {
+    ResultEntry entry;
     
-    if (now - _lastResultTime < RESULT_THROTTLE_MS) {
-        // Throttled - just update counter display periodically
-        if (_resultCount % 10 == 0) {
-            Serial.print(ANSI::CLEAR_LINE);
-            Serial.print("\r");
-            Serial.print(ANSI::FG_YELLOW);
-            Serial.print("[~] Results: ");
-            Serial.print(_resultCount);
-            Serial.print(ANSI::RESET);
-        }
-        return;
+    // Structured records first; they are what a host is waiting on
+    if (eventStream.ready()) {
+        eventStream.drain(console, console.availableForWrite());
+    }
+    
+    // Only write what the TX buffer takes without blocking; while the link
+    // is saturated, repeats keep coalescing in the queue instead
+    while (console.availableForWrite() >= RESULT_LINE_BYTES && _results.pop(entry)) {
+        writeResult(entry);
     }
     
-    _lastResultTime = now;
-    Serial.print(ANSI::FG_GREEN);
-    Serial.print("[+] ");
-    Serial.print(ANSI::RESET);
-    Serial.println(result);
+    if (_results.pending() == 0 && console.availableForWrite() >= RESULT_LINE_BYTES) {
+        writeOverflowSummary();
+    }
+}
+
+void SerialTUI::writeOverflowSummary() {
+    char summary[RESULT_TEXT_LEN + 32];
+    if (_results.takeOverflowSummary(summary, sizeof(summary))) {
+        console.print(ANSI::FG_YELLOW);
+        console.print("[~] Coalesced: ");
+        console.print(ANSI::RESET);
+        console.println(summary);
+    }
+}
+
+void SerialTUI::writeResult(const ResultEntry& entry) {
+    _history.add(entry);
+    
+    // In JSON/binary mode the stream carries results; keep the link clean
+    if (eventStream.structured()) return;
+    
+    console.print(ANSI::FG_GREEN);
+    console.print("[+] ");
+    console.print(ANSI::RESET);
+    console.print(entry.text);
+    if (entry.count > 1) {
+        console.print(ANSI::FG_YELLOW);
+        console.printf(" x%u", entry.count);
+        console.print(ANSI::RESET);
+    }
+    console.println();
 }
 
 void SerialTUI::printStatus(const char* status) {
-    Serial.print(ANSI::FG_CYAN);
-    Serial.print("[*] ");
-    Serial.print(ANSI::RESET);
-    Serial.println(status);
+    // Remembered for the status bar of the next/current live run
+    strncpy(_statusText, status, sizeof(_statusText) - 1);
+    _statusText[sizeof(_statusText) - 1] = '\0';
+    
+    if (_scanning) {
+        // Update the pinned bar in place instead of scrolling, at the
+        // bar's own rate; update() repaints it
+        _barDirty = true;
+        return;
+    }
+    
+    console.print(ANSI::FG_CYAN);
+    console.print("[*] ");
+    console.print(ANSI::RESET);
+    console.println(status);
+    _screen.noteExternalLine();
 }
 
 void SerialTUI::printError(const char* error) {
-    Serial.print(ANSI::FG_RED);
-    Serial.print("[!] ");
-    Serial.print(ANSI::RESET);
-    Serial.println(error);
+    console.print(ANSI::FG_RED);
+    console.print("[!] ");
+    console.print(ANSI::RESET);
+    console.println(error);
+    if (!_scanning) _screen.noteExternalLine();
+}
+
+void SerialTUI::setStats(const char* stats) {
+    strncpy(_statsText, stats, sizeof(_statsText) - 1);
+    _statsText[sizeof(_statsText) - 1] = '\0';
+    _barDirty = true;
 }
 
 MenuAction SerialTUI::getPendingAction() {
@@ -92,6 +245,10 @@ void SerialTUI::clearPendingAction() {
 
 void SerialTUI::enterAPSelectionMode() {
     _inputMode = InputMode::SELECT_AP;
+    _selDigitLen = 0;
+    _selTyping = false;
+    _selPage = 0;
+    apSelector.refresh();
     _needsRedraw = true;
 }
 
@@ -103,19 +260,98 @@ void SerialTUI::enterTextInputMode(const char* prompt) {
     _needsRedraw = true;
 }
 
+void SerialTUI::enterPagerMode() {
+    _inputMode = InputMode::PAGER;
+    _pagerTyping = false;
+    pagerToEnd();
+    _needsRedraw = true;
+}
+
+void SerialTUI::enterCommandMode() {
+    _inputMode = InputMode::COMMAND;
+    _cmdLen = 0;
+    _cmdLine[0] = '\0';
+    _needsRedraw = true;
+}
+
 void SerialTUI::exitInputMode() {
     _inputMode = InputMode::MENU;
     _inputPrompt = nullptr;
     _needsRedraw = true;
 }
 
+// ============================================
+// Live-Run Layout
+// ============================================
+// Rows 1..STATUS_BAR_ROWS hold the status bar; results scroll below it
+// inside a DECSTBM scroll region, so the bar never scrolls away.
+
+void SerialTUI::beginLiveLayout() {
+    _resultCount = 0;
+    _results.clear();
+    _statsText[0] = '\0';
+    _scanStart = millis();
+    
+    console.print(ANSI::CLEAR_SCREEN);
+    console.printf("\033[%u;r", STATUS_BAR_ROWS + 1);   // Scroll region below bar
+    console.printf("\033[%u;1H", STATUS_BAR_ROWS + 1);  // Cursor into region
+    drawStatusBar();
+}
+
+void SerialTUI::endLiveLayout() {
+    console.print(ANSI::RESET_SCROLL_REGION);
+    _statsText[0] = '\0';
+    _barDirty = false;
+}
+
+void SerialTUI::drawStatusBar() {
+    unsigned long now = millis();
+    
+    console.print(ANSI::SAVE_CURSOR);
+    console.print(ANSI::AUTOWRAP_OFF);  // Long lines clip instead of wrapping
+    
+    // Row 1: current status
+    console.print(ANSI::CURSOR_HOME);
+    console.print(ANSI::CLEAR_LINE);
+    console.print(ANSI::FG_CYAN);
+    console.print("[*] ");
+    console.print(ANSI::RESET);
+    console.print(_statusText);
+    
+    // Row 2: counters
+    console.print("\033[2;1H");
+    console.print(ANSI::CLEAR_LINE);
+    console.print(ANSI::FG_YELLOW);
+    console.printf("[~] Results: %lu (%lu merged, %u queued) | %lus",
+                  (unsigned long)_resultCount, (unsigned long)_results.mergedTotal(),
+                  _results.pending(), (now - _scanStart) / 1000);
+    if (_statsText[0]) {
+        console.print(" | ");
+        console.print(_statsText);
+    }
+    console.print(ANSI::RESET);
+    
+    // Row 3: separator
+    console.print("\033[3;1H");
+    console.print(ANSI::FG_GRAY);
+    for (uint8_t i = 0; i < TUI_WIDTH; i++) console.print('-');
+    console.print(ANSI::RESET);
+    
+    console.print(ANSI::AUTOWRAP_ON);
+    console.print(ANSI::RESTORE_CURSOR);
+    
+    _barDirty = false;
+    _lastBarDraw = now;
+}
+
 // ============================================
 // Rendering
 // ============================================
 
 void SerialTUI::render() {
-    Serial.print(ANSI::CLEAR_SCREEN);
-    Serial.print(ANSI::CURSOR_HOME);
+    // The frame is always rendered in full; the screen model only sends
+    // rows that differ from what the terminal already shows
+    _screen.beginFrame();
     
     renderHeader();
     
@@ -126,263 +362,370 @@ void SerialTUI::render() {
         case InputMode::INPUT_TEXT:
             renderTextInput();
             break;
+        case InputMode::PAGER:
+            renderPager();
+            break;
         default:
             renderMenu();
             break;
     }
     
     renderFooter();
+    _screen.endFrame();
 }
 
 void SerialTUI::renderHeader() {
     // Top border
-    Serial.print(ANSI::FG_GRAY);
-    Serial.println("========================================");
-    Serial.print(ANSI::RESET);
+    _screen.print(ANSI::FG_GRAY);
+    _screen.println("========================================");
+    _screen.print(ANSI::RESET);
     
     // PICO   32 ASCII Art
     // Width: 13(PICO) + 3(gap) + 7(32) = 23 chars
     // Center: (40-23)/2 = 8 spaces padding
-    Serial.print(ANSI::BOLD);
+    _screen.print(ANSI::BOLD);
     
     // Line 1
-    Serial.print("        ");
-    Serial.print(ANSI::FG_MAGENTA);
-    Serial.print("### ");
-    Serial.print(ANSI::FG_YELLOW);
-    Serial.print("# ");
-    Serial.print(ANSI::FG_GREEN);
-    Serial.print("### ");
-    Serial.print(ANSI::FG_CYAN);
-    Serial.print("###   "); // Extra spaces after O
-    Serial.print(ANSI::FG_RED);
-    Serial.println("### ###");
+    _screen.print("        ");
+    _screen.print(ANSI::FG_MAGENTA);
+    _screen.print("### ");
+    _screen.print(ANSI::FG_YELLOW);
+    _screen.print("# ");
+    _screen.print(ANSI::FG_GREEN);
+    _screen.print("### ");
+    _screen.print(ANSI::FG_CYAN);
+    _screen.print("###   "); // Extra spaces after O
+    _screen.print(ANSI::FG_RED);
+    _screen.println("### ###");
     
     // Line 2
-    Serial.print("        ");
-    Serial.print(ANSI::FG_MAGENTA);
-    Serial.print("# # ");
-    Serial.print(ANSI::FG_YELLOW);
-    Serial.print("# ");
-    Serial.print(ANSI::FG_GREEN);
-    Serial.print("#   ");
-    Serial.print(ANSI::FG_CYAN);
-    Serial.print("# #   ");
-    Serial.print(ANSI::FG_RED);
-    Serial.println("  #   #");
+    _screen.print("        ");
+    _screen.print(ANSI::FG_MAGENTA);
+    _screen.print("# # ");
+    _screen.print(ANSI::FG_YELLOW);
+    _screen.print("# ");
+    _screen.print(ANSI::FG_GREEN);
+    _screen.print("#   ");
+    _screen.print(ANSI::FG_CYAN);
+    _screen.print("# #   ");
+    _screen.print(ANSI::FG_RED);
+    _screen.println("  #   #");
     
     // Line 3
-    Serial.print("        ");
-    Serial.print(ANSI::FG_MAGENTA);
-    Serial.print("### ");
-    Serial.print(ANSI::FG_YELLOW);
-    Serial.print("# ");
-    Serial.print(ANSI::FG_GREEN);
-    Serial.print("#   ");
-    Serial.print(ANSI::FG_CYAN);
-    Serial.print("# #   ");
-    Serial.print(ANSI::FG_RED);
-    Serial.println("### ###");
+    _screen.print("        ");
+    _screen.print(ANSI::FG_MAGENTA);
+    _screen.print("### ");
+    _screen.print(ANSI::FG_YELLOW);
+    _screen.print("# ");
+    _screen.print(ANSI::FG_GREEN);
+    _screen.print("#   ");
+    _screen.print(ANSI::FG_CYAN);
+    _screen.print("# #   ");
+    _screen.print(ANSI::FG_RED);
+    _screen.println("### ###");
     
     // Line 4
-    Serial.print("        ");
-    Serial.print(ANSI::FG_MAGENTA);
-    Serial.print("#   ");
-    Serial.print(ANSI::FG_YELLOW);
-    Serial.print("# ");
-    Serial.print(ANSI::FG_GREEN);
-    Serial.print("#   ");
-    Serial.print(ANSI::FG_CYAN);
-    Serial.print("# #   ");
-    Serial.print(ANSI::FG_RED);
-    Serial.println("  # #  ");
+    _screen.print("        ");
+    _screen.print(ANSI::FG_MAGENTA);
+    _screen.print("#   ");
+    _screen.print(ANSI::FG_YELLOW);
+    _screen.print("# ");
+    _screen.print(ANSI::FG_GREEN);
+    _screen.print("#   ");
+    _screen.print(ANSI::FG_CYAN);
+    _screen.print("# #   ");
+    _screen.print(ANSI::FG_RED);
+    _screen.println("  # #  ");
     
     // Line 5
-    Serial.print("        ");
-    Serial.print(ANSI::FG_MAGENTA);
-    Serial.print("#   ");
-    Serial.print(ANSI::FG_YELLOW);
-    Serial.print("# ");
-    Serial.print(ANSI::FG_GREEN);
-    Serial.print("### ");
-    Serial.print(ANSI::FG_CYAN);
-    Serial.print("###   ");
-    Serial.print(ANSI::FG_RED);
-    Serial.println("### ###");
-    
-    Serial.print(ANSI::RESET);
+    _screen.print("        ");
+    _screen.print(ANSI::FG_MAGENTA);
+    _screen.print("#   ");
+    _screen.print(ANSI::FG_YELLOW);
+    _screen.print("# ");
+    _screen.print(ANSI::FG_GREEN);
+    _screen.print("### ");
+    _screen.print(ANSI::FG_CYAN);
+    _screen.print("###   ");
+    _screen.print(ANSI::FG_RED);
+    _screen.println("### ###");
+    
+    _screen.print(ANSI::RESET);
     
     // Version subtitle - centered
-    Serial.print(ANSI::FG_WHITE);
-    Serial.print("         v");
-    Serial.print(VERSION);
-    Serial.print(ANSI::FG_GRAY);
-    Serial.println(" | WiFi/BT Toolkit");
-    Serial.print(ANSI::RESET);
+    _screen.print(ANSI::FG_WHITE);
+    _screen.print("         v");
+    _screen.print(VERSION);
+    _screen.print(ANSI::FG_GRAY);
+    _screen.println(" | WiFi/BT Toolkit");
+    _screen.print(ANSI::RESET);
     
     // Bottom border
-    Serial.print(ANSI::FG_GRAY);
-    Serial.println("========================================");
-    Serial.print(ANSI::RESET);
-    Serial.println();
+    _screen.print(ANSI::FG_GRAY);
+    _screen.println("========================================");
+    _screen.print(ANSI::RESET);
+    _screen.println();
 }
 
 void SerialTUI::renderMenu() {
     for (uint8_t i = 0; i < _currentMenuSize; i++) {
         if (i == _selectedIndex) {
             // Highlighted item
-            Serial.print(ANSI::HIGHLIGHT);
-            Serial.print(ANSI::FG_CYAN);
-            Serial.print(" > ");
+            _screen.print(ANSI::HIGHLIGHT);
+            _screen.print(ANSI::FG_CYAN);
+            _screen.print(" > ");
         } else {
-            Serial.print("   ");
+            _screen.print("   ");
         }
         
         // Color based on item type
         if (_currentMenu[i].action == MenuAction::BACK) {
-            Serial.print(ANSI::FG_GRAY);
+            _screen.print(ANSI::FG_GRAY);
         } else if (_currentMenu[i].submenu != nullptr) {
-            Serial.print(ANSI::FG_WHITE);
+            _screen.print(ANSI::FG_WHITE);
         } else if (_currentMenu[i].action >= MenuAction::WIFI_ATTACK_DEAUTH && 
                    _currentMenu[i].action <= MenuAction::WIFI_ATTACK_FUNNY) {
-            Serial.print(ANSI::FG_RED);
+            _screen.print(ANSI::FG_RED);
         } else if (_currentMenu[i].action >= MenuAction::BT_SPAM_APPLE && 
                    _currentMenu[i].action <= MenuAction::BT_SPAM_ALL) {
-            Serial.print(ANSI::FG_RED);
+            _screen.print(ANSI::FG_RED);
         }
         
-        Serial.print(_currentMenu[i].label);
-        Serial.print(ANSI::RESET);
-        Serial.println();
+        _screen.print(_currentMenu[i].label);
+        _screen.print(ANSI::RESET);
+        _screen.println();
     }
-    Serial.println();
+    _screen.println();
 }
 
 void SerialTUI::renderAPSelection() {
-    Serial.print(ANSI::FG_YELLOW);
-    Serial.print(ANSI::BOLD);
-    Serial.println("=== SELECT ACCESS POINTS ===");
-    Serial.print(ANSI::RESET);
-    Serial.println();
+    _screen.print(ANSI::FG_YELLOW);
+    _screen.print(ANSI::BOLD);
+    _screen.println("=== SELECT ACCESS POINTS ===");
+    _screen.print(ANSI::RESET);
     
     auto* aps = wifiAttacks.getAPs();
+    uint8_t total = aps->size();
+    uint8_t shown = apSelector.viewSize();
+    uint8_t pages = shown ? (shown + SELECT_ROWS - 1) / SELECT_ROWS : 1;
+    if (_selPage >= pages) _selPage = pages - 1;
     
-    if (aps->size() == 0) {
-        Serial.print(ANSI::FG_GRAY);
-        Serial.println("No APs found. Scan first!");
-        Serial.print(ANSI::RESET);
-    } else {
-        // Count selected
-        int selectedCount = 0;
-        for (int i = 0; i < aps->size(); i++) {
-            if (aps->get(i).selected) selectedCount++;
-        }
-        
-        Serial.print(ANSI::FG_CYAN);
-        Serial.print("Selected: ");
-        Serial.print(selectedCount);
-        Serial.print("/");
-        Serial.println(aps->size());
-        Serial.print(ANSI::RESET);
-        Serial.println();
-        
-        // Show up to 10 APs (limited by single digit keys)
-        int maxShow = min(10, aps->size());
-        for (int i = 0; i < maxShow; i++) {
-            AccessPoint ap = aps->get(i);
-            
-            // Selection marker
-            if (ap.selected) {
-                Serial.print(ANSI::FG_GREEN);
-                Serial.print("[*] ");
-            } else {
-                Serial.print(ANSI::FG_GRAY);
-                Serial.print("[ ] ");
-            }
-            
-            // Key number
-            Serial.print(ANSI::FG_YELLOW);
-            Serial.print(i);
-            Serial.print(": ");
-            Serial.print(ANSI::RESET);
-            
-            // SSID with color based on selection
-            if (ap.selected) {
-                Serial.print(ANSI::FG_GREEN);
-            }
-            Serial.print(ap.essid.c_str());
-            Serial.print(ANSI::FG_GRAY);
-            Serial.print(" [Ch:");
-            Serial.print(ap.channel);
-            Serial.print("] ");
-            Serial.print(ap.rssi);
-            Serial.println("dBm");
-            Serial.print(ANSI::RESET);
-        }
+    // Count selected
+    int selectedCount = 0;
+    for (int i = 0; i < total; i++) {
+        if (aps->get(i).selected) selectedCount++;
+    }
+    
+    char buf[TUI_WIDTH + 8];
+    snprintf(buf, sizeof(buf), "Selected: %d/%u | %s | p%u/%u",
+             selectedCount, total, APSelector::sortName(apSelector.sort()), _selPage + 1, pages);
+    _screen.print(ANSI::FG_CYAN);
+    _screen.println(buf);
+    
+    // Prompt line: filter being typed, index being typed, or active filter
+    if (_selTyping) {
+        _screen.print("Filter: ");
+        _screen.print(ANSI::FG_WHITE);
+        _screen.print(_selFilter);
+        _screen.print("_");
+    } else if (_selDigitLen > 0) {
+        _screen.print("Toggle #");
+        _screen.print(ANSI::FG_WHITE);
+        _screen.print(_selDigits);
+        _screen.print("_");
+    } else if (_selFilterBad) {
+        _screen.print(ANSI::FG_RED);
+        _screen.print("Bad filter: ");
+        _screen.print(_selFilter);
+    } else if (apSelector.filter()[0]) {
+        _screen.print(ANSI::FG_GRAY);
+        snprintf(buf, sizeof(buf), "Filter: %s (%u match)", apSelector.filter(), shown);
+        _screen.print(buf);
+    }
+    _screen.print(ANSI::RESET);
+    _screen.println();
+    _screen.println();
+    
+    if (total == 0) {
+        _screen.print(ANSI::FG_GRAY);
+        _screen.println("No APs found. Scan first!");
+        _screen.print(ANSI::RESET);
+    } else if (shown == 0) {
+        _screen.print(ANSI::FG_GRAY);
+        _screen.println("No APs match the filter.");
+        _screen.print(ANSI::RESET);
+    }
+    
+    // Current page; the number is the AP's table index, stable across
+    // sorting and filtering
+    for (uint8_t pos = _selPage * SELECT_ROWS; pos < shown && pos < (_selPage + 1) * SELECT_ROWS; pos++) {
+        uint8_t idx = apSelector.viewAt(pos);
+        bool selected = aps->get(idx).selected;
+        const char* essid = apSelector.essid(idx);
         
-        if (aps->size() > 10) {
-            Serial.print(ANSI::FG_GRAY);
-            Serial.print("... and ");
-            Serial.print(aps->size() - 10);
-            Serial.println(" more (not selectable)");
-            Serial.print(ANSI::RESET);
-        }
+        _screen.print(selected ? ANSI::FG_GREEN : ANSI::FG_GRAY);
+        _screen.print(selected ? "[*] " : "[ ] ");
+        _screen.print(ANSI::FG_YELLOW);
+        snprintf(buf, sizeof(buf), "%2u ", idx);
+        _screen.print(buf);
+        _screen.print(selected ? ANSI::FG_GREEN : ANSI::RESET);
+        snprintf(buf, sizeof(buf), "%-22.22s", essid[0] ? essid : "<hidden>");
+        _screen.print(buf);
+        _screen.print(ANSI::FG_GRAY);
+        snprintf(buf, sizeof(buf), " %2u %4d", apSelector.channel(idx), apSelector.rssi(idx));
+        _screen.print(buf);
+        _screen.print(ANSI::RESET);
+        _screen.println();
     }
-    Serial.println();
+    _screen.println();
 }
 
 void SerialTUI::renderTextInput() {
-    Serial.print(ANSI::FG_YELLOW);
-    Serial.print(ANSI::BOLD);
-    Serial.println("=== ENTER SSID ===");
-    Serial.print(ANSI::RESET);
-    Serial.println();
+    _screen.print(ANSI::FG_YELLOW);
+    _screen.print(ANSI::BOLD);
+    _screen.println("=== ENTER SSID ===");
+    _screen.print(ANSI::RESET);
+    _screen.println();
     
     if (_inputPrompt) {
-        Serial.println(_inputPrompt);
-        Serial.println();
+        _screen.println(_inputPrompt);
+        _screen.println();
     }
     
     // Show input field
-    Serial.print(ANSI::FG_CYAN);
-    Serial.print("> ");
-    Serial.print(ANSI::RESET);
-    Serial.print(ANSI::FG_WHITE);
-    Serial.print(_inputBuffer);
-    Serial.print(ANSI::CURSOR_SHOW);  // Show cursor in input mode
-    Serial.print("_");  // Visual cursor
-    Serial.print(ANSI::RESET);
-    Serial.println();
-    Serial.println();
-    
-    Serial.print(ANSI::FG_GRAY);
-    Serial.print("(");
-    Serial.print(_inputPos);
-    Serial.println("/32 chars)");
-    Serial.print(ANSI::RESET);
-    Serial.println();
+    _screen.print(ANSI::FG_CYAN);
+    _screen.print("> ");
+    _screen.print(ANSI::RESET);
+    _screen.print(ANSI::FG_WHITE);
+    _screen.print(_inputBuffer);
+    _screen.print(ANSI::CURSOR_SHOW);  // Show cursor in input mode
+    _screen.print("_");  // Visual cursor
+    _screen.print(ANSI::RESET);
+    _screen.println();
+    _screen.println();
+    
+    _screen.print(ANSI::FG_GRAY);
+    _screen.print("(");
+    _screen.print(_inputPos);
+    _screen.println("/32 chars)");
+    _screen.print(ANSI::RESET);
+    _screen.println();
+}
+
+void SerialTUI::renderPager() {
+    _screen.print(ANSI::FG_YELLOW);
+    _screen.print(ANSI::BOLD);
+    _screen.println("=== RESULT HISTORY ===");
+    _screen.print(ANSI::RESET);
+    
+    uint8_t matches = pagerMatchCount();
+    
+    // Position / filter line
+    _screen.print(ANSI::FG_CYAN);
+    if (_pagerTyping) {
+        _screen.print("Filter: ");
+        _screen.print(ANSI::FG_WHITE);
+        _screen.print(_pagerFilter);
+        _screen.print("_");
+    } else {
+        char buf[TUI_WIDTH + 1];
+        snprintf(buf, sizeof(buf), "%u-%u of %u",
+                 matches ? _pagerTop + 1 : 0, min<uint8_t>(_pagerTop + PAGER_ROWS, matches), matches);
+        _screen.print(buf);
+        if (_pagerFilterLen > 0) {
+            _screen.print(ANSI::FG_GRAY);
+            _screen.print(" /");
+            _screen.print(_pagerFilter);
+        }
+    }
+    _screen.print(ANSI::RESET);
+    _screen.println();
+    _screen.println();
+    
+    if (_history.size() == 0) {
+        _screen.print(ANSI::FG_GRAY);
+        _screen.println("No results yet. Run a scan first!");
+        _screen.print(ANSI::RESET);
+    }
+    
+    // Visible window, one terminal row per record (re-print shows full text)
+    uint8_t match = 0;
+    uint8_t shown = 0;
+    for (uint8_t i = 0; i < _history.size() && shown < PAGER_ROWS; i++) {
+        const ResultEntry& e = _history.at(i);
+        if (!ResultHistory::matches(e, _pagerFilter)) continue;
+        if (match++ < _pagerTop) continue;
+        
+        char suffix[8] = "";
+        if (e.count > 1) snprintf(suffix, sizeof(suffix), " x%u", e.count);
+        int room = TUI_WIDTH - 6 - strlen(suffix);
+        
+        char buf[TUI_WIDTH + 8];
+        uint32_t secs = e.time / 1000;
+        snprintf(buf, sizeof(buf), "%02lu:%02lu ", (unsigned long)(secs / 60 % 100), (unsigned long)(secs % 60));
+        _screen.print(ANSI::FG_GRAY);
+        _screen.print(buf);
+        _screen.print(ANSI::RESET);
+        if (ResultQueue::priorityOf(e.kind) == ResultPriority::HIGH) {
+            _screen.print(ANSI::FG_YELLOW);
+        }
+        snprintf(buf, sizeof(buf), "%.*s", room, e.text);
+        _screen.print(buf);
+        _screen.print(ANSI::FG_GRAY);
+        _screen.print(suffix);
+        _screen.print(ANSI::RESET);
+        _screen.println();
+        shown++;
+    }
+    _screen.println();
 }
 
 void SerialTUI::renderFooter() {
-    Serial.print(ANSI::FG_GRAY);
-    Serial.println("----------------------------------------");
+    _screen.print(ANSI::FG_GRAY);
+    _screen.println("----------------------------------------");
     
     switch (_inputMode) {
         case InputMode::SELECT_AP:
-            Serial.println(" [0-9] Toggle AP    [A] Select All");
-            Serial.println(" [N] Select None    [Enter/Q] Done");
+            if (_selTyping) {
+                _screen.println(" abc ^abc ch=6 rssi>-70 (space = and)");
+                _screen.println(" [Enter] Apply     [Esc] Cancel");
+            } else {
+                _screen.println(" [0-9] Toggle #  [A/N] All/None shown");
+                _screen.println(" [W/S] Page [O] Sort [/] Filter [Q]");
+            }
             break;
         case InputMode::INPUT_TEXT:
-            Serial.println(" Type SSID name (max 32 chars)");
-            Serial.println(" [Enter] Confirm   [Esc] Cancel");
+            _screen.println(" Type SSID name (max 32 chars)");
+            _screen.println(" [Enter] Confirm   [Esc] Cancel");
+            break;
+        case InputMode::COMMAND:
+            {
+                // Show the tail of long lines
+                const char* shown = _cmdLine + (_cmdLen > TUI_WIDTH - 3 ? _cmdLen - (TUI_WIDTH - 3) : 0);
+                _screen.print(ANSI::FG_WHITE);
+                _screen.print(":");
+                _screen.print(shown);
+                _screen.println("_");
+                _screen.print(ANSI::FG_GRAY);
+                _screen.println(" [Enter] Run  [Esc] Cancel  (try help)");
+            }
+            break;
+        case InputMode::PAGER:
+            if (_pagerTyping) {
+                _screen.println(" Matches text or kind (e.g. deauth)");
+                _screen.println(" [Enter] Apply     [Esc] Cancel");
+            } else {
+                _screen.println(" [W/S] Scroll [A/D] Page [/] Filter");
+                _screen.println(" [P] Print [C] Clear  [Enter/Q] Done");
+            }
             break;
         default:
-            Serial.println(" [W/S] or [Arrows] Navigate");
-            Serial.println(" [Enter] Select    [Q/Esc] Back");
+            _screen.println(" [W/S] or [Arrows] Navigate");
+            _screen.println(" [Enter] Select    [Q/Esc] Back");
             break;
     }
     
-    Serial.print(ANSI::RESET);
+    _screen.print(ANSI::RESET);
 }
 
 // ============================================
@@ -390,12 +733,13 @@ void SerialTUI::renderFooter() {
 // ============================================
 
 void SerialTUI::handleInput() {
-    while (Serial.available()) {
-        char c = Serial.read();
+    while (console.available()) {
+        char c = console.read();
         
-        // During scanning, any key stops
+        // During scanning, any key stops (live view keeps its sort keys)
         if (_scanning) {
-            _pendingAction = MenuAction::BACK;  // Signal to stop
+            if (liveTable.handleKey(c)) continue;
+            events.post(EventType::STOP);
             return;
         }
         
@@ -406,6 +750,13 @@ void SerialTUI::handleInput() {
         } else if (_inputMode == InputMode::INPUT_TEXT) {
             handleTextInput(c);
             return;
+        } else if (_inputMode == InputMode::PAGER) {
+            handlePagerInput(c);
+            return;
+        } else if (_inputMode == InputMode::COMMAND) {
+            // Take the whole line in one go (scripts paste several)
+            handleCommandInput(c);
+            continue;
         }
         
         // Normal menu mode - escape sequence handling for arrow keys
@@ -430,54 +781,118 @@ void SerialTUI::handleInput() {
     }
     
     // Timeout escape sequence
-    if (_escapeState > 0 && millis() - _lastEscapeTime > 50) {
+    if (_escapeState > 0 && millis() - _lastEscapeTime > ESCAPE_TIMEOUT_MS) {
         if (_escapeState == 1) goBack();  // Just ESC
         _escapeState = 0;
     }
 }
 
 void SerialTUI::handleAPSelectionInput(char c) {
-    auto* aps = wifiAttacks.getAPs();
+    if (_selTyping) {
+        switch (editLine(c, _selFilter, _selFilterLen, sizeof(_selFilter))) {
+            case LineEdit::IGNORED:
+                return;
+            case LineEdit::CANCEL:
+                _selTyping = false;
+                _selFilterBad = false;
+                break;
+            case LineEdit::DONE:
+                _selTyping = false;
+                _selFilterBad = !apSelector.setFilter(_selFilter);
+                _selPage = 0;
+                break;
+            default:
+                break;
+        }
+        _needsRedraw = true;
+        return;
+    }
     
-    // Handle number keys 0-9
+    // Table index, possibly several digits
     if (c >= '0' && c <= '9') {
-        int idx = c - '0';
-        if (idx < aps->size()) {
-            AccessPoint ap = aps->get(idx);
-            wifiAttacks.selectAP(idx, !ap.selected);  // Toggle
-            _needsRedraw = true;
+        if (_selDigitLen < sizeof(_selDigits) - 1) {
+            _selDigits[_selDigitLen++] = c;
+            _selDigits[_selDigitLen] = '\0';
+        }
+        // Commit as soon as no further digit could name a valid AP
+        if (atoi(_selDigits) * 10 >= wifiAttacks.getAPs()->size()) {
+            commitAPIndex();
         }
+        _needsRedraw = true;
         return;
     }
     
     switch (c) {
+        case 8:
+        case 127:
+            if (_selDigitLen > 0) _selDigits[--_selDigitLen] = '\0';
+            break;
+            
         case 'a':
         case 'A':
-            // Select all
-            for (int i = 0; i < aps->size(); i++) {
-                wifiAttacks.selectAP(i, true);
-            }
-            _needsRedraw = true;
+            // Select everything passing the filter
+            apSelector.selectView(true);
             break;
             
         case 'n':
         case 'N':
-            // Deselect all
-            for (int i = 0; i < aps->size(); i++) {
-                wifiAttacks.selectAP(i, false);
-            }
-            _needsRedraw = true;
+            apSelector.selectView(false);
+            break;
+            
+        case 'w':
+        case 'W':
+            if (_selPage > 0) _selPage--;
+            break;
+            
+        case 's':
+        case 'S':
+            if ((_selPage + 1) * SELECT_ROWS < apSelector.viewSize()) _selPage++;
+            break;
+            
+        case 'o':
+        case 'O':
+            apSelector.cycleSort();
+            _selPage = 0;
+            break;
+            
+        case '/':
+            // Edit the current filter
+            strncpy(_selFilter, apSelector.filter(), sizeof(_selFilter) - 1);
+            _selFilter[sizeof(_selFilter) - 1] = '\0';
+            _selFilterLen = strlen(_selFilter);
+            _selTyping = true;
             break;
             
         case '\r':
         case '\n':
+            if (_selDigitLen > 0) {
+                commitAPIndex();
+                break;
+            }
+            exitInputMode();
+            return;
+            
         case 'q':
         case 'Q':
         case 27:  // ESC
             // Done - exit selection mode
             exitInputMode();
-            break;
+            return;
+            
+        default:
+            return;
     }
+    _needsRedraw = true;
+}
+
+void SerialTUI::commitAPIndex() {
+    auto* aps = wifiAttacks.getAPs();
+    int idx = atoi(_selDigits);
+    if (idx < aps->size()) {
+        wifiAttacks.selectAP(idx, !aps->get(idx).selected);  // Toggle
+    }
+    _selDigitLen = 0;
+    _selDigits[0] = '\0';
 }
 
 void SerialTUI::handleTextInput(char c) {
@@ -517,6 +932,148 @@ void SerialTUI::handleTextInput(char c) {
     }
 }
 
+void SerialTUI::handlePagerInput(char c) {
+    if (_pagerTyping) {
+        switch (editLine(c, _pagerFilter, _pagerFilterLen, sizeof(_pagerFilter))) {
+            case LineEdit::IGNORED:
+                return;
+            case LineEdit::CANCEL:
+                // Drop the filter entirely
+                _pagerFilterLen = 0;
+                _pagerFilter[0] = '\0';
+                _pagerTyping = false;
+                break;
+            case LineEdit::DONE:
+                _pagerTyping = false;
+                break;
+            default:
+                break;
+        }
+        pagerToEnd();
+        _needsRedraw = true;
+        return;
+    }
+    
+    uint8_t matches = pagerMatchCount();
+    uint8_t last = matches > PAGER_ROWS ? matches - PAGER_ROWS : 0;
+    
+    switch (c) {
+        case 'w':
+        case 'W':
+            if (_pagerTop > 0) _pagerTop--;
+            break;
+            
+        case 's':
+        case 'S':
+            if (_pagerTop < last) _pagerTop++;
+            break;
+            
+        case 'a':
+        case 'A':
+            _pagerTop = _pagerTop > PAGER_ROWS ? _pagerTop - PAGER_ROWS : 0;
+            break;
+            
+        case 'd':
+        case 'D':
+            _pagerTop = min<uint8_t>(_pagerTop + PAGER_ROWS, last);
+            break;
+            
+        case '/':
+            _pagerTyping = true;
+            break;
+            
+        case 'c':
+        case 'C':
+            _pagerFilterLen = 0;
+            _pagerFilter[0] = '\0';
+            pagerToEnd();
+            break;
+            
+        case 'p':
+        case 'P':
+            reprintHistory();
+            return;
+            
+        case '\r':
+        case '\n':
+        case 'q':
+        case 'Q':
+        case 27:  // ESC
+            exitInputMode();
+            return;
+            
+        default:
+            // Any other key brings the pager back after a re-print
+            break;
+    }
+    _needsRedraw = true;
+}
+
+uint8_t SerialTUI::pagerMatchCount() const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < _history.size(); i++) {
+        if (ResultHistory::matches(_history.at(i), _pagerFilter)) n++;
+    }
+    return n;
+}
+
+void SerialTUI::pagerToEnd() {
+    // Newest results are the interesting ones after a run
+    uint8_t matches = pagerMatchCount();
+    _pagerTop = matches > PAGER_ROWS ? matches - PAGER_ROWS : 0;
+}
+
+void SerialTUI::reprintHistory() {
+    // Full records as plain scrolling lines, for terminal scrollback/logging
+    uint8_t printed = 0;
+    for (uint8_t i = 0; i < _history.size(); i++) {
+        const ResultEntry& e = _history.at(i);
+        if (!ResultHistory::matches(e, _pagerFilter)) continue;
+        
+        const uint8_t* m = e.meta.mac;
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%lu.%03lu %-10s ch%-2u %4ddBm %02X:%02X:%02X:%02X:%02X:%02X ",
+                 (unsigned long)(e.time / 1000), (unsigned long)(e.time % 1000),
+                 ResultQueue::kindName(e.kind), e.meta.channel, e.meta.rssi,
+                 m[0], m[1], m[2], m[3], m[4], m[5]);
+        console.print(ANSI::FG_GRAY);
+        console.print(buf);
+        console.print(ANSI::RESET);
+        console.print(e.text);
+        if (e.count > 1) console.printf(" x%u", e.count);
+        console.println();
+        printed++;
+    }
+    
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%u of %lu results (press any key)",
+             printed, (unsigned long)_history.total());
+    console.print(ANSI::FG_CYAN);
+    console.print("[*] ");
+    console.print(ANSI::RESET);
+    console.println(buf);
+    
+    // The pager comes back on the next key, with a full redraw
+    _screen.invalidate();
+}
+
+void SerialTUI::handleCommandInput(char c) {
+    switch (editLine(c, _cmdLine, _cmdLen, sizeof(_cmdLine))) {
+        case LineEdit::IGNORED:
+            return;
+        case LineEdit::CANCEL:
+            exitInputMode();
+            return;
+        case LineEdit::DONE:
+            exitInputMode();
+            if (_cmdLen > 0) shell.submit(_cmdLine);
+            return;
+        default:
+            _needsRedraw = true;
+            return;
+    }
+}
+
 void SerialTUI::processKey(char key) {
     switch (key) {
         case 'w':
@@ -544,6 +1101,10 @@ void SerialTUI::processKey(char key) {
         case 'Q':
             goBack();
             break;
+            
+        case ':':
+            enterCommandMode();
+            break;
     }
 }
 
@@ -3,6 +3,10 @@
 #include <Arduino.h>
 #include "Config.h"
 #include "MenuDefs.h"
+#include "ScreenModel.h"
+#include "ResultQueue.h"
+#include "ResultHistory.h"
+#include "Transport.h"
 
 // ============================================
 // Serial TUI Engine
@@ -12,25 +16,35 @@
 // Input mode enum for different interaction types
 enum class InputMode : uint8_t {
     MENU,           // Normal menu navigation
-    SELECT_AP,      // Interactive AP selection (number keys toggle)
-    INPUT_TEXT      // Text entry mode (for SSID input)
+    SELECT_AP,      // Interactive AP selection (paged, sorted, filtered)
+    INPUT_TEXT,     // Text entry mode (for SSID input)
+    PAGER,          // Scroll/filter/re-print recent results
+    COMMAND         // ':' command line (see CommandShell)
 };
 
 class SerialTUI {
 public:
     void begin();
     void update();
+    uint32_t nextWakeMs() const;  // ms until update() has timed work due
     
     // State
     bool isActive() const { return _active; }
     bool isScanning() const { return _scanning; }
     void setScanning(bool scanning);
     
-    // Output during scans (with throttling)
-    void printResult(const char* result);
+    // Output during scans (queued and coalesced, safe from radio callbacks).
+    // key identifies the subject (e.g. BSSID) for merging repeats; 0 = text.
+    // meta carries the structured record kept in the result history.
+    void printResult(const char* result, ResultKind kind = ResultKind::INFO, uint32_t key = 0,
+                     const ResultMeta* meta = nullptr);
     void printStatus(const char* status);
     void printError(const char* error);
     
+    // Live-run statistics shown in the pinned status bar
+    void setStats(const char* stats);
+    uint8_t contentTopRow() const { return STATUS_BAR_ROWS + 1; }
+    
     // Get current action to execute
     MenuAction getPendingAction();
     void clearPendingAction();
@@ -38,6 +52,8 @@ public:
     // Interactive modes
     void enterAPSelectionMode();
     void enterTextInputMode(const char* prompt);
+    void enterPagerMode();
+    void enterCommandMode();
     bool isInInputMode() const { return _inputMode != InputMode::MENU; }
     const char* getInputBuffer() const { return _inputBuffer; }
     
@@ -72,10 +88,44 @@ private:
     uint8_t _escapeState = 0;
     unsigned long _lastEscapeTime = 0;
     
-    // Output throttling
-    unsigned long _lastResultTime = 0;
-    uint32_t _resultCount = 0;
-    static const unsigned long RESULT_THROTTLE_MS = 100;  // Min ms between results
+    // Differential renderer (tracks what is on the terminal)
+    ScreenModel _screen{console};
+    
+    // Result queue (drained by update() as the console link accepts output)
+    ResultQueue _results;
+    volatile uint32_t _resultCount = 0;
+    static const uint8_t RESULT_LINE_BYTES = RESULT_TEXT_LEN + 24;  // Text + prefix/ANSI
+    static const uint32_t RESULT_RETRY_MS = 5;  // Re-check TX space when backed up
+    
+    // Result pager (history survives the end of a live run)
+    ResultHistory _history;
+    char _pagerFilter[25];
+    uint8_t _pagerFilterLen = 0;
+    bool _pagerTyping = false;
+    uint8_t _pagerTop = 0;      // First visible match
+    static const uint8_t PAGER_ROWS = TUI_HEIGHT - 17;  // Rows left by header/footer
+    
+    // AP selection: typed table index, filter prompt, current page
+    char _selDigits[4];
+    uint8_t _selDigitLen = 0;
+    char _selFilter[25];
+    uint8_t _selFilterLen = 0;
+    bool _selTyping = false;
+    bool _selFilterBad = false;
+    uint8_t _selPage = 0;
+    static const uint8_t SELECT_ROWS = TUI_HEIGHT - 18;  // A full page ends a line short of the screen
+    
+    // Command line being typed
+    char _cmdLine[COMMAND_LINE_LEN];
+    uint8_t _cmdLen = 0;
+    
+    // Live-run layout: status bar pinned above a DECSTBM scroll region
+    static const uint8_t STATUS_BAR_ROWS = 3;
+    char _statusText[64];
+    char _statsText[64];
+    bool _barDirty = false;
+    unsigned long _lastBarDraw = 0;
+    unsigned long _scanStart = 0;
     
     // Methods
     void render();
@@ -84,9 +134,22 @@ private:
     void renderFooter();
     void renderAPSelection();
     void renderTextInput();
+    void renderPager();
+    void beginLiveLayout();
+    void endLiveLayout();
+    void drawStatusBar();
+    void drainResults();
+    void writeResult(const ResultEntry& entry);
+    void writeOverflowSummary();
     void handleInput();
     void handleAPSelectionInput(char c);
+    void commitAPIndex();
     void handleTextInput(char c);
+    void handlePagerInput(char c);
+    void handleCommandInput(char c);
+    uint8_t pagerMatchCount() const;
+    void pagerToEnd();
+    void reprintHistory();
     void processKey(char key);
     void processArrowKey(char direction);
     void selectItem();
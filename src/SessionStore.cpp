@@ -0,0 +1,299 @@
+/**
+ * ESP32 Marauder TUI - Session Store
+ *
+ * A full snapshot is a few KB (fixed-size records for at most MAX_APS +
+ * MAX_STATIONS + MAX_SSIDS entries), so it is rewritten whole rather
+ * than patched: one sequential write, checked by CRC and skipped when
+ * nothing changed, costs less flash wear than many small updates.
+ */
+
+#include "SessionStore.h"
+#include "WiFiAttacks.h"
+#include "APSelector.h"
+#include "EventStream.h"
+#include "EventLoop.h"
+#include <LittleFS.h>
+
+SessionStore session;
+
+static const char* const SESSION_TMP = SESSION_FILE ".tmp";
+
+bool SessionStore::begin() {
+    // min_spiffs.csv names its data partition "spiffs"
+    _mounted = LittleFS.begin(true, "/littlefs", 4, "spiffs");
+    return _mounted;
+}
+
+void SessionStore::markDirty() {
+    if (!_dirty) _dirtySince = millis();
+    _dirty = true;
+}
+
+// ============================================
+// Save
+// ============================================
+
+// Records into buf, at most SESSION_BODY_MAX; caller holds the table lock
+size_t SessionStore::packRecords(uint8_t* buf, SessionHeader& hdr) {
+    size_t pos = 0;
+    
+    auto* aps = wifiAttacks.getAPs();
+    hdr.apCount = min(aps->size(), MAX_APS);
+    for (int i = 0; i < hdr.apCount; i++) {
+        const AccessPoint& ap = aps->get(i);
+        SessionAP rec;
+        memset(&rec, 0, sizeof(rec));
+        memcpy(rec.bssid, ap.bssid, 6);
+        rec.channel = ap.channel;
+        rec.rssi = ap.rssi;
+        rec.selected = ap.selected;
+        rec.frames = ap.frames;
+        strncpy(rec.essid, ap.essid, sizeof(rec.essid));
+        memcpy(buf + pos, &rec, sizeof(rec));
+        pos += sizeof(rec);
+    }
+    
+    auto* stas = wifiAttacks.getStations();
+    hdr.staCount = min(stas->size(), MAX_STATIONS);
+    for (int i = 0; i < hdr.staCount; i++) {
+        const Station& s = stas->get(i);
+        SessionStation rec;
+        memcpy(rec.mac, s.mac, 6);
+        memcpy(rec.bssid, s.bssid, 6);
+        rec.channel = s.channel;
+        rec.rssi = s.rssi;
+        rec.selected = s.selected;
+        rec.frames = s.frames;
+        memcpy(buf + pos, &rec, sizeof(rec));
+        pos += sizeof(rec);
+    }
+    
+    auto* ssids = wifiAttacks.getSSIDs();
+    hdr.ssidCount = min(ssids->size(), MAX_SSIDS);
+    for (int i = 0; i < hdr.ssidCount; i++) {
+        SSID s = ssids->get(i);
+        SessionSSID rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.selected = s.selected;
+        strncpy(rec.name, s.name.c_str(), sizeof(rec.name));
+        memcpy(buf + pos, &rec, sizeof(rec));
+        pos += sizeof(rec);
+    }
+    
+    return pos;
+}
+
+bool SessionStore::save() {
+    if (!_mounted) return false;
+    uint32_t start = millis();
+    
+    SessionHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.magic = SESSION_MAGIC;
+    hdr.version = SESSION_VERSION;
+    hdr.headerSize = sizeof(SessionHeader);
+    hdr.apSize = sizeof(SessionAP);
+    hdr.staSize = sizeof(SessionStation);
+    hdr.ssidSize = sizeof(SessionSSID);
+    hdr.channel = wifiAttacks.getChannel();
+    
+    uint8_t* body = (uint8_t*)malloc(SESSION_BODY_MAX);
+    if (body == nullptr) return false;
+    
+    // Copy out under the table lock and write without it: the promiscuous
+    // callback skips (and counts) updates while it is held, and a flash
+    // write takes tens of ms or more
+    wifiAttacks.lockTables(portMAX_DELAY);
+    size_t n = packRecords(body, hdr);
+    wifiAttacks.unlockTables();
+    
+    // Header fields are part of the identity too (channel setting)
+    hdr.crc = EventStream::crc32(body, n);
+    uint32_t identity = EventStream::crc32((const uint8_t*)&hdr, sizeof(hdr));
+    if (identity == _savedCrc && LittleFS.exists(SESSION_FILE)) {
+        free(body);
+        _dirty = false;
+        _lastSave = millis();
+        return true;
+    }
+    
+    File file = LittleFS.open(SESSION_TMP, FILE_WRITE);
+    bool ok = (bool)file;
+    if (ok) {
+        ok = file.write((const uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr) &&
+             file.write(body, n) == n;
+        file.close();
+    }
+    free(body);
+    
+    // Swap in only a complete file. LittleFS renames over the old one
+    // atomically, so some snapshot survives a reset at any point.
+    if (ok) {
+        ok = LittleFS.rename(SESSION_TMP, SESSION_FILE);
+    } else {
+        LittleFS.remove(SESSION_TMP);
+    }
+    
+    if (ok) {
+        _savedCrc = identity;
+        _dirty = false;
+        _apCount = hdr.apCount;
+        _staCount = hdr.staCount;
+        _ssidCount = hdr.ssidCount;
+        _lastMs = millis() - start;
+    }
+    _lastSave = millis();
+    return ok;
+}
+
+bool SessionStore::clear() {
+    if (!_mounted) return false;
+    _savedCrc = 0;
+    _dirty = false;
+    return !LittleFS.exists(SESSION_FILE) || LittleFS.remove(SESSION_FILE);
+}
+
+// ============================================
+// Restore
+// ============================================
+
+// Largest stored record readRecord() takes
+static const size_t SESSION_RECORD_MAX = 64;
+
+// Read one stored record into ours: shorter (older) records leave the
+// missing tail zeroed, longer (newer) ones have their extra fields skipped
+static const uint8_t* readRecord(const uint8_t* p, void* rec, size_t ours, uint8_t stored) {
+    memset(rec, 0, ours);
+    memcpy(rec, p, min((size_t)stored, ours));
+    return p + stored;
+}
+
+bool SessionStore::restore() {
+    if (!_mounted) return false;
+    uint32_t start = millis();
+    
+    // A reset between writing the temp file and renaming it leaves the
+    // complete snapshot under the temp name only
+    const char* path = LittleFS.exists(SESSION_FILE) ? SESSION_FILE : SESSION_TMP;
+    if (!LittleFS.exists(path)) return false;
+    File file = LittleFS.open(path, FILE_READ);
+    if (!file) return false;
+    
+    // Any version up to ours: the record sizes say how to read it
+    SessionHeader hdr;
+    memset(&hdr, 0, sizeof(hdr));
+    bool ok = file.read((uint8_t*)&hdr, sizeof(hdr)) == sizeof(hdr) &&
+              hdr.magic == SESSION_MAGIC && hdr.version >= 1 && hdr.version <= SESSION_VERSION &&
+              hdr.headerSize >= sizeof(hdr) &&
+              hdr.apSize > 0 && hdr.apSize <= SESSION_RECORD_MAX &&
+              hdr.staSize > 0 && hdr.staSize <= SESSION_RECORD_MAX &&
+              hdr.ssidSize > 0 && hdr.ssidSize <= SESSION_RECORD_MAX &&
+              hdr.apCount <= MAX_APS && hdr.staCount <= MAX_STATIONS && hdr.ssidCount <= MAX_SSIDS;
+              
+    // Whole body into RAM and validated before touching the tables, so
+    // the table lock is never held across a flash read
+    size_t body = (size_t)hdr.apCount * hdr.apSize + (size_t)hdr.staCount * hdr.staSize +
+                  (size_t)hdr.ssidCount * hdr.ssidSize;
+    uint8_t* buf = nullptr;
+    if (ok) ok = file.size() == hdr.headerSize + body && file.seek(hdr.headerSize);
+    if (ok) ok = (buf = (uint8_t*)malloc(body + 1)) != nullptr;
+    if (ok) ok = file.read(buf, body) == body && EventStream::crc32(buf, body) == hdr.crc;
+    file.close();
+    if (!ok) {
+        free(buf);
+        return false;
+    }
+    
+    const uint8_t* p = buf;
+    wifiAttacks.lockTables(portMAX_DELAY);
+    auto* aps = wifiAttacks.getAPs();
+    auto* stas = wifiAttacks.getStations();
+    aps->clear();
+    stas->clear();
+    apSelector.reset();
+    
+    uint32_t now = millis();
+    for (uint16_t i = 0; i < hdr.apCount; i++) {
+        SessionAP rec;
+        p = readRecord(p, &rec, sizeof(rec), hdr.apSize);
+        AccessPoint ap;
+        memcpy(ap.essid, rec.essid, sizeof(rec.essid));
+        ap.essid[sizeof(rec.essid)] = '\0';
+        memcpy(ap.bssid, rec.bssid, 6);
+        ap.channel = rec.channel;
+        ap.rssi = rec.rssi;
+        ap.selected = rec.selected;
+        ap.frames = rec.frames;
+        ap.lastSeen = now;
+        aps->add(ap);
+        apSelector.noteAP(aps->size() - 1, ap);
+    }
+    for (uint16_t i = 0; i < hdr.staCount; i++) {
+        SessionStation rec;
+        p = readRecord(p, &rec, sizeof(rec), hdr.staSize);
+        Station s;
+        memcpy(s.mac, rec.mac, 6);
+        memcpy(s.bssid, rec.bssid, 6);
+        s.channel = rec.channel;
+        s.rssi = rec.rssi;
+        s.selected = rec.selected;
+        s.frames = rec.frames;
+        s.lastSeen = now;
+        stas->add(s);
+    }
+    wifiAttacks.unlockTables();
+    
+    // Stored SSIDs replace the built-in beacon list
+    auto* ssids = wifiAttacks.getSSIDs();
+    ssids->clear();
+    for (uint16_t i = 0; i < hdr.ssidCount; i++) {
+        SessionSSID rec;
+        p = readRecord(p, &rec, sizeof(rec), hdr.ssidSize);
+        char name[33];
+        memcpy(name, rec.name, sizeof(rec.name));
+        name[sizeof(rec.name)] = '\0';
+        SSID s;
+        s.name = name;
+        s.selected = rec.selected;
+        ssids->add(s);
+    }
+    free(buf);
+    
+    if (hdr.channel >= 1 && hdr.channel <= MAX_CHANNEL) wifiAttacks.setChannel(hdr.channel);
+    
+    // RAM now matches the file; a same-layout header is exactly what
+    // save() would produce, so an unchanged session is not rewritten
+    bool sameLayout = hdr.version == SESSION_VERSION &&
+                      hdr.headerSize == sizeof(SessionHeader) && hdr.apSize == sizeof(SessionAP) &&
+                      hdr.staSize == sizeof(SessionStation) && hdr.ssidSize == sizeof(SessionSSID);
+    _savedCrc = sameLayout ? EventStream::crc32((const uint8_t*)&hdr, sizeof(hdr)) : 0;
+    _dirty = false;
+    _apCount = hdr.apCount;
+    _staCount = hdr.staCount;
+    _ssidCount = hdr.ssidCount;
+    _lastMs = millis() - start;
+    return true;
+}
+
+// ============================================
+// Autosave
+// ============================================
+
+void SessionStore::update() {
+    if (!_mounted) return;
+    uint32_t now = millis();
+    
+    if (wifiAttacks.isActive()) {
+        // Long runs: checkpoint so a power cut keeps most of what was found
+        if (now - _lastSave >= SESSION_CHECKPOINT_MS) save();
+    } else if (_dirty && now - _dirtySince >= SESSION_IDLE_SAVE_MS) {
+        save();
+    }
+}
+
+uint32_t SessionStore::nextWakeMs() const {
+    if (!_mounted) return EventLoop::FOREVER;
+    if (wifiAttacks.isActive()) return msUntil(_lastSave, SESSION_CHECKPOINT_MS, millis());
+    if (_dirty) return msUntil(_dirtySince, SESSION_IDLE_SAVE_MS, millis());
+    return EventLoop::FOREVER;
+}
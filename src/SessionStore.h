@@ -0,0 +1,124 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+
+namespace fs { class File; }
+
+// ============================================
+// Session Store
+// Target tables kept on flash across reboots
+// ============================================
+//
+// The AP, station and SSID tables (with selections) are snapshotted to
+// SESSION_FILE on the LittleFS partition and streamed back at boot.
+//
+// File layout, little endian:
+//   SessionHeader
+//   apCount   x SessionAP
+//   staCount  x SessionStation
+//   ssidCount x SessionSSID
+//
+// The header records each record size: a later version may append
+// fields to a record and older firmware still reads the prefix it knows;
+// any version from 1 to SESSION_VERSION is read that way. The header
+// CRC-32 covers everything after the header, so a torn write is
+// rejected. Snapshots go to a temp file that LittleFS renames over the
+// old one atomically; restore falls back to the temp file if a reset
+// came before the rename. One whose content has not changed is not
+// rewritten at all.
+//
+// The tables are copied to RAM under the table lock and written to
+// flash after it is released, so the sniffer is only held off for the
+// copy, not the write.
+
+static const uint32_t SESSION_MAGIC = 0x3153544D;  // "MTS1"
+static const uint16_t SESSION_VERSION = 1;
+
+struct __attribute__((packed)) SessionHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t headerSize;
+    uint8_t apSize;
+    uint8_t staSize;
+    uint8_t ssidSize;
+    uint8_t channel;        // WiFi channel setting
+    uint16_t apCount;
+    uint16_t staCount;
+    uint16_t ssidCount;
+    uint16_t reserved;
+    uint32_t crc;           // CRC-32 of the records
+};
+
+struct __attribute__((packed)) SessionAP {
+    uint8_t bssid[6];
+    uint8_t channel;
+    int8_t rssi;
+    uint8_t selected;
+    uint16_t frames;
+    char essid[32];         // Not NUL-terminated when 32 long
+};
+
+struct __attribute__((packed)) SessionStation {
+    uint8_t mac[6];
+    uint8_t bssid[6];
+    uint8_t channel;
+    int8_t rssi;
+    uint8_t selected;
+    uint16_t frames;
+};
+
+struct __attribute__((packed)) SessionSSID {
+    uint8_t selected;
+    char name[32];
+};
+
+// Largest body: every table full
+static const size_t SESSION_BODY_MAX = MAX_APS * sizeof(SessionAP) + MAX_STATIONS * sizeof(SessionStation) +
+                                       MAX_SSIDS * sizeof(SessionSSID);
+                                       
+class SessionStore {
+public:
+    // Mounts the partition (formatting a blank one)
+    bool begin();
+    bool mounted() const { return _mounted; }
+    
+    // Replace the tables with the snapshot; false if there is none or it
+    // is damaged (tables untouched)
+    bool restore();
+    
+    // Write a snapshot now; false on a flash error. Unchanged content is
+    // not rewritten.
+    bool save();
+    bool clear();
+    
+    // Tables or selections changed (main loop); saved once idle
+    void markDirty();
+    
+    // Main loop: idle autosave, periodic checkpoint during runs
+    void update();
+    uint32_t nextWakeMs() const;
+    
+    uint16_t lastApCount() const { return _apCount; }
+    uint16_t lastStaCount() const { return _staCount; }
+    uint16_t lastSsidCount() const { return _ssidCount; }
+    uint32_t lastMs() const { return _lastMs; }
+    
+private:
+    bool _mounted = false;
+    bool _dirty = false;
+    uint32_t _dirtySince = 0;
+    uint32_t _lastSave = 0;
+    uint32_t _savedCrc = 0;     // Content of the file on flash
+    
+    // Counts and duration of the last save/restore, for status lines
+    uint16_t _apCount = 0;
+    uint16_t _staCount = 0;
+    uint16_t _ssidCount = 0;
+    uint32_t _lastMs = 0;
+    
+    size_t packRecords(uint8_t* buf, SessionHeader& hdr);
+};
+
+// Global instance
+extern SessionStore session;
@@ -0,0 +1,319 @@
+/**
+ * ESP32 Marauder TUI - Signature Set
+ *
+ * Root transitions are a direct table since nearly every pattern starts
+ * there; deeper nodes have few children, kept as a sibling list. The
+ * automaton is built in place, so growing the set costs no heap.
+ */
+
+#include "SignatureSet.h"
+#include <LittleFS.h>
+
+SignatureSet signatures;
+
+// Built in: Flipper by name (its service UUIDs are in BLEAdvert) and the
+// default names of the serial modules found in card skimmers
+static const char* const BUILTIN[] = {
+    "name Flipper flipper",
+    "name HC-05 skimmer",
+    "name HC-06 skimmer",
+    "name HC-08 skimmer",
+    "name BT_SKIMMER skimmer",
+    "name RNBT skimmer",
+};
+
+static const char* const FIELD_NAMES[] = {"name", "mfr", "svc"};
+
+static int hexNibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Hex digits to bytes; false unless whole bytes that fit
+static bool parseHex(const char* text, uint8_t* out, uint8_t* len) {
+    size_t digits = strlen(text);
+    if (digits == 0 || digits % 2 || digits / 2 > SIG_MAX_LEN) return false;
+    for (size_t i = 0; i < digits; i += 2) {
+        int hi = hexNibble(text[i]);
+        int lo = hexNibble(text[i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        out[i / 2] = (hi << 4) | lo;
+    }
+    *len = digits / 2;
+    return true;
+}
+
+void SignatureSet::begin(bool mounted) {
+    _mounted = mounted;
+    reset();
+    if (_mounted) load();
+}
+
+void SignatureSet::reset() {
+    portENTER_CRITICAL(&_mux);
+    _ready = false;
+    portEXIT_CRITICAL(&_mux);
+    
+    _count = 0;
+    _poolUsed = 0;
+    for (const char* line : BUILTIN) add(line);
+    _builtins = _count;
+    compile();
+}
+
+bool SignatureSet::add(const char* line) {
+    char buf[COMMAND_LINE_LEN];
+    strncpy(buf, line, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+    
+    char* save = nullptr;
+    const char* field = strtok_r(buf, " ", &save);
+    const char* pattern = strtok_r(nullptr, " ", &save);
+    const char* cls = strtok_r(nullptr, " ", &save);
+    if (!field || !pattern || !cls || strtok_r(nullptr, " ", &save)) return false;
+    
+    Signature sig;
+    if (!BLEAdvert::classByName(cls, &sig.cls) || sig.cls == BLEClass::DEVICE) return false;
+    
+    uint8_t bytes[SIG_MAX_LEN];
+    if (strcasecmp(field, "name") == 0) {
+        sig.field = SigField::NAME;
+        size_t n = strlen(pattern);
+        if (n > SIG_MAX_LEN) return false;
+        memcpy(bytes, pattern, n);
+        sig.len = n;
+    } else if (strcasecmp(field, "mfr") == 0) {
+        sig.field = SigField::MFR;
+        if (!parseHex(pattern, bytes, &sig.len) || sig.len < 2) return false;
+    } else if (strcasecmp(field, "svc") == 0) {
+        // Written as usual (FEED), sent little-endian
+        uint8_t be[SIG_MAX_LEN];
+        sig.field = SigField::SERVICE;
+        if (!parseHex(pattern, be, &sig.len) || sig.len != 2) return false;
+        bytes[0] = be[1];
+        bytes[1] = be[0];
+    } else {
+        return false;
+    }
+    
+    if (_count >= SIG_MAX_COUNT || _poolUsed + sig.len > SIG_POOL_LEN) return false;
+    sig.offset = _poolUsed;
+    sig.nextOut = NO_SIG;
+    memcpy(_pool + _poolUsed, bytes, sig.len);
+    _poolUsed += sig.len;
+    _sigs[_count++] = sig;
+    return true;
+}
+
+uint16_t SignatureSet::child(uint16_t node, uint8_t byte) const {
+    if (node == 0) return _root[byte];
+    for (uint16_t c = _nodes[node].child; c; c = _nodes[c].sibling) {
+        if (_nodes[c].byte == byte) return c;
+    }
+    return 0;
+}
+
+// Goto with failure links: the state after byte
+uint16_t SignatureSet::step(uint16_t node, uint8_t byte) const {
+    for (;;) {
+        uint16_t next = child(node, byte);
+        if (next || node == 0) return next;
+        node = _nodes[node].fail;
+    }
+}
+
+bool SignatureSet::compile() {
+    portENTER_CRITICAL(&_mux);
+    _ready = false;
+    portEXIT_CRITICAL(&_mux);
+    
+    // Trie of all patterns
+    memset(_root, 0, sizeof(_root));
+    memset(&_nodes[0], 0, sizeof(_nodes[0]));
+    _nodes[0].out = NO_SIG;
+    _nodeCount = 1;
+    bool overflow = false;
+    for (uint16_t i = 0; i < _count; i++) {
+        Signature& sig = _sigs[i];
+        uint16_t node = 0;
+        for (uint8_t j = 0; j < sig.len; j++) {
+            uint8_t b = _pool[sig.offset + j];
+            uint16_t next = child(node, b);
+            if (next == 0 && _nodeCount >= SIG_MAX_NODES) {
+                // Out of nodes: keep the signatures that fit
+                _count = i;
+                _poolUsed = sig.offset;
+                overflow = true;
+                break;
+            }
+            if (next == 0) {
+                next = _nodeCount++;
+                SigNode& n = _nodes[next];
+                n.child = 0;
+                n.sibling = 0;
+                n.out = NO_SIG;
+                n.byte = b;
+                if (node == 0) {
+                    _root[b] = next;
+                } else {
+                    n.sibling = _nodes[node].child;
+                    _nodes[node].child = next;
+                }
+            }
+            node = next;
+        }
+        if (overflow) break;
+        sig.nextOut = _nodes[node].out;
+        _nodes[node].out = i;
+    }
+    
+    // Failure and output links, breadth first so parents are done first
+    uint16_t queue[SIG_MAX_NODES];
+    uint16_t head = 0;
+    uint16_t tail = 0;
+    for (uint16_t b = 0; b < 256; b++) {
+        uint16_t n = _root[b];
+        if (n == 0) continue;
+        _nodes[n].fail = 0;
+        _nodes[n].dict = 0;
+        queue[tail++] = n;
+    }
+    while (head < tail) {
+        uint16_t node = queue[head++];
+        for (uint16_t c = _nodes[node].child; c; c = _nodes[c].sibling) {
+            uint16_t fail = step(_nodes[node].fail, _nodes[c].byte);
+            _nodes[c].fail = fail;
+            _nodes[c].dict = _nodes[fail].out != NO_SIG ? fail : _nodes[fail].dict;
+            queue[tail++] = c;
+        }
+    }
+    
+    portENTER_CRITICAL(&_mux);
+    _ready = true;
+    portEXIT_CRITICAL(&_mux);
+    return !overflow;
+}
+
+// One field; best = lowest signature index hit so far
+void SignatureSet::scan(const uint8_t* data, uint8_t len, SigField field, bool anchored,
+                        uint16_t& best) const {
+    uint16_t node = 0;
+    for (uint8_t i = 0; i < len; i++) {
+        node = step(node, data[i]);
+        for (uint16_t n = node; n; n = _nodes[n].dict) {
+            for (uint16_t s = _nodes[n].out; s != NO_SIG; s = _sigs[s].nextOut) {
+                const Signature& sig = _sigs[s];
+                if (sig.field != field || s >= best) continue;
+                // Prefixes start the field; UUIDs in a list are 2-byte aligned
+                uint8_t start = i + 1 - sig.len;
+                if (anchored ? start != 0 : (field == SigField::SERVICE && (start & 1))) continue;
+                best = s;
+            }
+        }
+    }
+}
+
+BLEClass SignatureSet::result(uint16_t best) {
+    if (best == NO_SIG) return BLEClass::DEVICE;
+    _hits++;
+    return _sigs[best].cls;
+}
+
+BLEClass SignatureSet::matchAdvert(const uint8_t* adv, size_t len) {
+    uint16_t best = NO_SIG;
+    portENTER_CRITICAL(&_mux);
+    if (_ready) {
+        ADIterator it(adv, len);
+        ADStructure ad;
+        while (it.next(ad)) {
+            switch (ad.type) {
+                case AD_NAME_SHORT:
+                case AD_NAME_COMPLETE:
+                    scan(ad.data, ad.len, SigField::NAME, false, best);
+                    break;
+                case AD_MANUFACTURER:
+                    scan(ad.data, ad.len, SigField::MFR, true, best);
+                    break;
+                case AD_UUID16_SOME:
+                case AD_UUID16_ALL:
+                    scan(ad.data, ad.len, SigField::SERVICE, false, best);
+                    break;
+                case AD_SERVICE_DATA16:
+                    scan(ad.data, min((uint8_t)2, ad.len), SigField::SERVICE, true, best);
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    BLEClass cls = result(best);
+    portEXIT_CRITICAL(&_mux);
+    return cls;
+}
+
+BLEClass SignatureSet::matchName(const uint8_t* name, size_t len) {
+    uint16_t best = NO_SIG;
+    portENTER_CRITICAL(&_mux);
+    if (_ready) scan(name, min(len, (size_t)UINT8_MAX), SigField::NAME, false, best);
+    BLEClass cls = result(best);
+    portEXIT_CRITICAL(&_mux);
+    return cls;
+}
+
+void SignatureSet::describe(uint16_t index, char* buf, size_t len) const {
+    const Signature& sig = _sigs[index];
+    const uint8_t* p = _pool + sig.offset;
+    int pos = snprintf(buf, len, "%s ", FIELD_NAMES[(uint8_t)sig.field]);
+    for (uint8_t i = 0; i < sig.len && pos < (int)len; i++) {
+        if (sig.field == SigField::NAME) {
+            pos += snprintf(buf + pos, len - pos, "%c", p[i]);
+        } else {
+            // svc back to the usual byte order
+            uint8_t b = sig.field == SigField::SERVICE ? p[sig.len - 1 - i] : p[i];
+            pos += snprintf(buf + pos, len - pos, "%02x", b);
+        }
+    }
+    if (pos < (int)len) snprintf(buf + pos, len - pos, " %s", BLEAdvert::className(sig.cls));
+}
+
+// Signatures past the built-ins, one line each
+bool SignatureSet::save() {
+    if (!_mounted) return false;
+    File file = LittleFS.open(SIGNATURE_FILE, FILE_WRITE);
+    if (!file) return false;
+    char line[COMMAND_LINE_LEN];
+    bool ok = true;
+    for (uint16_t i = _builtins; i < _count && ok; i++) {
+        describe(i, line, sizeof(line));
+        size_t n = strlen(line);
+        line[n++] = '\n';
+        ok = file.write((const uint8_t*)line, n) == n;
+    }
+    file.close();
+    return ok;
+}
+
+// Adds SIGNATURE_FILE to the set; lines that do not parse are skipped
+bool SignatureSet::load() {
+    if (!_mounted || !LittleFS.exists(SIGNATURE_FILE)) return false;
+    File file = LittleFS.open(SIGNATURE_FILE, FILE_READ);
+    if (!file) return false;
+    
+    char line[COMMAND_LINE_LEN];
+    size_t n = 0;
+    for (;;) {
+        int c = file.read();
+        if (c < 0 || c == '\n') {
+            line[n] = '\0';
+            if (n > 0 && line[0] != '#') add(line);
+            n = 0;
+            if (c < 0) break;
+        } else if (c != '\r' && n < sizeof(line) - 1) {
+            line[n++] = c;
+        }
+    }
+    file.close();
+    return compile();
+}
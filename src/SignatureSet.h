@@ -0,0 +1,107 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include "BLEAdvert.h"
+#include <freertos/FreeRTOS.h>
+
+// ============================================
+// Signature Set
+// Multi-pattern matching of BLE adverts
+// ============================================
+//
+// Signatures are byte patterns on one advert field, each naming the
+// BLEClass of a device that carries it. One per line:
+//
+//   name <text> <class>     Substring of the advertised name
+//   mfr <hex> <class>       Manufacturer data prefix, company ID first
+//                           as sent (4c0012 = Apple Find My)
+//   svc <uuid16> <class>    16-bit service UUID, listed or with data
+//
+// e.g. "name HC-05 skimmer". Classes are BLEAdvert::className() names.
+//
+// All patterns are compiled into one Aho-Corasick automaton: a trie of
+// the patterns, with failure links so that a mismatch falls back to the
+// longest pattern prefix that still fits instead of restarting. An
+// advert is then a single pass over the data bytes of its AD structures,
+// one transition per byte whatever the number of signatures; a hit is
+// kept if the field (and for mfr / svc, the position) matches. With
+// several hits, the earliest signature in the set wins.
+//
+// The built-in set is in flash; more can be added at run time
+// (:sig add) and saved to SIGNATURE_FILE, which is loaded at boot.
+// Each change recompiles the set; adverts scanned meanwhile are not
+// matched.
+
+enum class SigField : uint8_t {
+    NAME,
+    MFR,
+    SERVICE
+};
+
+struct Signature {
+    SigField field;
+    BLEClass cls;
+    uint8_t len;
+    uint16_t offset;        // In the pattern pool
+    uint16_t nextOut;       // Next signature ending at the same node
+};
+
+// Trie node; index 0 is the root and doubles as "none"
+struct SigNode {
+    uint16_t child;         // First child; siblings chain through sibling
+    uint16_t sibling;
+    uint16_t fail;          // Longest proper suffix that is a trie node
+    uint16_t out;           // First signature ending here, or NO_SIG
+    uint16_t dict;          // Nearest node on the fail chain with an out
+    uint8_t byte;
+};
+
+class SignatureSet {
+public:
+    static const uint16_t NO_SIG = 0xFFFF;
+    
+    // Built-ins, then SIGNATURE_FILE when the partition is mounted
+    void begin(bool mounted);
+    
+    // One signature line; false on a syntax error or when full
+    bool add(const char* line);
+    bool compile();
+    // Back to the built-ins
+    void reset();
+    bool save();
+    bool load();
+    
+    // NimBLE task: class of the best signature hit, DEVICE if none
+    BLEClass matchAdvert(const uint8_t* adv, size_t len);
+    BLEClass matchName(const uint8_t* name, size_t len);
+    
+    uint16_t count() const { return _count; }
+    uint16_t builtins() const { return _builtins; }
+    uint16_t nodes() const { return _nodeCount; }
+    uint16_t poolUsed() const { return _poolUsed; }
+    uint32_t hits() const { return _hits; }
+    void describe(uint16_t index, char* buf, size_t len) const;
+    
+private:
+    Signature _sigs[SIG_MAX_COUNT];
+    uint8_t _pool[SIG_POOL_LEN];
+    SigNode _nodes[SIG_MAX_NODES];
+    uint16_t _root[256];        // Root transitions, direct
+    uint16_t _count = 0;
+    uint16_t _builtins = 0;
+    uint16_t _poolUsed = 0;
+    uint16_t _nodeCount = 0;
+    uint32_t _hits = 0;
+    bool _mounted = false;
+    bool _ready = false;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    
+    uint16_t child(uint16_t node, uint8_t byte) const;
+    uint16_t step(uint16_t node, uint8_t byte) const;
+    void scan(const uint8_t* data, uint8_t len, SigField field, bool anchored, uint16_t& best) const;
+    BLEClass result(uint16_t best);
+};
+
+// Global instance
+extern SignatureSet signatures;
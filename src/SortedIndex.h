@@ -0,0 +1,95 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ============================================
+// Sorted Index
+// Incrementally ordered view over a fixed table
+// ============================================
+//
+// Holds table indices (0..CAPACITY-1) ordered by a caller-supplied
+// comparator. When one record's key changes, update() sifts only that
+// entry to its new rank, so keeping a live ordering costs O(distance
+// moved) instead of a full sort per change.
+
+template <uint8_t CAPACITY>
+class SortedIndex {
+public:
+    // Strict weak ordering on table indices; ctx is passed through
+    typedef bool (*Less)(uint8_t a, uint8_t b, const void* ctx);
+    
+    void setOrder(Less less, const void* ctx) {
+        _less = less;
+        _ctx = ctx;
+        resort();
+    }
+    
+    void clear() { _size = 0; }
+    uint8_t size() const { return _size; }
+    uint8_t at(uint8_t rank) const { return _order[rank]; }
+    bool contains(uint8_t idx) const {
+        return idx < CAPACITY && _rank[idx] < _size && _order[_rank[idx]] == idx;
+    }
+    
+    // Add a new table index and sift it into place
+    void insert(uint8_t idx) {
+        if (idx >= CAPACITY || _size >= CAPACITY || contains(idx)) return;
+        _order[_size] = idx;
+        _rank[idx] = _size;
+        _size++;
+        siftUp(_size - 1);
+    }
+    
+    // The key of idx changed; move it to its new rank
+    void update(uint8_t idx) {
+        if (!contains(idx)) {
+            insert(idx);
+            return;
+        }
+        uint8_t r = _rank[idx];
+        if (!siftUp(r)) siftDown(r);
+    }
+    
+    // Full re-sort (comparator changed); insertion sort, already-sorted is O(n)
+    void resort() {
+        for (uint8_t i = 1; i < _size; i++) siftUp(i);
+    }
+    
+private:
+    uint8_t _order[CAPACITY];   // rank -> table index
+    uint8_t _rank[CAPACITY];    // table index -> rank
+    uint8_t _size = 0;
+    Less _less = nullptr;
+    const void* _ctx = nullptr;
+    
+    void swap(uint8_t r1, uint8_t r2) {
+        uint8_t a = _order[r1];
+        uint8_t b = _order[r2];
+        _order[r1] = b;
+        _order[r2] = a;
+        _rank[b] = r1;
+        _rank[a] = r2;
+    }
+    
+    bool siftUp(uint8_t r) {
+        if (_less == nullptr) return false;
+        bool moved = false;
+        while (r > 0 && _less(_order[r], _order[r - 1], _ctx)) {
+            swap(r, r - 1);
+            r--;
+            moved = true;
+        }
+        return moved;
+    }
+    
+    bool siftDown(uint8_t r) {
+        if (_less == nullptr) return false;
+        bool moved = false;
+        while (r + 1 < _size && _less(_order[r + 1], _order[r], _ctx)) {
+            swap(r, r + 1);
+            r++;
+            moved = true;
+        }
+        return moved;
+    }
+};
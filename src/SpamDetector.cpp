@@ -0,0 +1,208 @@
+/**
+ * ESP32 Marauder TUI - Spam Detector
+ *
+ * The NimBLE task only counts; a window is swapped out under the lock
+ * and judged on the main loop, so an alert comes at most one window
+ * after the flood starts.
+ */
+
+#include "SpamDetector.h"
+#include "SerialTUI.h"
+#include "EventLoop.h"
+#include "EventStream.h"
+
+SpamDetector spamDetector;
+
+static const char* const SHAPE_NAMES[] = {"Apple", "Windows", "Samsung", "Google"};
+
+// Stream CLASS of each shape
+static const BLEClass SHAPE_CLASSES[] = {
+    BLEClass::APPLE, BLEClass::MS_SWIFT_PAIR, BLEClass::SAMSUNG, BLEClass::FAST_PAIR
+};
+
+SpamShape SpamDetector::shapeOf(const BLEAdvert& ad, BLEClass cls) {
+    switch (cls) {
+        case BLEClass::APPLE_NEARBY_ACTION:
+            // Nearby Action with the 5-byte body spam sends
+            return ad.mfrLen >= 2 && ad.mfr[1] == 0x05 ? SpamShape::APPLE : SpamShape::NONE;
+        case BLEClass::APPLE_AIRPODS:
+            // Proximity pairing, full length (0x19)
+            return ad.mfrLen >= 2 && ad.mfr[1] == 0x19 ? SpamShape::APPLE : SpamShape::NONE;
+        case BLEClass::MS_SWIFT_PAIR:
+            return SpamShape::WINDOWS;
+        case BLEClass::SAMSUNG:
+            return SpamShape::SAMSUNG;
+        case BLEClass::FAST_PAIR:
+            // Discoverable: the model ID alone; account data is longer
+            return ad.serviceDataLen == 3 ? SpamShape::GOOGLE : SpamShape::NONE;
+        default:
+            return SpamShape::NONE;
+    }
+}
+
+const char* SpamDetector::shapeName(SpamShape shape) {
+    if (shape >= SpamShape::COUNT) return "?";
+    return SHAPE_NAMES[(uint8_t)shape];
+}
+
+void SpamDetector::noteAdvert(const uint8_t* mac, int8_t rssi, const BLEAdvert& ad, BLEClass cls) {
+    SpamShape shape = shapeOf(ad, cls);
+    if (shape == SpamShape::NONE) return;
+    
+    // Random addresses: the low four bytes are hash enough
+    uint32_t x = ((uint32_t)mac[2] << 24) | ((uint32_t)mac[3] << 16) | (mac[4] << 8) | mac[5];
+    uint16_t bit = ((x * 2654435761u) >> 16) % SPAM_ADDR_BITS;
+    uint16_t byte = bit >> 3;
+    uint8_t mask = 1 << (bit & 7);
+    bool wake = false;
+    
+    portENTER_CRITICAL(&_mux);
+    if (!_active) {
+        // First advert after a quiet spell starts a window
+        _active = true;
+        _windowStart = millis();
+        wake = true;
+    }
+    SpamWindow& w = _windows[(uint8_t)shape];
+    if (w.adverts < UINT16_MAX) {
+        w.adverts++;
+        // Into the current generation; new unless the older one has it
+        uint8_t* cur = _addrs[(uint8_t)shape][_gen];
+        if (!(cur[byte] & mask)) {
+            cur[byte] |= mask;
+            if (!(_addrs[(uint8_t)shape][_gen ^ 1][byte] & mask)) {
+                // RSSI of the spoofer only, not of real devices alongside
+                if (w.fresh == 0 || rssi > w.rssiMax) w.rssiMax = rssi;
+                w.fresh++;
+                w.rssiSum += rssi;
+            }
+        }
+    }
+    portEXIT_CRITICAL(&_mux);
+    
+    if (wake) events.post(EventType::ALERT);
+}
+
+void SpamDetector::update() {
+    if (!_active) return;
+    uint32_t now = millis();
+    uint32_t elapsed = now - _windowStart;
+    if (elapsed < SPAM_WINDOW_MS) return;
+    
+    SpamWindow ended[(uint8_t)SpamShape::COUNT];
+    portENTER_CRITICAL(&_mux);
+    memcpy(ended, _windows, sizeof(ended));
+    memset(_windows, 0, sizeof(_windows));
+    _windowStart = now;
+    portEXIT_CRITICAL(&_mux);
+    
+    // Fill over the window that ended; bits set since are few enough to
+    // count outside the lock
+    uint16_t fillBits[(uint8_t)SpamShape::COUNT];
+    for (uint8_t i = 0; i < (uint8_t)SpamShape::COUNT; i++) fillBits[i] = (_fillStart[i] + fill(i)) / 2;
+    
+    if (++_genWindows >= SPAM_ADDR_WINDOWS) {
+        portENTER_CRITICAL(&_mux);
+        _gen ^= 1;
+        for (uint8_t i = 0; i < (uint8_t)SpamShape::COUNT; i++) memset(_addrs[i][_gen], 0, sizeof(_addrs[i][_gen]));
+        portEXIT_CRITICAL(&_mux);
+        _genWindows = 0;
+    }
+    for (uint8_t i = 0; i < (uint8_t)SpamShape::COUNT; i++) _fillStart[i] = fill(i);
+    bool warm = _warm >= SPAM_ADDR_WINDOWS;
+    if (!warm) _warm++;
+    
+    bool busy = false;
+    for (uint8_t i = 0; i < (uint8_t)SpamShape::COUNT; i++) {
+        // Until then every address looks new
+        if (warm) judge((SpamShape)i, ended[i], fillBits[i], elapsed, now);
+        busy = busy || ended[i].adverts > 0 || _floodState[i].active;
+    }
+    
+    // Nothing heard and no flood open: sleep until the next advert
+    if (!busy) {
+        portENTER_CRITICAL(&_mux);
+        bool heard = false;
+        for (uint8_t i = 0; i < (uint8_t)SpamShape::COUNT; i++) heard = heard || _windows[i].adverts > 0;
+        _active = heard;
+        if (!heard) {
+            memset(_addrs, 0, sizeof(_addrs));
+            memset(_fillStart, 0, sizeof(_fillStart));
+            _genWindows = 0;
+            _warm = 0;
+        }
+        portEXIT_CRITICAL(&_mux);
+    }
+}
+
+uint32_t SpamDetector::nextWakeMs() const {
+    if (!_active) return EventLoop::FOREVER;
+    return msUntil(_windowStart, SPAM_WINDOW_MS, millis());
+}
+
+// Bits set in either generation of a shape
+uint16_t SpamDetector::fill(uint8_t shape) const {
+    uint16_t bits = 0;
+    for (uint16_t i = 0; i < SPAM_ADDR_BITS / 8; i++) {
+        bits += __builtin_popcount(_addrs[shape][0][i] | _addrs[shape][1][i]);
+    }
+    return bits;
+}
+
+void SpamDetector::judge(SpamShape shape, const SpamWindow& w, uint16_t fillBits, uint32_t elapsed,
+                         uint32_t now) {
+    SpamFlood& f = _floodState[(uint8_t)shape];
+    uint32_t rate = (uint32_t)w.adverts * 1000 / elapsed;
+    
+    // A new address is only counted if its bit was clear: scale up by the
+    // clear share (floored, so a saturated set cannot blow it up)
+    uint32_t clear = max(SPAM_ADDR_BITS - (uint32_t)fillBits, (uint32_t)SPAM_ADDR_BITS / 8);
+    uint32_t fresh = min((uint32_t)w.fresh * SPAM_ADDR_BITS / clear, (uint32_t)w.adverts);
+    bool flood = rate >= SPAM_MIN_RATE && fresh * 100 >= (uint32_t)w.adverts * SPAM_FRESH_PCT;
+    
+    if (!flood) {
+        if (f.active && ++f.quiet >= SPAM_QUIET_WINDOWS) {
+            f.active = false;
+            alert(shape, f, now, true);
+        }
+        return;
+    }
+    
+    bool first = !f.active;
+    if (first) {
+        memset(&f, 0, sizeof(f));
+        f.active = true;
+        f.start = now - elapsed;
+        f.lastReport = now;
+    }
+    f.quiet = 0;
+    f.adverts += w.adverts;
+    f.rate = rate;
+    f.freshRate = fresh * 1000 / elapsed;
+    if (f.rate > f.peakRate) f.peakRate = f.rate;
+    f.rssi = w.rssiSum / w.fresh;
+    f.rssiMax = w.rssiMax;
+    
+    if (first || now - f.lastReport >= SPAM_REPORT_MS) {
+        f.lastReport = now;
+        alert(shape, f, now, false);
+    }
+}
+
+void SpamDetector::alert(SpamShape shape, const SpamFlood& f, uint32_t now, bool over) {
+    char buf[RESULT_TEXT_LEN];
+    if (over) {
+        snprintf(buf, sizeof(buf), "Spam flood over: %s, %lu s, %lu adverts, peak %u/s",
+                 shapeName(shape), (unsigned long)((now - f.start) / 1000),
+                 (unsigned long)f.adverts, f.peakRate);
+    } else {
+        snprintf(buf, sizeof(buf), "SPAM FLOOD: %s %u adv/s, %u new/s, ~%d dBm (max %d)",
+                 shapeName(shape), f.rate, f.freshRate, f.rssi, f.rssiMax);
+    }
+    
+    const char* name = shapeName(shape);
+    ResultMeta meta(f.rssi, 0);
+    tui.printResult(buf, ResultKind::SPAM, ResultQueue::keyOf(name, strlen(name)), &meta);
+    eventStream.emit(StreamEvent(StreamType::SPAM)
+        .setRssi(f.rssi).setClass((uint8_t)SHAPE_CLASSES[(uint8_t)shape]).setCount(over ? 0 : f.rate));
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include "BLEAdvert.h"
+#include <freertos/FreeRTOS.h>
+
+// ============================================
+// Spam Detector
+// BLE advert floods (pairing pop-up spam)
+// ============================================
+//
+// Pop-up spam - the :bt spam modes here, Flipper apps, phone apps -
+// sends one of a few payload shapes, each from a fresh random address,
+// tens of times a second. Every advert of any BLE scan is checked for
+// the shapes BTAttacks itself generates:
+//
+//   APPLE     Apple Nearby Action (0f 05 ...) or proximity pairing
+//             (07 19 ..., the AirPods pop-up)
+//   WINDOWS   Microsoft Swift Pair beacon (03 ...)
+//   SAMSUNG   Samsung manufacturer data (Galaxy Buds / Watch pop-ups)
+//   GOOGLE    Fast Pair service data with a bare 3-byte model ID
+//
+// The same shapes come from real phones and earbuds, so a shape alone
+// proves nothing; what a real device does not do is change address
+// with every advert. Per shape and per SPAM_WINDOW_MS window this counts
+// the adverts, the ones from new addresses, and the RSSI of those. All
+// spoofed addresses share one transmitter, so their mean RSSI estimates
+// how close it is.
+//
+// An address is new if it was not heard in the last SPAM_ADDR_WINDOWS
+// to twice that many windows: two generations of a SPAM_ADDR_BITS-bit
+// hash set per shape, the older one cleared as each generation starts.
+// A new address whose bit is already set by another is missed, more so
+// as the sets fill in a big flood; the count is scaled up by the share
+// of bits still clear over the window (mean of its start and end), so
+// the new-address share stays right at hundreds of adverts/s. A crowd of real
+// devices that advertise slowly is thus only new once, and nothing is
+// judged until the memory has had SPAM_ADDR_WINDOWS windows to fill.
+//
+// A window with SPAM_MIN_RATE adverts/s of a shape, SPAM_FRESH_PCT of
+// them from new addresses, is a flood. The alert ("SPAM FLOOD", stream
+// type spam) comes at its first window, again every SPAM_REPORT_MS while
+// it lasts, and once more when SPAM_QUIET_WINDOWS windows have passed
+// without one.
+//
+// Counting is a few instructions per advert with no heap, so the scan
+// callback keeps up with hundreds of adverts a second; rates and alerts
+// are worked out on the main loop once per window.
+
+enum class SpamShape : uint8_t {
+    APPLE,
+    WINDOWS,
+    SAMSUNG,
+    GOOGLE,
+    COUNT,
+    NONE = COUNT
+};
+
+// One shape in one window; filled by the NimBLE task
+struct SpamWindow {
+    uint16_t adverts;
+    uint16_t fresh;         // From new addresses
+    int32_t rssiSum;        // Of the fresh ones
+    int8_t rssiMax;
+};
+
+// Flood state of one shape; main loop only
+struct SpamFlood {
+    bool active;
+    uint8_t quiet;          // Windows without a flood since the last one
+    uint32_t start;
+    uint32_t lastReport;
+    uint32_t adverts;
+    uint16_t rate;          // Adverts/s in the last flood window
+    uint16_t freshRate;     // New addresses/s in it
+    uint16_t peakRate;
+    int8_t rssi;            // Mean of the last flood window
+    int8_t rssiMax;
+};
+
+class SpamDetector {
+public:
+    // Shape of an advert already parsed and classified
+    static SpamShape shapeOf(const BLEAdvert& ad, BLEClass cls);
+    static const char* shapeName(SpamShape shape);
+    
+    // NimBLE task: every advert of a scan
+    void noteAdvert(const uint8_t* mac, int8_t rssi, const BLEAdvert& ad, BLEClass cls);
+    
+    // Main loop: rates and alerts, once per window
+    void update();
+    uint32_t nextWakeMs() const;
+    
+private:
+    SpamWindow _windows[(uint8_t)SpamShape::COUNT];
+    uint8_t _addrs[(uint8_t)SpamShape::COUNT][2][SPAM_ADDR_BITS / 8];
+    uint8_t _gen = 0;               // Current generation of _addrs
+    uint8_t _genWindows = 0;        // Windows into it
+    uint8_t _warm = 0;              // Windows since the memory was cleared, saturates
+    uint16_t _fillStart[(uint8_t)SpamShape::COUNT];    // Bits set in either generation
+    SpamFlood _floodState[(uint8_t)SpamShape::COUNT];
+    volatile bool _active = false;  // Adverts or a flood to look at
+    uint32_t _windowStart = 0;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    
+    uint16_t fill(uint8_t shape) const;
+    void judge(SpamShape shape, const SpamWindow& w, uint16_t fillBits, uint32_t elapsed, uint32_t now);
+    void alert(SpamShape shape, const SpamFlood& f, uint32_t now, bool over);
+};
+
+// Global instance
+extern SpamDetector spamDetector;
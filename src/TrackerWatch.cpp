@@ -0,0 +1,238 @@
+/**
+ * ESP32 Marauder TUI - Tracker Watch
+ *
+ * The NimBLE task only updates the table; alerts and place changes are
+ * worked out on the main loop once per window, so an alert comes at
+ * most TRACKER_WINDOW_MS late.
+ */
+
+#include "TrackerWatch.h"
+#include "BTAttacks.h"
+#include "SerialTUI.h"
+#include "EventLoop.h"
+#include "EventStream.h"
+
+TrackerWatch trackerWatch;
+
+// FNV-1a over the bytes of a tracker advert that a rotation keeps
+uint32_t TrackerWatch::fingerprint(BLEClass cls, const BLEAdvert& ad) {
+    uint32_t h = 2166136261u;
+    auto mix = [&h](uint8_t b) { h = (h ^ b) * 16777619u; };
+    mix((uint8_t)cls);
+    switch (cls) {
+        case BLEClass::AIRTAG:
+            // Find My: type, length (separated or near owner), status
+            // (device type, battery); the rest is the rotating key
+            for (uint8_t i = 0; i < 3 && i < ad.mfrLen; i++) mix(ad.mfr[i]);
+            break;
+        case BLEClass::SAMSUNG_TAG:
+            // SmartTag: version and state, then (after the aging counter
+            // and the rotating privacy ID) region and battery
+            mix(ad.serviceDataLen);
+            if (ad.serviceDataLen > 0) mix(ad.serviceData[0]);
+            if (ad.serviceDataLen > 13) mix(ad.serviceData[13]);
+            break;
+        default:
+            // Tile does not rotate its payload
+            for (uint8_t i = 0; i < ad.serviceDataLen; i++) mix(ad.serviceData[i]);
+            break;
+    }
+    return h;
+}
+
+// Same address first, then the one quiet entry with the same fingerprint
+// (its address rotated); with none or several, a new entry
+Tracker* TrackerWatch::find(const uint8_t* mac, BLEClass cls, uint32_t fp, uint32_t window) {
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_trackers[i].cls == cls && memcmp(_trackers[i].mac, mac, 6) == 0) return &_trackers[i];
+    }
+    Tracker* rotated = nullptr;
+    for (uint8_t i = 0; i < _count; i++) {
+        Tracker& t = _trackers[i];
+        if (t.cls != cls || t.fingerprint != fp || t.lastSeen / TRACKER_WINDOW_MS == window) continue;
+        if (rotated) return nullptr;
+        rotated = &t;
+    }
+    return rotated;
+}
+
+void TrackerWatch::restart(Tracker& t, uint32_t now) {
+    t.alerted = false;
+    t.firstSeen = now;
+    t.windows = 0;
+    t.lastPlace = _place;
+    t.places = 1;
+    t.sampleHead = 0;
+    t.sampleCount = 0;
+}
+
+void TrackerWatch::noteAdvert(const uint8_t* mac, int8_t rssi, BLEClass cls, const BLEAdvert& ad) {
+    uint32_t fp = fingerprint(cls, ad);
+    uint32_t now = millis();
+    uint32_t window = now / TRACKER_WINDOW_MS;
+    
+    portENTER_CRITICAL(&_mux);
+    Tracker* t = find(mac, cls, fp, window);
+    if (t == nullptr) {
+        if (_count < TRACKER_TABLE_LEN) {
+            t = &_trackers[_count++];
+        } else {
+            // Forget the tracker heard from least recently
+            t = &_trackers[0];
+            for (uint8_t i = 1; i < _count; i++) {
+                if ((int32_t)(_trackers[i].lastSeen - t->lastSeen) < 0) t = &_trackers[i];
+            }
+        }
+        memcpy(t->mac, mac, 6);
+        t->cls = cls;
+        t->fingerprint = fp;
+        t->addresses = 1;
+        restart(*t, now);
+    } else {
+        if (memcmp(t->mac, mac, 6) != 0) {
+            memcpy(t->mac, mac, 6);
+            if (t->addresses < UINT8_MAX) t->addresses++;
+        }
+        if (now - t->lastSeen >= TRACKER_GAP_MS) restart(*t, now);
+    }
+    t->lastSeen = now;
+    if (t->lastPlace != _place) {
+        t->lastPlace = _place;
+        if (t->places < UINT8_MAX) t->places++;
+    }
+    
+    TrackerSample* s = t->sampleCount ? &t->samples[(t->sampleHead + t->sampleCount - 1) % TRACKER_SAMPLES] : nullptr;
+    if (s == nullptr || s->window != window) {
+        if (t->sampleCount < TRACKER_SAMPLES) {
+            t->sampleCount++;
+        } else {
+            t->sampleHead = (t->sampleHead + 1) % TRACKER_SAMPLES;
+        }
+        s = &t->samples[(t->sampleHead + t->sampleCount - 1) % TRACKER_SAMPLES];
+        s->window = window;
+        s->rssi = rssi;
+        s->adverts = 0;
+        t->windows++;
+    }
+    if (rssi > s->rssi) s->rssi = rssi;
+    if (s->adverts < UINT8_MAX) s->adverts++;
+    portEXIT_CRITICAL(&_mux);
+}
+
+bool TrackerWatch::following(const Tracker& t) const {
+    uint32_t span = t.lastSeen - t.firstSeen;
+    if (t.alerted || span < _followMs || t.places < _minPlaces) return false;
+    uint32_t expected = span / TRACKER_WINDOW_MS + 1;
+    return (uint32_t)t.windows * 100 >= expected * TRACKER_PRESENCE_PCT;
+}
+
+void TrackerWatch::update() {
+    uint32_t now = millis();
+    uint32_t window = now / TRACKER_WINDOW_MS;
+    if (window == _window) return;
+    
+    // The window just ended: did the BLE neighbourhood turn over? Not
+    // known if the device table overflowed, so re-added addresses look new
+    uint32_t evictions = btAttacks.evictions();
+    if (window == _window + 1 && evictions == _windowEvictions) {
+        uint8_t active = 0;
+        uint8_t fresh = 0;
+        if (btAttacks.churn(_window * TRACKER_WINDOW_MS, &active, &fresh) &&
+            active >= TRACKER_MOVE_MIN && fresh * 100 >= active * TRACKER_MOVE_PCT) {
+            moved();
+            char buf[64];
+            snprintf(buf, sizeof(buf), "Tracker watch: new place (%u of %u BLE devices new)",
+                     fresh, active);
+            tui.printResult(buf, ResultKind::INFO);
+        }
+    }
+    _window = window;
+    _windowEvictions = evictions;
+    
+    // One at a time, so only one entry is copied out of the lock
+    for (;;) {
+        Tracker due;
+        bool have = false;
+        portENTER_CRITICAL(&_mux);
+        for (uint8_t i = 0; i < _count && !have; i++) {
+            if (following(_trackers[i])) {
+                _trackers[i].alerted = true;
+                due = _trackers[i];
+                have = true;
+            }
+        }
+        portEXIT_CRITICAL(&_mux);
+        if (!have) break;
+        alert(due);
+    }
+}
+
+uint32_t TrackerWatch::nextWakeMs() const {
+    if (_count == 0) return EventLoop::FOREVER;
+    uint32_t now = millis();
+    return msUntil(_window * TRACKER_WINDOW_MS, TRACKER_WINDOW_MS, now);
+}
+
+void TrackerWatch::alert(const Tracker& t) {
+    const TrackerSample& last = t.samples[(t.sampleHead + t.sampleCount - 1) % TRACKER_SAMPLES];
+    char buf[64];
+    snprintf(buf, sizeof(buf), "FOLLOWED? %s %02x:%02x:%02x:%02x:%02x:%02x %lu min, %u places",
+             BLEAdvert::className(t.cls), t.mac[0], t.mac[1], t.mac[2], t.mac[3], t.mac[4], t.mac[5],
+             (unsigned long)((t.lastSeen - t.firstSeen) / 60000), t.places);
+             
+    ResultMeta meta(last.rssi, 0, t.mac);
+    tui.printResult(buf, ResultKind::AIRTAG, ResultQueue::keyOf(t.mac, 6), &meta);
+    eventStream.emit(StreamEvent(StreamType::TRACKER)
+        .setMac(t.mac).setRssi(last.rssi).setClass((uint8_t)t.cls).setCount(t.windows));
+    _alerts++;
+}
+
+void TrackerWatch::moved() {
+    portENTER_CRITICAL(&_mux);
+    _place++;
+    portEXIT_CRITICAL(&_mux);
+}
+
+void TrackerWatch::clear() {
+    portENTER_CRITICAL(&_mux);
+    _count = 0;
+    _place = 0;
+    portEXIT_CRITICAL(&_mux);
+    _alerts = 0;
+}
+
+void TrackerWatch::printStatus() {
+    char buf[64];
+    uint32_t now = millis();
+    snprintf(buf, sizeof(buf), "Trackers: %u, place %u, alert at %lu min / %u places, %lu alerts",
+             _count, _place, (unsigned long)(_followMs / 60000), _minPlaces, (unsigned long)_alerts);
+    tui.printStatus(buf);
+    
+    for (uint8_t i = 0; i < TRACKER_TABLE_LEN; i++) {
+        Tracker t;
+        portENTER_CRITICAL(&_mux);
+        bool have = i < _count;
+        if (have) t = _trackers[i];
+        portEXIT_CRITICAL(&_mux);
+        if (!have) break;
+        
+        snprintf(buf, sizeof(buf), "%s %02x:%02x:%02x:%02x:%02x:%02x %lu min %u win %u pl %u addr%s",
+                 BLEAdvert::className(t.cls), t.mac[0], t.mac[1], t.mac[2], t.mac[3], t.mac[4], t.mac[5],
+                 (unsigned long)((t.lastSeen - t.firstSeen) / 60000), t.windows, t.places,
+                 t.addresses, t.alerted ? " !" : "");
+        tui.printResult(buf, ResultKind::INFO);
+        
+        // Peak RSSI of the latest windows, '.' for each window missed
+        int pos = snprintf(buf, sizeof(buf), "  heard %lus ago:", (unsigned long)((now - t.lastSeen) / 1000));
+        uint8_t first = t.sampleCount > 8 ? t.sampleCount - 8 : 0;
+        for (uint8_t j = first; j < t.sampleCount && pos < (int)sizeof(buf); j++) {
+            const TrackerSample& s = t.samples[(t.sampleHead + j) % TRACKER_SAMPLES];
+            if (j > first) {
+                uint32_t prev = t.samples[(t.sampleHead + j - 1) % TRACKER_SAMPLES].window;
+                if (s.window - prev > 1) pos += snprintf(buf + pos, sizeof(buf) - pos, " .");
+            }
+            if (pos < (int)sizeof(buf)) pos += snprintf(buf + pos, sizeof(buf) - pos, " %d", s.rssi);
+        }
+        tui.printResult(buf, ResultKind::INFO);
+    }
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include "BLEAdvert.h"
+#include <freertos/FreeRTOS.h>
+
+// ============================================
+// Tracker Watch
+// Is a tracker travelling with me?
+// ============================================
+//
+// An AirTag scan only says a Find My advert is in range, which it is in
+// any crowd. What matters is one tracker that stays: this keeps, for up
+// to TRACKER_TABLE_LEN trackers (AirTag / Find My, SmartTag, Tile) heard
+// by any BLE scan, when it was first and last heard, the sighting
+// windows (TRACKER_WINDOW_MS) it was heard in, with their peak RSSI, and
+// the places it was heard at.
+//
+// Trackers change address (Find My and SmartTag every 15 min or so), so
+// a new address joins an existing entry when its payload fingerprint -
+// the bytes that survive a rotation, such as the Find My status byte -
+// matches. Those bytes are the same for most tags of a kind, so only an
+// entry whose address has gone quiet (unheard in the current window)
+// can take it over, and only if it is the one such entry; otherwise the
+// address starts an entry of its own. A rotation in mid-window thus
+// also starts a new entry, but a crowd of tags does not merge into one.
+//
+// There is no GPS. A place is counted each time the BLE neighbourhood
+// turns over (TRACKER_MOVE_PCT of the devices in a window are new to
+// the scan) or on :tracker moved. A window in which the BLE device table
+// was full and evicted entries is not judged: an evicted address comes
+// back as new, so in a crowd every window would look like a move.
+//
+// One alert per tracker, once it has been around TRACKER_FOLLOW_MS, was
+// heard in TRACKER_PRESENCE_PCT of its windows, and at TRACKER_MIN_PLACES
+// places. A tracker unheard for TRACKER_GAP_MS starts over.
+
+struct TrackerSample {
+    uint32_t window;        // millis() / TRACKER_WINDOW_MS
+    int8_t rssi;            // Peak in the window
+    uint8_t adverts;        // Saturates at 255
+};
+
+struct Tracker {
+    uint8_t mac[6];         // Latest address, display order
+    BLEClass cls;
+    bool alerted;
+    uint32_t fingerprint;
+    uint32_t firstSeen;
+    uint32_t lastSeen;
+    uint16_t windows;       // Windows heard in since firstSeen
+    uint16_t lastPlace;
+    uint8_t places;
+    uint8_t addresses;      // Addresses merged in, saturates at 255
+    uint8_t sampleHead;     // Oldest of sampleCount
+    uint8_t sampleCount;
+    TrackerSample samples[TRACKER_SAMPLES];
+};
+
+class TrackerWatch {
+public:
+    static bool isTracker(BLEClass cls) {
+        return cls == BLEClass::AIRTAG || cls == BLEClass::SAMSUNG_TAG || cls == BLEClass::TILE;
+    }
+    
+    // NimBLE task: one advert already classified as a tracker
+    void noteAdvert(const uint8_t* mac, int8_t rssi, BLEClass cls, const BLEAdvert& ad);
+    
+    // Main loop: place changes and alerts, once per window
+    void update();
+    uint32_t nextWakeMs() const;
+    
+    void moved();
+    void clear();
+    void setFollowMs(uint32_t ms) { _followMs = ms; }
+    void setMinPlaces(uint8_t places) { _minPlaces = places; }
+    uint32_t followMs() const { return _followMs; }
+    uint8_t minPlaces() const { return _minPlaces; }
+    
+    // One line per tracker plus its recent RSSI
+    void printStatus();
+    
+private:
+    Tracker _trackers[TRACKER_TABLE_LEN];
+    uint8_t _count = 0;
+    uint16_t _place = 0;
+    uint32_t _window = 0;
+    uint32_t _windowEvictions = 0;  // BTAttacks::evictions() when it started
+    uint32_t _alerts = 0;
+    uint32_t _followMs = TRACKER_FOLLOW_MS;
+    uint8_t _minPlaces = TRACKER_MIN_PLACES;
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    
+    static uint32_t fingerprint(BLEClass cls, const BLEAdvert& ad);
+    Tracker* find(const uint8_t* mac, BLEClass cls, uint32_t fp, uint32_t window);
+    void restart(Tracker& t, uint32_t now);
+    bool following(const Tracker& t) const;
+    void alert(const Tracker& t);
+};
+
+// Global instance
+extern TrackerWatch trackerWatch;
@@ -0,0 +1,508 @@
+/**
+ * ESP32 Marauder TUI - Transport
+ *
+ * Console backends. Each one wakes the main loop on RX (UART_RX event)
+ * and reports TX space through availableForWrite(), so the result queue
+ * and event stream drain at whatever rate the active link sustains.
+ */
+
+#include "Transport.h"
+#include "EventLoop.h"
+#include <NimBLEDevice.h>
+#include <esp_random.h>
+
+Console console;
+
+// UART0 is Serial unless the board routes Serial to native USB
+#if ARDUINO_USB_CDC_ON_BOOT
+#define UART_PORT Serial0
+#else
+#define UART_PORT Serial
+#endif
+
+static const uint32_t USB_ATTACH_WAIT_MS = 2000;  // Boot wait for a USB host
+
+uint32_t Transport::nextWakeMs() const {
+    return EventLoop::FOREVER;
+}
+
+// ============================================
+// UART
+// ============================================
+
+static const uint32_t UART_BAUDS[] = {
+    9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1500000, 2000000
+};
+
+bool UartTransport::validBaud(uint32_t baud) {
+    for (uint32_t b : UART_BAUDS) {
+        if (b == baud) return true;
+    }
+    return false;
+}
+
+bool UartTransport::begin() {
+    if (_started) return true;
+    UART_PORT.begin(_baud);
+    UART_PORT.onReceive([]() { events.post(EventType::UART_RX); });
+    _started = true;
+    return true;
+}
+
+bool UartTransport::setBaud(uint32_t baud) {
+    if (!validBaud(baud)) return false;
+    UART_PORT.flush();
+    UART_PORT.updateBaudRate(baud);
+    _baud = baud;
+    return true;
+}
+
+int UartTransport::available() { return UART_PORT.available(); }
+int UartTransport::read() { return UART_PORT.read(); }
+int UartTransport::peek() { return UART_PORT.peek(); }
+size_t UartTransport::write(uint8_t c) { return UART_PORT.write(c); }
+size_t UartTransport::write(const uint8_t* buf, size_t len) { return UART_PORT.write(buf, len); }
+int UartTransport::availableForWrite() { return UART_PORT.availableForWrite(); }
+void UartTransport::flush() { UART_PORT.flush(); }
+
+// ============================================
+// USB-CDC (USB Serial/JTAG controller)
+// ============================================
+
+#if SOC_USB_SERIAL_JTAG_SUPPORTED
+
+static UsbCdcTransport* usbLink = nullptr;  // HWCDC events carry no user argument
+
+static void onUsbEvent(void* arg, esp_event_base_t base, int32_t id, void* data) {
+    if (id == ARDUINO_HW_CDC_CONNECTED_EVENT && usbLink) {
+        usbLink->noteAttached();
+    }
+    events.post(EventType::UART_RX);
+}
+
+bool UsbCdcTransport::begin() {
+    if (_started) return true;
+    usbLink = this;
+    HWCDCSerial.begin();
+    HWCDCSerial.onEvent(ARDUINO_HW_CDC_RX_EVENT, onUsbEvent);
+    HWCDCSerial.onEvent(ARDUINO_HW_CDC_CONNECTED_EVENT, onUsbEvent);
+    
+    // Give a host that is already plugged in time to open the port, but
+    // boot headless (e.g. for the BLE link) if none shows up
+    unsigned long start = millis();
+    while (!HWCDCSerial && millis() - start < USB_ATTACH_WAIT_MS) delay(10);
+    
+    _started = true;
+    return true;
+}
+
+bool UsbCdcTransport::connected() const { return (bool)HWCDCSerial; }
+int UsbCdcTransport::available() { return HWCDCSerial.available(); }
+int UsbCdcTransport::read() { return HWCDCSerial.read(); }
+int UsbCdcTransport::peek() { return HWCDCSerial.peek(); }
+size_t UsbCdcTransport::write(uint8_t c) { return HWCDCSerial.write(c); }
+size_t UsbCdcTransport::write(const uint8_t* buf, size_t len) { return HWCDCSerial.write(buf, len); }
+int UsbCdcTransport::availableForWrite() { return HWCDCSerial.availableForWrite(); }
+void UsbCdcTransport::flush() { HWCDCSerial.flush(); }
+
+#else
+
+// No USB Serial/JTAG controller (ESP32 classic): the link is unavailable
+bool UsbCdcTransport::begin() { return false; }
+bool UsbCdcTransport::connected() const { return false; }
+int UsbCdcTransport::available() { return 0; }
+int UsbCdcTransport::read() { return -1; }
+int UsbCdcTransport::peek() { return -1; }
+size_t UsbCdcTransport::write(uint8_t c) { return 1; }
+size_t UsbCdcTransport::write(const uint8_t* buf, size_t len) { return len; }
+int UsbCdcTransport::availableForWrite() { return 0; }
+void UsbCdcTransport::flush() {}
+
+#endif
+
+// ============================================
+// BLE Nordic UART Service
+// ============================================
+// Host writes keystrokes to RX, we notify output on TX in MTU-sized
+// chunks. Output is buffered and sent a chunk at a time; a partial chunk
+// goes out on the next service() so print() calls coalesce into packets.
+//
+// The console can start attacks, so the link must be paired first: a
+// bonded, encrypted link authenticated with the passkey. Both
+// characteristics require encryption and the link only counts as
+// connected once pairing completes; a central that fails it is dropped.
+
+static const char* const NUS_SERVICE = "6E400001-B5A3-F393-E0A9-E50E24DCCA9E";
+static const char* const NUS_RX = "6E400002-B5A3-F393-E0A9-E50E24DCCA9E";
+static const char* const NUS_TX = "6E400003-B5A3-F393-E0A9-E50E24DCCA9E";
+static const uint16_t NUS_MTU = 247;
+static const uint16_t NUS_MAX_CHUNK = NUS_MTU - 3;
+
+static NimBLECharacteristic* nusTx = nullptr;
+
+class NusServerCallbacks : public NimBLEServerCallbacks {
+public:
+    explicit NusServerCallbacks(BleNusTransport& link) : _link(link) {}
+    
+    void onConnect(NimBLEServer* server, NimBLEConnInfo& info) override {
+        _link.onConnect(info.getConnHandle(), info.getMTU());
+    }
+    void onDisconnect(NimBLEServer* server, NimBLEConnInfo& info, int reason) override {
+        _link.onDisconnect();
+    }
+    void onMTUChange(uint16_t mtu, NimBLEConnInfo& info) override {
+        _link.onMtu(mtu);
+    }
+    void onAuthenticationComplete(NimBLEConnInfo& info) override {
+        bool ok = info.isEncrypted() && info.isAuthenticated() && info.isBonded();
+        if (!ok) NimBLEDevice::getServer()->disconnect(info.getConnHandle());
+        _link.onSecured(ok);
+    }
+    uint32_t onPassKeyDisplay() override {
+        return BleNusTransport::passkey();
+    }
+    
+private:
+    BleNusTransport& _link;
+};
+
+class NusRxCallbacks : public NimBLECharacteristicCallbacks {
+public:
+    explicit NusRxCallbacks(BleNusTransport& link) : _link(link) {}
+    
+    void onWrite(NimBLECharacteristic* chr, NimBLEConnInfo& info) override {
+        NimBLEAttValue value = chr->getValue();
+        _link.onRx(value.data(), value.size());
+    }
+    
+private:
+    BleNusTransport& _link;
+};
+
+// Anyone in range can try to pair, so no fixed default: the owner reads
+// this boot's passkey off the wired console
+uint32_t BleNusTransport::passkey() {
+#ifdef CONSOLE_BLE_PASSKEY
+    return CONSOLE_BLE_PASSKEY;
+#else
+    static uint32_t key = esp_random() % 1000000;
+    return key;
+#endif
+}
+
+bool BleNusTransport::begin() {
+    if (_started) return true;
+    
+    NimBLEDevice::init("");
+    NimBLEDevice::setMTU(NUS_MTU);
+    
+    static NusServerCallbacks serverCallbacks(*this);
+    static NusRxCallbacks rxCallbacks(*this);
+    
+    NimBLEServer* server = NimBLEDevice::createServer();
+    server->setCallbacks(&serverCallbacks, false);
+    server->advertiseOnDisconnect(true);
+    
+    NimBLEService* service = server->createService(NUS_SERVICE);
+    nusTx = service->createCharacteristic(
+        NUS_TX, NIMBLE_PROPERTY::NOTIFY | NIMBLE_PROPERTY::READ | NIMBLE_PROPERTY::READ_ENC |
+                NIMBLE_PROPERTY::READ_AUTHEN);
+    NimBLECharacteristic* rx = service->createCharacteristic(
+        NUS_RX, NIMBLE_PROPERTY::WRITE | NIMBLE_PROPERTY::WRITE_NR | NIMBLE_PROPERTY::WRITE_ENC |
+                NIMBLE_PROPERTY::WRITE_AUTHEN);
+    rx->setCallbacks(&rxCallbacks);
+    service->start();
+    server->start();
+    
+    _started = true;
+    resume();
+    return true;
+}
+
+void BleNusTransport::resume() {
+    if (!_started) return;
+    
+    // A restarted host (after a classic inquiry) is back to no security
+    NimBLEDevice::setSecurityAuth(true, true, true);
+    NimBLEDevice::setSecurityIOCap(BLE_HS_IO_DISPLAY_ONLY);
+    NimBLEDevice::setSecurityPasskey(passkey());
+    
+    // Spam modes replace the advertisement (and advertiseOnDisconnect
+    // would re-use theirs), so rebuild ours every time
+    NimBLEAdvertising* adv = NimBLEDevice::getAdvertising();
+    adv->stop();
+    adv->reset();
+    adv->setName(CONSOLE_BLE_NAME);
+    adv->addServiceUUID(NimBLEUUID(NUS_SERVICE));
+    if (_conn == NO_CONN) adv->start();
+}
+
+// Not the console yet: that waits for pairing
+void BleNusTransport::onConnect(uint16_t conn, uint16_t mtu) {
+    _secure = false;
+    _conn = conn;
+    onMtu(mtu);
+}
+
+void BleNusTransport::onSecured(bool ok) {
+    _secure = ok;
+    if (!ok) return;
+    _attached = true;
+    events.post(EventType::UART_RX);
+}
+
+void BleNusTransport::onDisconnect() {
+    _conn = NO_CONN;
+    _secure = false;
+    events.post(EventType::UART_RX);
+}
+
+void BleNusTransport::onMtu(uint16_t mtu) {
+    _chunk = constrain(mtu - 3, 20, NUS_MAX_CHUNK);
+}
+
+void BleNusTransport::onRx(const uint8_t* data, size_t len) {
+    // The stack refuses unencrypted writes; this is belt and braces
+    if (!_secure) return;
+    portENTER_CRITICAL(&_mux);
+    for (size_t i = 0; i < len && _rxUsed < RX_BUF; i++) {
+        _rx[(_rxHead + _rxUsed) % RX_BUF] = data[i];
+        _rxUsed++;
+    }
+    portEXIT_CRITICAL(&_mux);
+    events.post(EventType::UART_RX);
+}
+
+int BleNusTransport::available() {
+    return _rxUsed;
+}
+
+int BleNusTransport::read() {
+    int c = -1;
+    portENTER_CRITICAL(&_mux);
+    if (_rxUsed > 0) {
+        c = _rx[_rxHead];
+        _rxHead = (_rxHead + 1) % RX_BUF;
+        _rxUsed--;
+    }
+    portEXIT_CRITICAL(&_mux);
+    return c;
+}
+
+int BleNusTransport::peek() {
+    portENTER_CRITICAL(&_mux);
+    int c = _rxUsed > 0 ? _rx[_rxHead] : -1;
+    portEXIT_CRITICAL(&_mux);
+    return c;
+}
+
+size_t BleNusTransport::write(uint8_t c) {
+    return write(&c, 1);
+}
+
+size_t BleNusTransport::write(const uint8_t* buf, size_t len) {
+    // Nobody connected: discard, like an unplugged cable
+    if (!connected()) {
+        _txHead = 0;
+        _txUsed = 0;
+        return len;
+    }
+    
+    size_t done = 0;
+    unsigned long start = millis();
+    while (done < len) {
+        size_t room = sizeof(_tx) - _txUsed;
+        if (room == 0) {
+            // Full: block briefly like a UART would, then give up
+            if (!pump()) {
+                if (!connected() || millis() - start >= TX_TIMEOUT_MS) break;
+                delay(1);
+            }
+            continue;
+        }
+        
+        size_t tail = (_txHead + _txUsed) % sizeof(_tx);
+        size_t n = min(min(room, len - done), sizeof(_tx) - tail);
+        memcpy(_tx + tail, buf + done, n);
+        _txUsed += n;
+        done += n;
+    }
+    
+    // Send whole packets now; the remainder waits for service()
+    if (_txUsed >= _chunk && !_txStalled) pump();
+    return done;
+}
+
+int BleNusTransport::availableForWrite() {
+    return connected() ? sizeof(_tx) - _txUsed : sizeof(_tx);
+}
+
+void BleNusTransport::flush() {
+    unsigned long start = millis();
+    while (_txUsed > 0 && connected() && millis() - start < TX_TIMEOUT_MS) {
+        if (!pump()) delay(1);
+    }
+}
+
+bool BleNusTransport::pump() {
+    uint8_t packet[NUS_MAX_CHUNK];
+    bool sent = false;
+    
+    while (_txUsed > 0 && connected()) {
+        size_t n = min(min(_txUsed, (size_t)_chunk), sizeof(packet));
+        size_t first = min(n, sizeof(_tx) - _txHead);
+        memcpy(packet, _tx + _txHead, first);
+        memcpy(packet + first, _tx, n - first);
+        
+        if (!nusTx->notify(packet, n, _conn)) {
+            // Controller out of buffers; retry shortly
+            _txStalled = true;
+            _stallTime = millis();
+            break;
+        }
+        _txHead = (_txHead + n) % sizeof(_tx);
+        _txUsed -= n;
+        _txStalled = false;
+        sent = true;
+    }
+    return sent;
+}
+
+void BleNusTransport::service() {
+    if (!connected()) {
+        _txHead = 0;
+        _txUsed = 0;
+        return;
+    }
+    if (_txStalled && millis() - _stallTime < TX_RETRY_MS) return;
+    pump();
+}
+
+uint32_t BleNusTransport::nextWakeMs() const {
+    if (_txUsed == 0 || !connected()) return EventLoop::FOREVER;
+    return _txStalled ? msUntil(_stallTime, TX_RETRY_MS, millis()) : 0;
+}
+
+// ============================================
+// Console
+// ============================================
+
+static const char* const KIND_NAMES[] = {"uart", "usb", "ble"};
+
+const char* Console::kindName(TransportKind kind) {
+    return KIND_NAMES[(uint8_t)kind];
+}
+
+bool Console::supports(TransportKind kind) {
+#if !SOC_USB_SERIAL_JTAG_SUPPORTED
+    if (kind == TransportKind::USB_CDC) return false;
+#endif
+    return kind < TransportKind::COUNT;
+}
+
+Transport* Console::linkFor(TransportKind kind) {
+    switch (kind) {
+        case TransportKind::UART:    return &_uart;
+        case TransportKind::USB_CDC: return &_usb;
+        case TransportKind::BLE_NUS: return &_ble;
+        default:                     return nullptr;
+    }
+}
+
+void Console::route(TransportKind kind) {
+    _link->flush();
+    _kind = kind;
+    _link = linkFor(kind);
+    _switched = true;
+}
+
+void Console::begin() {
+    _home = CONSOLE_TRANSPORT;
+    if (!supports(_home) || !linkFor(_home)->begin()) {
+        _home = TransportKind::UART;
+        _uart.begin();
+    }
+    _kind = _home;
+    _link = linkFor(_home);
+    
+#if CONSOLE_BLE_ATTACH
+    _ble.begin();
+#endif
+}
+
+bool Console::use(TransportKind kind) {
+    if (kind == _kind) return true;
+    Transport* link = linkFor(kind);
+    if (!supports(kind) || !link->begin()) return false;
+    
+    // Keep the last confirmed link as the fallback across repeated switches
+    if (!_probation) {
+        _prevKind = _kind;
+        _prevBaud = _uart.baud();
+    }
+    _probation = true;
+    _probationStart = millis();
+    route(kind);
+    return true;
+}
+
+bool Console::setBaud(uint32_t baud) {
+    if (_kind != TransportKind::UART || !UartTransport::validBaud(baud)) return false;
+    
+    if (!_probation) {
+        _prevKind = _kind;
+        _prevBaud = _uart.baud();
+    }
+    _probation = true;
+    _probationStart = millis();
+    _uart.setBaud(baud);
+    _switched = true;
+    return true;
+}
+
+int Console::read() {
+    int c = _link->read();
+    if (c >= 0) _probation = false;  // Someone is there: the new link sticks
+    return c;
+}
+
+bool Console::takeAttached() {
+    bool attached = _link->takeAttached() || _switched;
+    _switched = false;
+    return attached;
+}
+
+void Console::update() {
+#if CONSOLE_BLE_ATTACH
+    // A central pairing with the NUS takes the console. Only a fresh
+    // pairing counts, so ":console uart" from a BLE session sticks.
+    if (_kind != TransportKind::BLE_NUS && !_probation && _ble.takeAttached() && _ble.connected()) {
+        route(TransportKind::BLE_NUS);
+    }
+#endif
+
+    // Central gone: back to the boot link rather than talking to nobody
+    if (_kind == TransportKind::BLE_NUS && _home != TransportKind::BLE_NUS &&
+        !_probation && !_ble.connected()) {
+        route(_home);
+    }
+    
+    if (_probation && millis() - _probationStart >= CONSOLE_CONFIRM_MS) {
+        // Nobody answered on the new link/rate: restore the old one
+        _probation = false;
+        if (_kind != _prevKind) route(_prevKind);
+        if (_uart.baud() != _prevBaud) _uart.setBaud(_prevBaud);
+        _switched = true;
+    }
+    
+    _link->service();
+}
+
+uint32_t Console::nextWakeMs() const {
+    if (_switched) return 0;
+    uint32_t wake = _link->nextWakeMs();
+    if (_probation) {
+        wake = min(wake, msUntil(_probationStart, CONSOLE_CONFIRM_MS, millis()));
+    }
+    return wake;
+}
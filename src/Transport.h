@@ -0,0 +1,200 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Config.h"
+#include <freertos/FreeRTOS.h>
+
+// ============================================
+// Transport
+// Byte links the console (TUI + capture stream) can run over
+// ============================================
+//
+// Everything that used to talk to Serial goes through `console`, a Stream
+// that forwards to the active backend:
+//  - UART      UART0 pins / USB-UART bridge; baud changeable at runtime
+//  - USB_CDC   native USB Serial/JTAG (ESP32-C6/S3/C3), no baud limit
+//  - BLE_NUS   Nordic UART Service over BLE, for headless use
+//
+// Switching link or baud is on probation: unless a key arrives over the
+// new link within CONSOLE_CONFIRM_MS, the previous one is restored, so a
+// wrong rate or an unreachable link cannot lock the user out.
+
+enum class TransportKind : uint8_t {
+    UART,
+    USB_CDC,
+    BLE_NUS,
+    COUNT
+};
+
+class Transport : public Stream {
+public:
+    // false if the link does not exist on this board
+    virtual bool begin() = 0;
+    
+    // Main loop: push buffered output, etc.
+    virtual void service() {}
+    virtual uint32_t nextWakeMs() const;
+    
+    // A host (re)connected since the last call; the TUI repaints
+    bool takeAttached() {
+        bool attached = _attached;
+        _attached = false;
+        return attached;
+    }
+    virtual bool connected() const { return true; }
+    
+    // The BLE link lost its advertising to another BT mode; restore it
+    virtual void resume() {}
+    
+protected:
+    volatile bool _attached = false;
+};
+
+class UartTransport : public Transport {
+public:
+    bool begin() override;
+    
+    bool setBaud(uint32_t baud);
+    uint32_t baud() const { return _baud; }
+    static bool validBaud(uint32_t baud);
+    
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t len) override;
+    int availableForWrite() override;
+    void flush() override;
+    
+private:
+    bool _started = false;
+    uint32_t _baud = SERIAL_BAUD;
+};
+
+class UsbCdcTransport : public Transport {
+public:
+    bool begin() override;
+    bool connected() const override;
+    
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t len) override;
+    int availableForWrite() override;
+    void flush() override;
+    
+    void noteAttached() { _attached = true; }
+    
+private:
+    bool _started = false;
+};
+
+class BleNusTransport : public Transport {
+public:
+    bool begin() override;
+    // Only once paired: bonded, encrypted and passkey-authenticated
+    bool connected() const override { return _conn != NO_CONN && _secure; }
+    void service() override;
+    uint32_t nextWakeMs() const override;
+    void resume() override;
+    
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buf, size_t len) override;
+    int availableForWrite() override;
+    void flush() override;
+    
+    // NimBLE host task
+    void onConnect(uint16_t conn, uint16_t mtu);
+    void onSecured(bool ok);
+    void onDisconnect();
+    void onMtu(uint16_t mtu);
+    void onRx(const uint8_t* data, size_t len);
+    
+    // Six digits, drawn once per boot unless CONSOLE_BLE_PASSKEY is set
+    static uint32_t passkey();
+    
+private:
+    static const uint16_t NO_CONN = 0xFFFF;
+    static const uint16_t RX_BUF = 256;
+    static const uint32_t TX_TIMEOUT_MS = 100;  // Blocking budget when TX is full
+    static const uint32_t TX_RETRY_MS = 5;      // Controller out of buffers
+    
+    bool _started = false;
+    volatile uint16_t _conn = NO_CONN;
+    volatile bool _secure = false;
+    volatile uint16_t _chunk = 20;              // ATT MTU - 3
+    
+    uint8_t _rx[RX_BUF];
+    uint16_t _rxHead = 0;
+    uint16_t _rxUsed = 0;
+    
+    // Main loop only
+    uint8_t _tx[BLE_NUS_TX_BUF];
+    size_t _txHead = 0;
+    size_t _txUsed = 0;
+    bool _txStalled = false;                    // Last notify refused
+    unsigned long _stallTime = 0;
+    
+    portMUX_TYPE _mux = portMUX_INITIALIZER_UNLOCKED;
+    
+    bool pump();
+};
+
+class Console : public Stream {
+public:
+    void begin();
+    void update();
+    uint32_t nextWakeMs() const;
+    
+    TransportKind kind() const { return _kind; }
+    uint32_t baud() const { return _uart.baud(); }
+    static bool supports(TransportKind kind);
+    static const char* kindName(TransportKind kind);
+    
+    // Move the console; reverts after CONSOLE_CONFIRM_MS without a key.
+    // False if the link is unavailable or the rate unsupported.
+    bool use(TransportKind kind);
+    bool setBaud(uint32_t baud);
+    bool onProbation() const { return _probation; }
+    
+    // Link changed, reverted or a host reattached: repaint everything
+    bool takeAttached();
+    
+    // BT spam owns advertising; hand it back to the BLE link afterwards
+    void resume() { _ble.resume(); }
+    
+    int available() override { return _link->available(); }
+    int read() override;
+    int peek() override { return _link->peek(); }
+    size_t write(uint8_t c) override { return _link->write(c); }
+    size_t write(const uint8_t* buf, size_t len) override { return _link->write(buf, len); }
+    int availableForWrite() override { return _link->availableForWrite(); }
+    void flush() override { _link->flush(); }
+    using Print::write;
+    
+private:
+    UartTransport _uart;
+    UsbCdcTransport _usb;
+    BleNusTransport _ble;
+    
+    Transport* _link = &_uart;
+    TransportKind _kind = TransportKind::UART;
+    TransportKind _home = TransportKind::UART;  // Boot link; a lost BLE session returns here
+    bool _switched = false;
+    
+    // Previous link/baud, restored if the new one is never confirmed
+    bool _probation = false;
+    TransportKind _prevKind = TransportKind::UART;
+    uint32_t _prevBaud = SERIAL_BAUD;
+    unsigned long _probationStart = 0;
+    
+    Transport* linkFor(TransportKind kind);
+    void route(TransportKind kind);
+};
+
+// Global instance
+extern Console console;
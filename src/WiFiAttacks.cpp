@@ -6,6 +6,13 @@
 
 #include "WiFiAttacks.h"
 #include "SerialTUI.h"
+#include "EventLoop.h"
+#include "LiveTable.h"
+#include "APSelector.h"
+#include "EventStream.h"
+#include "SessionStore.h"
+#include "FrameTrigger.h"
+#include "MacFilter.h"
 #include <esp_random.h>
 
 // ============================================
@@ -110,6 +117,7 @@ void WiFiAttacks::begin() {
     _mode = WiFiMode::IDLE;
     _channel = DEFAULT_CHANNEL;
     _callbackInstance = this;
+    if (_tableLock == nullptr) _tableLock = xSemaphoreCreateMutex();
     
     // Add some default SSIDs for beacon spam
     addSSID("FreeWiFi");
@@ -123,20 +131,20 @@ void WiFiAttacks::update() {
     uint32_t now = millis();
     
     // Handle channel hopping for sniffing modes
-    if (_channelHop) {
+    if (_channelHop && !_paused) {
         handleChannelHop();
     }
     
     switch (_mode) {
         case WiFiMode::ATTACK_DEAUTH:
-            if (now - _lastUpdate > 100) {
+            if (now - _lastUpdate >= ATTACK_INTERVAL) {
                 sendDeauthToAll();
                 _lastUpdate = now;
             }
             break;
             
         case WiFiMode::ATTACK_BEACON_RANDOM:
-            if (now - _lastUpdate > 100) {
+            if (now - _lastUpdate >= ATTACK_INTERVAL) {
                 sendRandomBeacon();
                 _lastUpdate = now;
             }
@@ -145,7 +153,7 @@ void WiFiAttacks::update() {
         case WiFiMode::ATTACK_BEACON_LIST:
         case WiFiMode::ATTACK_RICKROLL:
         case WiFiMode::ATTACK_FUNNY:
-            if (now - _lastUpdate > 100) {
+            if (now - _lastUpdate >= ATTACK_INTERVAL) {
                 sendListBeacon();
                 _lastUpdate = now;
             }
@@ -159,11 +167,17 @@ void WiFiAttacks::update() {
         case WiFiMode::SNIFF_PWN:
         case WiFiMode::SNIFF_RAW:
         case WiFiMode::SCAN_STATION:
-            // Status update
-            if (now - _lastUpdate > 2000) {
+        case WiFiMode::LIVE_VIEW:
+            // Statistics for the pinned status bar
+            if (now - _lastUpdate >= STATUS_INTERVAL) {
                 char buf[48];
                 snprintf(buf, sizeof(buf), "Packets: %lu | Ch: %d", _packetCount, _hopChannel);
-                tui.printStatus(buf);
+                tui.setStats(buf);
+                if (now - _lastStatsEvent >= STATS_EVENT_MS) {
+                    eventStream.emit(StreamEvent(StreamType::STATS)
+                        .setCount(_packetCount).setChannel(_hopChannel).setDrops(eventStream.drops()));
+                    _lastStatsEvent = now;
+                }
                 _lastUpdate = now;
             }
             break;
@@ -173,8 +187,40 @@ void WiFiAttacks::update() {
     }
 }
 
+uint32_t WiFiAttacks::nextWakeMs() const {
+    uint32_t now = millis();
+    uint32_t wait = EventLoop::FOREVER;
+    
+    switch (_mode) {
+        case WiFiMode::IDLE:
+        case WiFiMode::SCAN_AP:
+            return EventLoop::FOREVER;
+            
+        case WiFiMode::SURVEY:
+            break;      // RadioSurvey keeps the status bar
+            
+        case WiFiMode::ATTACK_DEAUTH:
+        case WiFiMode::ATTACK_BEACON_RANDOM:
+        case WiFiMode::ATTACK_BEACON_LIST:
+        case WiFiMode::ATTACK_RICKROLL:
+        case WiFiMode::ATTACK_FUNNY:
+            wait = msUntil(_lastUpdate, ATTACK_INTERVAL, now);
+            break;
+            
+        default:
+            wait = msUntil(_lastUpdate, STATUS_INTERVAL, now);
+            break;
+    }
+    
+    if (_channelHop && !_paused) {
+        wait = min(wait, msUntil(_lastHopTime, CHANNEL_HOP_INTERVAL, now));
+    }
+    return wait;
+}
+
 void WiFiAttacks::stop() {
     stopPromiscuous();
+    liveTable.end();
     
     char buf[64];
     snprintf(buf, sizeof(buf), "Stopped. Packets: %lu", _packetCount);
@@ -182,6 +228,7 @@ void WiFiAttacks::stop() {
     
     _mode = WiFiMode::IDLE;
     _packetCount = 0;
+    session.markDirty();  // The run may have added targets
 }
 
 // ============================================
@@ -191,8 +238,15 @@ void WiFiAttacks::stop() {
 void WiFiAttacks::startPromiscuous(bool channelHop) {
     _channelHop = channelHop;
     _hopChannel = channelHop ? 1 : _channel;
+    _hopPos = 0;
     _lastHopTime = millis();
     
+    if (channelHop && _hopListLen > 0) {
+        // Restricted plan; a single channel means no hopping at all
+        _hopChannel = _hopList[0];
+        _channelHop = _hopListLen > 1;
+    }
+    
     // Set channel
     esp_wifi_set_channel(_hopChannel, WIFI_SECOND_CHAN_NONE);
     
@@ -205,12 +259,31 @@ void WiFiAttacks::stopPromiscuous() {
     esp_wifi_set_promiscuous(false);
     esp_wifi_set_promiscuous_rx_cb(nullptr);
     _channelHop = false;
+    _paused = false;
+}
+
+void WiFiAttacks::pauseCapture(bool pause) {
+    if (pause == _paused) return;
+    uint32_t now = millis();
+    _paused = pause;
+    esp_wifi_set_promiscuous(!pause);
+    if (pause) {
+        _pausedAt = now;
+    } else {
+        // Time off the air does not count toward the channel dwell
+        _lastHopTime += now - _pausedAt;
+    }
 }
 
 void WiFiAttacks::handleChannelHop() {
     uint32_t now = millis();
     if (now - _lastHopTime >= CHANNEL_HOP_INTERVAL) {
-        _hopChannel = (_hopChannel % MAX_CHANNEL) + 1;
+        if (_hopListLen > 0) {
+            _hopPos = (_hopPos + 1) % _hopListLen;
+            _hopChannel = _hopList[_hopPos];
+        } else {
+            _hopChannel = (_hopChannel % MAX_CHANNEL) + 1;
+        }
         esp_wifi_set_channel(_hopChannel, WIFI_SECOND_CHAN_NONE);
         _lastHopTime = now;
     }
@@ -235,6 +308,9 @@ void WiFiAttacks::handlePacket(void* buf, wifi_promiscuous_pkt_type_t type) {
     
     _packetCount++;
     
+    // The pre-trigger ring sees every frame before the analyzers can fire it
+    if (frameTrigger.active()) frameTrigger.onFrame(pkt->payload, len, rssi, _hopChannel);
+    
     switch (_mode) {
         case WiFiMode::SNIFF_BEACON:
             if (frameType == WIFI_FRAME_TYPE_MGMT && frameSubtype == WIFI_MGMT_BEACON) {
@@ -278,7 +354,22 @@ void WiFiAttacks::handlePacket(void* buf, wifi_promiscuous_pkt_type_t type) {
                 else if (frameType == WIFI_FRAME_TYPE_CTRL) typeStr = "CTRL";
                 else if (frameType == WIFI_FRAME_TYPE_DATA) typeStr = "DATA";
                 snprintf(buf, sizeof(buf), "%s frame, %d bytes, %ddBm", typeStr, len, rssi);
-                tui.printResult(buf);
+                ResultMeta meta(rssi, _hopChannel, ipkt->hdr.addr2);
+                tui.printResult(buf, ResultKind::RAW, ResultQueue::keyOf(typeStr, strlen(typeStr)), &meta);
+            }
+            break;
+            
+        case WiFiMode::LIVE_VIEW:
+        case WiFiMode::SURVEY:
+            if (frameType == WIFI_FRAME_TYPE_MGMT &&
+                (frameSubtype == WIFI_MGMT_BEACON || frameSubtype == WIFI_MGMT_PROBE_RESP)) {
+                trackAP(pkt->payload, len, rssi);
+            } else if (frameType == WIFI_FRAME_TYPE_MGMT && frameSubtype == WIFI_MGMT_PROBE_REQ) {
+                uint8_t broadcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+                trackStation(ipkt->hdr.addr2, broadcast, rssi);
+            } else if (frameType == WIFI_FRAME_TYPE_DATA && (ipkt->hdr.frame_ctrl & 0x0300) == 0x0100) {
+                // To-DS only: transmitter is the station, receiver the AP
+                trackStation(ipkt->hdr.addr2, ipkt->hdr.addr1, rssi);
             }
             break;
             
@@ -328,7 +419,10 @@ void WiFiAttacks::parseBeaconFrame(const uint8_t* payload, int len, int rssi) {
     char buf[64];
     snprintf(buf, sizeof(buf), "%s [%02X:%02X:%02X] %ddBm", 
              ssid, bssid[3], bssid[4], bssid[5], rssi);
-    tui.printResult(buf);
+    ResultMeta meta(rssi, _hopChannel, bssid);
+    tui.printResult(buf, ResultKind::BEACON, ResultQueue::keyOf(bssid, 6), &meta);
+    eventStream.emit(StreamEvent(StreamType::AP)
+        .setBssid(bssid).setSsid(ssid).setRssi(rssi).setChannel(_hopChannel));
 }
 
 void WiFiAttacks::parseProbeRequest(const uint8_t* payload, int len, int rssi) {
@@ -358,7 +452,10 @@ void WiFiAttacks::parseProbeRequest(const uint8_t* payload, int len, int rssi) {
     char buf[64];
     snprintf(buf, sizeof(buf), "%02X:%02X:%02X probe: %s", 
              srcMac[3], srcMac[4], srcMac[5], ssid);
-    tui.printResult(buf);
+    ResultMeta meta(rssi, _hopChannel, srcMac);
+    tui.printResult(buf, ResultKind::PROBE, 0, &meta);
+    eventStream.emit(StreamEvent(StreamType::PROBE)
+        .setMac(srcMac).setSsid(ssid).setRssi(rssi).setChannel(_hopChannel));
     
     // Also add as a station
     uint8_t broadcast[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
@@ -386,7 +483,12 @@ void WiFiAttacks::parseDeauthFrame(const uint8_t* payload, int len, int rssi) {
              srcMac[3], srcMac[4], srcMac[5],
              dstMac[3], dstMac[4], dstMac[5],
              reason);
-    tui.printResult(buf);
+    ResultMeta meta(rssi, _hopChannel, srcMac);
+    tui.printResult(buf, ResultKind::DEAUTH, 0, &meta);
+    eventStream.emit(StreamEvent(StreamType::DEAUTH)
+        .setMac(srcMac).setDst(dstMac).setBssid(pkt->hdr.addr3).setReason(reason)
+        .setRssi(rssi).setChannel(_hopChannel));
+    frameTrigger.fire(TriggerKind::DEAUTH, payload);
 }
 
 void WiFiAttacks::parseEAPOL(const uint8_t* payload, int len, int rssi) {
@@ -405,7 +507,12 @@ void WiFiAttacks::parseEAPOL(const uint8_t* payload, int len, int rssi) {
             snprintf(buf, sizeof(buf), "EAPOL: %02X:%02X:%02X <-> %02X:%02X:%02X",
                      pkt->hdr.addr1[3], pkt->hdr.addr1[4], pkt->hdr.addr1[5],
                      pkt->hdr.addr2[3], pkt->hdr.addr2[4], pkt->hdr.addr2[5]);
-            tui.printResult(buf);
+            ResultMeta meta(rssi, _hopChannel, pkt->hdr.addr2);
+            tui.printResult(buf, ResultKind::EAPOL, 0, &meta);
+            eventStream.emit(StreamEvent(StreamType::EAPOL)
+                .setMac(pkt->hdr.addr2).setDst(pkt->hdr.addr1).setBssid(pkt->hdr.addr3)
+                .setRssi(rssi).setChannel(_hopChannel));
+            frameTrigger.fire(TriggerKind::EAPOL, payload);
             return;
         }
     }
@@ -438,48 +545,205 @@ void WiFiAttacks::parsePwnagotchi(const uint8_t* payload, int len, int rssi) {
             snprintf(buf, sizeof(buf), "PWNAGOTCHI: %s [%02X:%02X:%02X]",
                      ssid[0] ? ssid : "?",
                      pkt->hdr.addr3[3], pkt->hdr.addr3[4], pkt->hdr.addr3[5]);
-            tui.printResult(buf);
+            ResultMeta meta(rssi, _hopChannel, pkt->hdr.addr3);
+            tui.printResult(buf, ResultKind::PWNAGOTCHI, ResultQueue::keyOf(pkt->hdr.addr3, 6), &meta);
+            eventStream.emit(StreamEvent(StreamType::PWNAGOTCHI)
+                .setBssid(pkt->hdr.addr3).setSsid(ssid).setRssi(rssi).setChannel(_hopChannel));
             return;
         }
     }
 }
 
 bool WiFiAttacks::addStation(const uint8_t* mac, const uint8_t* bssid, int8_t rssi) {
-    // Check if station already exists
-    for (int i = 0; i < _stations.size(); i++) {
-        Station s = _stations.get(i);
-        if (memcmp(s.mac, mac, 6) == 0) {
-            return false;  // Already exists
-        }
+    if (!lockTables(0)) {
+        _lockMisses++;
+        return false;
     }
     
+    // Check if station already exists
+    bool known = findStation(mac) >= 0;
+    
     // Check for broadcast/multicast MACs - skip them
-    if (mac[0] & 0x01) return false;  // Multicast bit set
+    bool multicast = mac[0] & 0x01;  // Multicast bit set
     
     // Check for null MAC
     bool isNull = true;
     for (int i = 0; i < 6; i++) {
         if (mac[i] != 0) { isNull = false; break; }
     }
-    if (isNull) return false;
+    
+    // New to the history as well as the table? Past MAX_STATIONS only
+    // the history can tell
+    bool fresh = !known && !multicast && !isNull && macHistory.add(mac, millis());
     
     // Add new station
-    if (_stations.size() < MAX_STATIONS) {
+    bool added = false;
+    if (!known && !multicast && !isNull && _stations.size() < MAX_STATIONS) {
         Station s;
         memcpy(s.mac, mac, 6);
         memcpy(s.bssid, bssid, 6);
         s.rssi = rssi;
         s.selected = false;
+        s.channel = _hopChannel;
+        s.frames = 1;
+        s.lastSeen = millis();
         _stations.add(s);
+        added = true;
+    }
+    unlockTables();
+    
+    // Table full: report a device once anyway, it just isn't targetable
+    if (added || fresh) {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "STA: %02X:%02X:%02X:%02X:%02X:%02X%s",
+                 mac[0], mac[1], mac[2], mac[3], mac[4], mac[5], added ? "" : " (untracked)");
+        ResultMeta meta(rssi, _hopChannel, mac);
+        tui.printResult(buf, ResultKind::STATION, 0, &meta);
+        eventStream.emit(StreamEvent(StreamType::STATION)
+            .setMac(mac).setBssid(bssid).setRssi(rssi).setChannel(_hopChannel));
+    }
+    
+    return added;
+}
+
+// ============================================
+// Live View Tracking
+// ============================================
+
+int WiFiAttacks::findAP(const uint8_t* bssid) {
+    for (int i = 0; i < _accessPoints.size(); i++) {
+        AccessPoint ap = _accessPoints.get(i);
+        if (memcmp(ap.bssid, bssid, 6) == 0) return i;
+    }
+    return -1;
+}
+
+int WiFiAttacks::findStation(const uint8_t* mac) {
+    for (int i = 0; i < _stations.size(); i++) {
+        Station s = _stations.get(i);
+        if (memcmp(s.mac, mac, 6) == 0) return i;
+    }
+    return -1;
+}
+
+void WiFiAttacks::trackAP(const uint8_t* payload, int len, int rssi) {
+    if (len < 36) return;
+    
+    wifi_ieee80211_packet_t* pkt = (wifi_ieee80211_packet_t*)payload;
+    const uint8_t* bssid = pkt->hdr.addr3;
+    uint32_t now = millis();
+    
+    if (!lockTables(0)) {
+        _lockMisses++;
+        return;
+    }
+    
+    int idx = findAP(bssid);
+    if (idx >= 0) {
+        AccessPoint ap = _accessPoints.get(idx);
+        ap.rssi = rssi;
+        if (ap.frames < UINT16_MAX) ap.frames++;
+        ap.lastSeen = now;
+        _accessPoints.set(idx, ap);
+        liveTable.noteAP(idx, ap.rssi, ap.frames, now);
+        apSelector.noteAP(idx, ap);
+    } else if (_accessPoints.size() < MAX_APS) {
+        AccessPoint ap;
+        memset(&ap, 0, sizeof(ap));
+        memcpy(ap.bssid, bssid, 6);
+        ap.channel = _hopChannel;
+        ap.rssi = rssi;
+        ap.frames = 1;
+        ap.lastSeen = now;
         
+        // Walk tagged parameters for SSID (0) and DS channel (3)
+        int pos = 36;
+        while (pos + 2 <= len) {
+            uint8_t tagNum = payload[pos];
+            uint8_t tagLen = payload[pos + 1];
+            if (pos + 2 + tagLen > len) break;
+            if (tagNum == 0 && tagLen <= 32) {
+                memcpy(ap.essid, &payload[pos + 2], tagLen);
+            } else if (tagNum == 3 && tagLen == 1) {
+                ap.channel = payload[pos + 2];
+                break;
+            }
+            pos += 2 + tagLen;
+        }
+        
+        _accessPoints.add(ap);
+        liveTable.noteAP(_accessPoints.size() - 1, ap.rssi, ap.frames, now);
+        apSelector.noteAP(_accessPoints.size() - 1, ap);
+        eventStream.emit(StreamEvent(StreamType::AP)
+            .setBssid(ap.bssid).setSsid(ap.essid).setRssi(ap.rssi).setChannel(ap.channel));
+        unlockTables();
+        
+        // The survey has no live table: new APs are result lines
+        if (_mode == WiFiMode::SURVEY) {
+            char buf[64];
+            snprintf(buf, sizeof(buf), "AP: %s [%02X:%02X:%02X:%02X:%02X:%02X] Ch:%d %ddBm",
+                     ap.essid, ap.bssid[0], ap.bssid[1], ap.bssid[2], ap.bssid[3], ap.bssid[4],
+                     ap.bssid[5], ap.channel, ap.rssi);
+            ResultMeta meta(ap.rssi, ap.channel, ap.bssid);
+            tui.printResult(buf, ResultKind::AP, ResultQueue::keyOf(ap.bssid, 6), &meta);
+        }
+        return;
+    }
+    
+    unlockTables();
+}
+
+void WiFiAttacks::trackStation(const uint8_t* mac, const uint8_t* bssid, int rssi) {
+    if (mac[0] & 0x01) return;  // Multicast/broadcast transmitter
+    uint32_t now = millis();
+    bool fresh = false;
+    
+    if (!lockTables(0)) {
+        _lockMisses++;
+        return;
+    }
+    
+    int idx = findStation(mac);
+    if (idx >= 0) {
+        Station s = _stations.get(idx);
+        s.rssi = rssi;
+        s.channel = _hopChannel;
+        if (s.frames < UINT16_MAX) s.frames++;
+        s.lastSeen = now;
+        if (!(bssid[0] & 0x01)) memcpy(s.bssid, bssid, 6);  // Learned association
+        _stations.set(idx, s);
+        liveTable.noteStation(idx, s.rssi, s.frames, now);
+    } else if (_stations.size() < MAX_STATIONS) {
+        Station s;
+        memcpy(s.mac, mac, 6);
+        memcpy(s.bssid, bssid, 6);
+        s.rssi = rssi;
+        s.selected = false;
+        s.channel = _hopChannel;
+        s.frames = 1;
+        s.lastSeen = now;
+        _stations.add(s);
+        liveTable.noteStation(_stations.size() - 1, s.rssi, s.frames, now);
+        macHistory.add(mac, now);
+        eventStream.emit(StreamEvent(StreamType::STATION)
+            .setMac(s.mac).setBssid(s.bssid).setRssi(s.rssi).setChannel(s.channel));
+        fresh = true;
+    } else if (macHistory.add(mac, now)) {
+        // Table full: still announce the device once
+        eventStream.emit(StreamEvent(StreamType::STATION)
+            .setMac(mac).setBssid(bssid).setRssi(rssi).setChannel(_hopChannel));
+        fresh = true;
+    }
+    
+    unlockTables();
+    
+    if (fresh && _mode == WiFiMode::SURVEY) {
         char buf[48];
         snprintf(buf, sizeof(buf), "STA: %02X:%02X:%02X:%02X:%02X:%02X",
                  mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
-        tui.printResult(buf);
-        return true;
+        ResultMeta meta(rssi, _hopChannel, mac);
+        tui.printResult(buf, ResultKind::STATION, 0, &meta);
     }
-    
-    return false;
 }
 
 // ============================================
@@ -489,6 +753,7 @@ bool WiFiAttacks::addStation(const uint8_t* mac, const uint8_t* bssid, int8_t rs
 void WiFiAttacks::startScanAP() {
     _mode = WiFiMode::SCAN_AP;
     _accessPoints.clear();
+    apSelector.reset();
     
     tui.printStatus("Scanning for APs...");
     
@@ -496,17 +761,24 @@ void WiFiAttacks::startScanAP() {
     
     for (int i = 0; i < n && i < MAX_APS; i++) {
         AccessPoint ap;
-        ap.essid = WiFi.SSID(i);
+        strncpy(ap.essid, WiFi.SSID(i).c_str(), sizeof(ap.essid) - 1);
+        ap.essid[sizeof(ap.essid) - 1] = '\0';
         memcpy(ap.bssid, WiFi.BSSID(i), 6);
         ap.channel = WiFi.channel(i);
         ap.rssi = WiFi.RSSI(i);
         ap.selected = false;
+        ap.frames = 0;
+        ap.lastSeen = millis();
         _accessPoints.add(ap);
+        apSelector.noteAP(i, ap);
         
         char buf[64];
         snprintf(buf, sizeof(buf), "[%d] %s (Ch:%d, %ddBm)", 
-                 i, ap.essid.c_str(), ap.channel, ap.rssi);
-        tui.printResult(buf);
+                 i, ap.essid, ap.channel, ap.rssi);
+        ResultMeta meta(ap.rssi, ap.channel, ap.bssid);
+        tui.printResult(buf, ResultKind::AP, 0, &meta);
+        eventStream.emit(StreamEvent(StreamType::AP)
+            .setBssid(ap.bssid).setSsid(ap.essid).setRssi(ap.rssi).setChannel(ap.channel));
     }
     
     char buf[32];
@@ -514,6 +786,7 @@ void WiFiAttacks::startScanAP() {
     tui.printStatus(buf);
     
     _mode = WiFiMode::IDLE;
+    session.markDirty();
 }
 
 void WiFiAttacks::startScanStation() {
@@ -521,6 +794,7 @@ void WiFiAttacks::startScanStation() {
     _packetCount = 0;
     _lastUpdate = millis();
     _stations.clear();
+    macHistory.clear();
     
     tui.printStatus("Scanning for stations (channel hopping)...");
     startPromiscuous(true);  // Enable channel hopping
@@ -571,6 +845,36 @@ void WiFiAttacks::startSniffPwn() {
     startPromiscuous(true);
 }
 
+void WiFiAttacks::startLiveView() {
+    _mode = WiFiMode::LIVE_VIEW;
+    _packetCount = 0;
+    _lastUpdate = millis();
+    
+    // Seed the live ordering with whatever earlier scans found
+    if (lockTables(portMAX_DELAY)) {
+        for (int i = 0; i < _accessPoints.size(); i++) {
+            AccessPoint ap = _accessPoints.get(i);
+            liveTable.noteAP(i, ap.rssi, ap.frames, ap.lastSeen);
+        }
+        for (int i = 0; i < _stations.size(); i++) {
+            Station s = _stations.get(i);
+            liveTable.noteStation(i, s.rssi, s.frames, s.lastSeen);
+        }
+        unlockTables();
+    }
+    
+    tui.printStatus("Live AP/station view (channel hopping)...");
+    startPromiscuous(true);
+}
+
+void WiFiAttacks::startSurvey() {
+    _mode = WiFiMode::SURVEY;
+    _packetCount = 0;
+    _lastUpdate = millis();
+    
+    startPromiscuous(true);
+}
+
 void WiFiAttacks::startSniffRaw() {
     _mode = WiFiMode::SNIFF_RAW;
     _packetCount = 0;
@@ -755,10 +1059,20 @@ void WiFiAttacks::sendBeaconFrame(const char* ssid, uint8_t channel) {
 // Channel Management
 // ============================================
 
+void WiFiAttacks::setHopChannels(const uint8_t* channels, uint8_t count) {
+    _hopListLen = 0;
+    for (uint8_t i = 0; i < count && _hopListLen < MAX_CHANNEL; i++) {
+        if (channels[i] >= 1 && channels[i] <= MAX_CHANNEL) {
+            _hopList[_hopListLen++] = channels[i];
+        }
+    }
+}
+
 void WiFiAttacks::setChannel(uint8_t channel) {
     if (channel >= 1 && channel <= MAX_CHANNEL) {
         _channel = channel;
         esp_wifi_set_channel(channel, WIFI_SECOND_CHAN_NONE);
+        session.markDirty();
     }
 }
 
@@ -771,6 +1085,7 @@ void WiFiAttacks::selectAP(uint8_t index, bool selected) {
         AccessPoint ap = _accessPoints.get(index);
         ap.selected = selected;
         _accessPoints.set(index, ap);
+        session.markDirty();
     }
 }
 
@@ -780,16 +1095,31 @@ void WiFiAttacks::addSSID(const char* ssid) {
         s.name = ssid;
         s.selected = true;
         _ssids.add(s);
+        session.markDirty();
     }
 }
 
 void WiFiAttacks::clearAll() {
+    lockTables(portMAX_DELAY);
     _accessPoints.clear();
     _stations.clear();
+    macHistory.clear();
+    apSelector.reset();
+    unlockTables();
     _ssids.clear();
+    session.markDirty();
     tui.printStatus("All targets cleared");
 }
 
+bool WiFiAttacks::lockTables(TickType_t wait) {
+    if (_tableLock == nullptr) return true;
+    return xSemaphoreTake(_tableLock, wait) == pdTRUE;
+}
+
+void WiFiAttacks::unlockTables() {
+    if (_tableLock != nullptr) xSemaphoreGive(_tableLock);
+}
+
 // ============================================
 // Helpers
 // ============================================
@@ -5,6 +5,7 @@
 #include <WiFi.h>
 #include <esp_wifi.h>
 #include <LinkedList.h>
+#include <freertos/semphr.h>
 
 // ============================================
 // WiFi Attack Module
@@ -29,12 +30,16 @@
 #define WIFI_MGMT_DEAUTH        0xC0
 
 // Access Point structure
+// Fixed-size so list copies never touch the heap (records are updated
+// from the promiscuous callback during live view)
 struct AccessPoint {
-    String essid;
+    char essid[33];
     uint8_t bssid[6];
     uint8_t channel;
     int8_t rssi;
     bool selected;
+    uint16_t frames;     // Beacons/probe responses seen
+    uint32_t lastSeen;   // millis() of last frame
 };
 
 // Station structure  
@@ -43,6 +48,9 @@ struct Station {
     uint8_t bssid[6];  // Associated AP
     int8_t rssi;
     bool selected;
+    uint8_t channel;
+    uint16_t frames;
+    uint32_t lastSeen;
 };
 
 // SSID for beacon spam
@@ -62,6 +70,8 @@ enum class WiFiMode : uint8_t {
     SNIFF_PMKID,
     SNIFF_PWN,
     SNIFF_RAW,
+    LIVE_VIEW,
+    SURVEY,             // Live tracking, sharing the radio with BLE (RadioSurvey)
     ATTACK_DEAUTH,
     ATTACK_BEACON_RANDOM,
     ATTACK_BEACON_LIST,
@@ -74,6 +84,7 @@ public:
     void begin();
     void update();
     void stop();
+    uint32_t nextWakeMs() const;  // ms until update() has timed work due
     
     // Scanning
     void startScanAP();
@@ -84,6 +95,11 @@ public:
     void startSniffPMKID();
     void startSniffPwn();
     void startSniffRaw();
+    void startLiveView();
+    void startSurvey();
+    
+    // Survey: capture off (or back on) while BLE has the radio
+    void pauseCapture(bool pause);
     
     // Attacks
     void startDeauth();
@@ -96,6 +112,9 @@ public:
     void setChannel(uint8_t channel);
     uint8_t getChannel() const { return _channel; }
     
+    // Channels sniff modes hop over (count 0 = all, 1 = stay on it)
+    void setHopChannels(const uint8_t* channels, uint8_t count);
+    
     // Target management
     LinkedList<AccessPoint>* getAPs() { return &_accessPoints; }
     LinkedList<Station>* getStations() { return &_stations; }
@@ -105,11 +124,17 @@ public:
     void addSSID(const char* ssid);
     void clearAll();
     
+    // AP/station tables are written from the promiscuous callback while
+    // sniffing; readers on the main loop take this lock around access
+    bool lockTables(TickType_t wait);
+    void unlockTables();
+    
     bool isActive() const { return _mode != WiFiMode::IDLE; }
     
     // Public for callback access
     WiFiMode _mode = WiFiMode::IDLE;
     uint32_t _packetCount = 0;
+    uint32_t _lockMisses = 0;  // Table updates skipped while a reader held the lock
     
     // Promiscuous callback handler (called from static callback)
     void handlePacket(void* buf, wifi_promiscuous_pkt_type_t type);
@@ -117,16 +142,25 @@ public:
 private:
     uint8_t _channel = DEFAULT_CHANNEL;
     uint32_t _lastUpdate = 0;
+    uint32_t _lastStatsEvent = 0;
+    static const uint32_t ATTACK_INTERVAL = 100;   // ms between attack frames
+    static const uint32_t STATUS_INTERVAL = STATUS_BAR_REFRESH_MS;  // ms between stats updates
     
     // Channel hopping
     bool _channelHop = false;
     uint8_t _hopChannel = 1;
     uint32_t _lastHopTime = 0;
+    bool _paused = false;
+    uint32_t _pausedAt = 0;
+    uint8_t _hopList[MAX_CHANNEL];
+    uint8_t _hopListLen = 0;    // 0 = hop 1..MAX_CHANNEL
+    uint8_t _hopPos = 0;
     static const uint32_t CHANNEL_HOP_INTERVAL = 500;  // ms per channel
     
     LinkedList<AccessPoint> _accessPoints;
     LinkedList<Station> _stations;
     LinkedList<SSID> _ssids;
+    SemaphoreHandle_t _tableLock = nullptr;
     
     // Internal methods
     void sendDeauthToAll();
@@ -148,6 +182,12 @@ private:
     void parseEAPOL(const uint8_t* payload, int len, int rssi);
     void parsePwnagotchi(const uint8_t* payload, int len, int rssi);
     bool addStation(const uint8_t* mac, const uint8_t* bssid, int8_t rssi);
+    
+    // Live view record tracking
+    void trackAP(const uint8_t* payload, int len, int rssi);
+    void trackStation(const uint8_t* mac, const uint8_t* bssid, int rssi);
+    int findAP(const uint8_t* bssid);
+    int findStation(const uint8_t* mac);
 };
 
 extern WiFiAttacks wifiAttacks;
@@ -10,6 +10,19 @@
 #include "SerialTUI.h"
 #include "WiFiAttacks.h"
 #include "BTAttacks.h"
+#include "EventLoop.h"
+#include "LiveTable.h"
+#include "CommandShell.h"
+#include "EventStream.h"
+#include "Transport.h"
+#include "SessionStore.h"
+#include "CaptureLog.h"
+#include "FrameTrigger.h"
+#include "RadioSurvey.h"
+#include "TrackerWatch.h"
+#include "SpamDetector.h"
+#include "SignatureSet.h"
+#include "ClassicScan.h"
 
 // ============================================
 // ESP-IDF Raw Frame Sanity Check Bypass
@@ -21,10 +34,32 @@ extern "C" int ieee80211_raw_frame_sanity_check(int32_t arg, int32_t arg2, int32
     return 0;  // Always return success to allow all frame types
 }
 
+/**
+ * Stop whatever scan/attack is running and return to the menu
+ */
+void stopAll() {
+    radioSurvey.stop();     // Final summary; the two sides stop below
+    classicScan.stop();     // NimBLE back before the BT stop
+    if (wifiAttacks.isActive()) wifiAttacks.stop();
+    if (btAttacks.isActive()) {
+        btAttacks.stop();
+        console.resume();  // Spam took over BLE advertising
+    }
+    tui.setScanning(false);
+}
+
 /**
  * Handle menu action from TUI
  */
 void handleAction(MenuAction action) {
+    // Spam re-keys the BLE address and advertising under a BLE console
+    if (action >= MenuAction::BT_SPAM_APPLE && action <= MenuAction::BT_SPAM_ALL &&
+        console.kind() == TransportKind::BLE_NUS) {
+        tui.printError("BT spam would drop the BLE console. Use USB/UART.");
+        tui.clearPendingAction();
+        return;
+    }
+    
     switch (action) {
         // WiFi Scans
         case MenuAction::WIFI_SCAN_AP:
@@ -39,6 +74,18 @@ void handleAction(MenuAction action) {
             wifiAttacks.startScanStation();
             break;
             
+        case MenuAction::WIFI_LIVE_VIEW:
+            tui.printStatus("Live AP/station view...");
+            tui.setScanning(true);
+            liveTable.begin(tui.contentTopRow());
+            wifiAttacks.startLiveView();
+            break;
+            
+        case MenuAction::WIFI_SURVEY:
+            tui.setScanning(true);
+            radioSurvey.start();
+            break;
+            
         // WiFi Sniff
         case MenuAction::WIFI_SNIFF_BEACON:
             tui.printStatus("Sniffing beacon frames...");
@@ -163,6 +210,7 @@ void handleAction(MenuAction action) {
             tui.printStatus("Detecting card skimmers...");
             tui.setScanning(true);
             btAttacks.startScanSkimmer();
+            classicScan.start();
             break;
             
         // Bluetooth Spam
@@ -207,7 +255,7 @@ void handleAction(MenuAction action) {
                     AccessPoint ap = aps->get(i);
                     snprintf(buf, sizeof(buf), "%s%s [%d] %ddBm", 
                              ap.selected ? "*" : " ",
-                             ap.essid.c_str(),
+                             ap.essid,
                              ap.channel,
                              ap.rssi);
                     tui.printResult(buf);
@@ -271,6 +319,10 @@ void handleAction(MenuAction action) {
             tui.printStatus("All targets cleared");
             break;
             
+        case MenuAction::RESULTS_VIEW:
+            tui.enterPagerMode();
+            break;
+            
         case MenuAction::SETTINGS_CHANNEL:
             {
                 uint8_t ch = (wifiAttacks.getChannel() % 14) + 1;
@@ -281,7 +333,53 @@ void handleAction(MenuAction action) {
             }
             break;
             
+        case MenuAction::SETTINGS_OUTPUT:
+            {
+                // Cycle text -> JSON lines -> binary records
+                OutputMode mode = (OutputMode)(((uint8_t)eventStream.mode() + 1) % (uint8_t)OutputMode::COUNT);
+                eventStream.setMode(mode);
+                char buf[32];
+                snprintf(buf, sizeof(buf), "Output: %s", EventStream::modeName(mode));
+                tui.printStatus(buf);
+            }
+            break;
+            
+        case MenuAction::SETTINGS_CONSOLE:
+            {
+                // Next link this board has; it sticks once a key arrives there
+                TransportKind kind = console.kind();
+                do {
+                    kind = (TransportKind)(((uint8_t)kind + 1) % (uint8_t)TransportKind::COUNT);
+                } while (!Console::supports(kind));
+                char buf[48];
+                snprintf(buf, sizeof(buf), "Console: %s, press a key there within %lus",
+                         Console::kindName(kind), (unsigned long)(CONSOLE_CONFIRM_MS / 1000));
+                tui.printStatus(buf);
+                if (kind == TransportKind::BLE_NUS) {
+                    snprintf(buf, sizeof(buf), "BLE console: pair with passkey %06lu",
+                             (unsigned long)BleNusTransport::passkey());
+                    tui.printStatus(buf);
+                }
+                if (!console.use(kind)) tui.printError("Console link unavailable");
+            }
+            break;
+            
+        case MenuAction::SETTINGS_BT_PROFILE:
+            {
+                // Cycle survey -> active -> background -> tracker
+                BTScanProfile profile = (BTScanProfile)(((uint8_t)btAttacks.profile() + 1) % (uint8_t)BTScanProfile::COUNT);
+                btAttacks.setProfile(profile);
+                char buf[64];
+                char desc[48];
+                BTAttacks::describeProfile(profile, desc, sizeof(desc));
+                snprintf(buf, sizeof(buf), "BT profile %s", desc);
+                tui.printStatus(buf);
+            }
+            break;
+            
         case MenuAction::REBOOT:
+            session.save();
+            captureLog.stop();
             tui.printStatus("Rebooting...");
             delay(500);
             ESP.restart();
@@ -289,9 +387,7 @@ void handleAction(MenuAction action) {
             
         case MenuAction::BACK:
             // Signal to stop current operation
-            wifiAttacks.stop();
-            btAttacks.stop();
-            tui.setScanning(false);
+            stopAll();
             break;
             
         default:
@@ -302,23 +398,58 @@ void handleAction(MenuAction action) {
 }
 
 void setup() {
+    // Event queue must exist before anything can post to it
+    events.begin();
+    
     // Initialize TUI
     tui.begin();
     
     // Welcome message
-    Serial.println();
+    console.println();
     tui.printStatus("Initializing...");
     
     // Initialize WiFi
     wifiAttacks.begin();
     tui.printStatus("WiFi ready");
     
+    // Bring back the last session's targets
+    char buf[64];
+    if (!session.begin()) {
+        tui.printError("Session storage unavailable");
+    } else if (session.restore()) {
+        snprintf(buf, sizeof(buf), "Session: %u APs, %u STAs, %u SSIDs (%lu ms)",
+                 session.lastApCount(), session.lastStaCount(), session.lastSsidCount(),
+                 (unsigned long)session.lastMs());
+        tui.printStatus(buf);
+    }
+    
+    // Capture log shares the session partition
+    if (session.mounted() && captureLog.begin()) {
+        snprintf(buf, sizeof(buf), "Capture log: %u x %u KB segments",
+                 captureLog.segmentCount(), CAPTURE_SEGMENT_SIZE / 1024);
+        tui.printStatus(buf);
+#if CAPTURE_LOG_AT_BOOT
+        captureLog.start();
+#endif
+    }
+    
+    // Built-in BLE signatures plus any saved ones
+    signatures.begin(session.mounted());
+    snprintf(buf, sizeof(buf), "BLE signatures: %u (%u nodes)", signatures.count(), signatures.nodes());
+    tui.printStatus(buf);
+    
     // Initialize Bluetooth
     btAttacks.begin();
     tui.printStatus("Bluetooth ready");
     
+#if CONSOLE_BLE_ATTACH
+    // Advertised from boot: whoever is at the wired console gets the key
+    snprintf(buf, sizeof(buf), "BLE console: pair with passkey %06lu",
+             (unsigned long)BleNusTransport::passkey());
+    tui.printResult(buf, ResultKind::INFO);
+#endif
+
     // Show free heap
-    char buf[64];
     snprintf(buf, sizeof(buf), "Free heap: %d bytes", ESP.getFreeHeap());
     tui.printStatus(buf);
     
@@ -326,6 +457,24 @@ void setup() {
 }
 
 void loop() {
+    // Sleep until a keystroke, analyzer alert, stop request or module deadline
+    uint32_t timeout = min(min(tui.nextWakeMs(), liveTable.nextWakeMs()),
+                           min(wifiAttacks.nextWakeMs(), btAttacks.nextWakeMs()));
+    timeout = min(timeout, min(shell.nextWakeMs(), session.nextWakeMs()));
+    timeout = min(timeout, min(captureLog.nextWakeMs(), frameTrigger.nextWakeMs()));
+    timeout = min(timeout, min(radioSurvey.nextWakeMs(), trackerWatch.nextWakeMs()));
+    timeout = min(timeout, min(classicScan.nextWakeMs(), spamDetector.nextWakeMs()));
+    Event ev = events.wait(timeout);
+    
+    // Encode what the radio tasks staged before anything drains it
+    eventStream.update();
+    
+    if (ev.type == EventType::STOP) {
+        // Stopped by hand: queued command jobs are abandoned too
+        shell.cancel();
+        stopAll();
+    }
+    
     // Update TUI
     tui.update();
     
@@ -335,28 +484,30 @@ void loop() {
         handleAction(action);
     }
     
-    // Update attacks if running
+    // Next step of a queued command job (start, or stop when its time is up)
+    action = shell.update();
+    if (action != MenuAction::NONE) {
+        handleAction(action);
+    }
+    
+    // Update attacks if running; the survey switches the radio first
+    radioSurvey.update();
     if (wifiAttacks.isActive()) {
         wifiAttacks.update();
-        
-        // Check for stop signal
-        if (tui.getPendingAction() == MenuAction::BACK) {
-            wifiAttacks.stop();
-            tui.setScanning(false);
-            tui.clearPendingAction();
-        }
+        liveTable.update();
     }
     
     if (btAttacks.isActive()) {
         btAttacks.update();
-        
-        // Check for stop signal
-        if (tui.getPendingAction() == MenuAction::BACK) {
-            btAttacks.stop();
-            tui.setScanning(false);
-            tui.clearPendingAction();
-        }
     }
+    classicScan.update();
+    trackerWatch.update();
+    spamDetector.update();
+    
+    // Autosave targets once idle, checkpoint during long runs
+    session.update();
     
-    delay(10);
+    // Commit trigger captures, then move logged events to flash
+    frameTrigger.update();
+    captureLog.update();
 }
@@ -0,0 +1,317 @@
+#!/usr/bin/env python3
+"""
+Decode the ESP32 Marauder TUI event stream (Settings > Output Mode, or
+":output json|bin").
+
+Reads a serial port (needs pyserial) or a capture file / stdin, picks
+JSON-line and binary TLV records out of the byte stream (menu text and
+ANSI codes in between are skipped), checks each CRC and the sequence
+numbers, and prints one JSON object per event.
+
+Compressed blocks (":compress on", compressed capture log segments) are
+unpacked on the way, and beacon delta records are turned back into
+full frames. Raw frames committed by ":trigger" can also be written to
+a pcap file for Wireshark.
+
+    tools/decode_events.py /dev/ttyUSB0 -b 115200
+    tools/decode_events.py capture.bin > events.jsonl
+    tools/decode_events.py capture.bin --pcap trigger.pcap
+"""
+
+import argparse
+import json
+import struct
+import sys
+import zlib
+
+SYNC = b"\xA5\x5A"
+BLOCK_SYNC = b"\xA5\x5C"
+BLOCK_HEADER = struct.Struct("<BHH")  # flags, raw length, data length
+BLOCK_STORED = 0x01
+HEADER = struct.Struct("<BBII")  # type, len, seq, ms
+
+TYPES = {1: "ap", 2: "station", 3: "probe", 4: "deauth", 5: "eapol",
+         6: "ble", 7: "stats", 8: "pwnagotchi", 9: "trigger", 10: "frame", 11: "beacon",
+         12: "tracker", 13: "spam"}
+
+# tag -> (name, decoder)
+def _mac(v):
+    return ":".join("%02X" % b for b in v)
+
+FIELDS = {
+    1: ("mac", _mac),
+    2: ("bssid", _mac),
+    3: ("dst", _mac),
+    4: ("rssi", lambda v: struct.unpack("<b", v)[0]),
+    5: ("ch", lambda v: v[0]),
+    6: ("ssid", lambda v: v.decode("utf-8", "replace")),
+    7: ("reason", lambda v: struct.unpack("<H", v)[0]),
+    8: ("count", lambda v: struct.unpack("<I", v)[0]),
+    9: ("class", lambda v: v[0]),
+    10: ("drops", lambda v: struct.unpack("<I", v)[0]),
+    11: ("frame", bytes.hex),
+    12: ("len", lambda v: struct.unpack("<H", v)[0]),
+    13: ("tsf", lambda v: struct.unpack("<Q", v)[0]),
+    14: ("seqctl", lambda v: struct.unpack("<H", v)[0]),
+}
+
+CRC_SUFFIX_LEN = len(',"crc":"00000000"}')
+
+LINKTYPE_IEEE802_11 = 105
+
+
+def lzss_decode(data, raw_len):
+    """Inverse of Compressor::pack (src/Compressor.cpp)."""
+    out = bytearray()
+    i = 0
+    while len(out) < raw_len:
+        flags = data[i]
+        i += 1
+        for bit in range(8):
+            if len(out) >= raw_len:
+                break
+            if flags >> bit & 1:
+                out.append(data[i])
+                i += 1
+            else:
+                token = data[i] | data[i + 1] << 8
+                i += 2
+                offset, length = (token >> 6) + 1, (token & 0x3F) + 3
+                for _ in range(length):
+                    out.append(out[-offset])
+    return bytes(out)
+
+
+class PcapWriter:
+    """802.11 frames (no radiotap header); timestamps are device millis()."""
+
+    def __init__(self, path):
+        self.out = open(path, "wb")
+        self.out.write(struct.pack("<IHHiIII", 0xA1B2C3D4, 2, 4, 0, 0, 65535,
+                                   LINKTYPE_IEEE802_11))
+        self.frames = 0
+
+    def write(self, event):
+        data = bytes.fromhex(event["frame"])
+        ms = event["ms"]
+        self.out.write(struct.pack("<IIII", ms // 1000, (ms % 1000) * 1000,
+                                   len(data), event.get("len", len(data))))
+        self.out.write(data)
+        self.frames += 1
+
+    def close(self):
+        self.out.close()
+
+
+class Decoder:
+    def __init__(self, root=None):
+        self.buf = bytearray()
+        # Unpacked block contents are one stream of their own; counters
+        # and sequence tracking stay with the outer decoder
+        self.root = root or self
+        self.inner = None
+        self.next_seq = None
+        self.ok = 0
+        self.bad_crc = 0
+        self.lost = 0
+        self.blocks = 0
+        self.raw_bytes = 0
+        self.packed_bytes = 0
+        self.beacons = {}  # BSSID -> (last full beacon frame, its length)
+        self.rebuilt = 0
+        self.unresolved = 0
+
+    def feed(self, data):
+        self.buf += data
+        while True:
+            event = self._next()
+            if event is None:
+                return
+            if isinstance(event, list):
+                yield from event
+            elif event is not False:
+                yield event
+
+    def _next(self):
+        """Event dict, False for a skipped/bad record, None if more data is needed."""
+        buf = self.buf
+        # Find the earliest candidate record start
+        syncs = (SYNC, b'{"t":') if self.root is not self else (SYNC, b'{"t":', BLOCK_SYNC)
+        starts = [i for i in (buf.find(s) for s in syncs) if i >= 0]
+        if not starts:
+            # Keep a possible partial sync/prefix at the end
+            del buf[:max(0, len(buf) - 4)]
+            return None
+        start = min(starts)
+        del buf[:start]
+
+        if buf.startswith(SYNC):
+            return self._binary()
+        if buf.startswith(BLOCK_SYNC):
+            return self._block()
+        return self._json()
+
+    def _block(self):
+        buf = self.buf
+        if len(buf) < 2 + BLOCK_HEADER.size:
+            return None
+        flags, raw_len, data_len = BLOCK_HEADER.unpack_from(buf, 2)
+        total = 2 + BLOCK_HEADER.size + data_len + 4
+        if len(buf) < total:
+            return None
+        body = bytes(buf[2:total - 4])
+        (crc,) = struct.unpack_from("<I", buf, total - 4)
+        if zlib.crc32(body) != crc:
+            self.root.bad_crc += 1
+            del buf[:2]
+            return False
+        del buf[:total]
+
+        data = body[BLOCK_HEADER.size:]
+        try:
+            raw = data if flags & BLOCK_STORED else lzss_decode(data, raw_len)
+        except IndexError:
+            self.root.bad_crc += 1
+            return False
+        self.blocks += 1
+        self.raw_bytes += raw_len
+        self.packed_bytes += total
+        if self.inner is None:
+            self.inner = Decoder(root=self)
+        return list(self.inner.feed(raw))
+
+    def _binary(self):
+        buf = self.buf
+        if len(buf) < 2 + HEADER.size:
+            return None
+        etype, length, seq, ms = HEADER.unpack_from(buf, 2)
+        total = 2 + HEADER.size + length + 4
+        if len(buf) < total:
+            return None
+        body = bytes(buf[2:total - 4])
+        (crc,) = struct.unpack_from("<I", buf, total - 4)
+        if zlib.crc32(body) != crc:
+            self.root.bad_crc += 1
+            del buf[:2]  # Resync past this sync word
+            return False
+        del buf[:total]
+
+        event = {"t": TYPES.get(etype, etype), "seq": seq, "ms": ms}
+        pos = HEADER.size
+        while pos + 2 <= len(body):
+            tag, n = body[pos], body[pos + 1]
+            value = body[pos + 2:pos + 2 + n]
+            name, decode = FIELDS.get(tag, ("tag%d" % tag, bytes.hex))
+            event[name] = decode(value)
+            pos += 2 + n
+        return self._accept(event)
+
+    def _json(self):
+        buf = self.buf
+        end = buf.find(b"\n")
+        if end < 0:
+            return None if len(buf) < 512 else self._skip()
+        line = bytes(buf[:end]).rstrip(b"\r")
+        del buf[:end + 1]
+
+        try:
+            event = json.loads(line)
+            crc = int(event.pop("crc"), 16)
+        except (ValueError, KeyError):
+            self.root.bad_crc += 1
+            return False
+        if zlib.crc32(line[:-CRC_SUFFIX_LEN] + b"}") != crc:
+            self.root.bad_crc += 1
+            return False
+        return self._accept(event)
+
+    def _skip(self):
+        del self.buf[:1]
+        return False
+
+    def _accept(self, event):
+        if self.root is not self:
+            return self.root._accept(event)
+        seq = event["seq"]
+        if self.next_seq is not None and seq > self.next_seq:
+            self.lost += seq - self.next_seq
+        if self.next_seq is None or seq >= self.next_seq:
+            self.next_seq = seq + 1
+        self.ok += 1
+        return self._beacon(event)
+
+    def _beacon(self, event):
+        """Remember full beacons; rebuild frames from beacon deltas."""
+        if event["t"] == "frame":
+            frame = bytes.fromhex(event["frame"])
+            if len(frame) >= 32 and frame[0] == 0x80:
+                self.beacons[frame[16:22]] = (frame, event.get("len", len(frame)))
+            return event
+        if event["t"] != "beacon":
+            return event
+
+        base = self.beacons.get(bytes.fromhex(event["bssid"].replace(":", "")))
+        if base is None:
+            # Its full frame was lost or came before we started listening
+            self.unresolved += 1
+            return event
+        frame, length = base
+        # Only the sequence control and the TSF are the delta's own; the
+        # TIM stays that of the base frame (see src/BeaconDedup.h)
+        frame = frame[:22] + struct.pack("<HQ", event["seqctl"], event["tsf"]) + frame[32:]
+        self.rebuilt += 1
+        rebuilt = {k: v for k, v in event.items() if k not in ("bssid", "tsf", "seqctl")}
+        rebuilt.update(t="frame", len=length, frame=frame.hex(), delta=True)
+        return rebuilt
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    ap.add_argument("source", nargs="?", default="-",
+                    help="serial port, capture file, or - for stdin")
+    ap.add_argument("-b", "--baud", type=int, default=115200)
+    ap.add_argument("--pcap", metavar="FILE",
+                    help="also write frame records to a pcap file")
+    args = ap.parse_args()
+
+    if args.source == "-":
+        stream = sys.stdin.buffer
+    elif args.source.startswith(("/dev/", "COM")):
+        import serial  # pyserial
+        stream = serial.Serial(args.source, args.baud, timeout=0.2)
+    else:
+        stream = open(args.source, "rb")
+
+    dec = Decoder()
+    pcap = PcapWriter(args.pcap) if args.pcap else None
+    try:
+        while True:
+            data = stream.read(4096) if not hasattr(stream, "in_waiting") \
+                else stream.read(max(1, stream.in_waiting))
+            if not data:
+                if hasattr(stream, "in_waiting"):
+                    continue
+                break
+            for event in dec.feed(data):
+                if pcap and event["t"] == "frame":
+                    pcap.write(event)
+                print(json.dumps(event), flush=True)
+    except KeyboardInterrupt:
+        pass
+    if pcap:
+        pcap.close()
+        print("# %d frames written to %s" % (pcap.frames, args.pcap), file=sys.stderr)
+
+    print("# %d events, %d bad CRC, %d lost (seq gaps)"
+          % (dec.ok, dec.bad_crc, dec.lost), file=sys.stderr)
+    if dec.rebuilt or dec.unresolved:
+        print("# %d beacons rebuilt from deltas, %d without a base frame"
+              % (dec.rebuilt, dec.unresolved), file=sys.stderr)
+    if dec.blocks:
+        print("# %d compressed blocks, %d -> %d bytes (%.0f%%)"
+              % (dec.blocks, dec.raw_bytes, dec.packed_bytes,
+                 100.0 * dec.packed_bytes / dec.raw_bytes), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()